@@ -64,6 +64,11 @@ void I_UpdateRenderSize(void)
     renderW = gl_window_width;
     renderH = gl_window_height;
   }
+  else if (I_Headless())
+  {
+    renderW = SCREENWIDTH;
+    renderH = SCREENHEIGHT;
+  }
   else
   {
     SDL_GetRendererOutputSize(sdl_renderer, &renderW, &renderH);
@@ -118,14 +123,19 @@ unsigned char *I_GrabScreen(void)
     return gld_ReadScreen();
   }
 
-  size = renderW * renderH * 3;
+  // One byte of slack for the headless 32-bit stores
+  size = renderW * renderH * 3 + 1;
   if (!pixels || size > pixels_size)
   {
     pixels_size = size;
     pixels = (unsigned char*)Z_Realloc(pixels, size);
   }
 
-  if (pixels && size)
+  if (I_Headless())
+  {
+    I_ReadHeadlessPixels(pixels);
+  }
+  else if (pixels && size)
   {
     SDL_Rect screen = { 0, 0, renderW, renderH };
     SDL_RenderReadPixels(sdl_renderer, &screen, SDL_PIXELFORMAT_RGB24, pixels, renderW * 3);
@@ -122,6 +122,25 @@ static SDL_GLContext sdl_glcontext;
 unsigned int windowid = 0;
 SDL_Rect src_rect = { 0, 0, 0, 0 };
 
+// Headless mode renders the software path into screens[0] only;
+// frames reach capture and screenshots without a window or renderer
+static dboolean headless;
+static dboolean headless_mode_set;
+static unsigned int headless_palette[256];
+
+// Gamma corrected colours of the palette on screen
+static const SDL_Color *screen_colours;
+
+const SDL_Color *I_ScreenPalette(void)
+{
+  return screen_colours;
+}
+
+dboolean I_Headless(void)
+{
+  return headless;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // Input code
 int             leds_always_off = 0; // Expected by m_misc, not relevant
@@ -471,6 +490,48 @@ static void I_InitInputs(void)
 ///////////////////////////////////////////////////////////
 // Palette stuff.
 //
+
+// Each entry holds r, g, b in memory order plus a pad byte,
+// so one 32-bit store writes a whole RGB24 pixel
+static void I_SetHeadlessPalette(const SDL_Color *colours)
+{
+  int i;
+
+  for (i = 0; i < 256; i++)
+  {
+    byte *entry = (byte *) &headless_palette[i];
+
+    entry[0] = colours[i].r;
+    entry[1] = colours[i].g;
+    entry[2] = colours[i].b;
+    entry[3] = 0;
+  }
+}
+
+// Writes the screen as RGB24; pixels needs one byte of slack past the end
+void I_ReadHeadlessPixels(unsigned char *pixels)
+{
+  int x, y;
+
+  for (y = 0; y < SCREENHEIGHT; y++)
+  {
+    const byte *src = screens[0].data + y * screens[0].pitch;
+    const byte *end = src + (SCREENWIDTH & ~3);
+    byte *dest = pixels + y * SCREENWIDTH * 3;
+
+    for (; src < end; src += 4, dest += 12)
+    {
+      memcpy(dest,     &headless_palette[src[0]], 4);
+      memcpy(dest + 3, &headless_palette[src[1]], 4);
+      memcpy(dest + 6, &headless_palette[src[2]], 4);
+      memcpy(dest + 9, &headless_palette[src[3]], 4);
+    }
+
+    for (x = SCREENWIDTH & ~3; x < SCREENWIDTH; x++, src++, dest += 3)
+      memcpy(dest, &headless_palette[*src], 4);
+  }
+}
+
 static void I_UploadNewPalette(int pal, int force)
 {
   // This is used to replace the current 256 colour cmap with a new one
@@ -523,7 +584,15 @@ static void I_UploadNewPalette(int pal, int force)
       pal, num_pals);
 #endif
 
-  SDL_SetPaletteColors(screen->format->palette, playpal_data->colours + 256 * pal, 0, 256);
+  screen_colours = playpal_data->colours + 256 * pal;
+
+  if (headless)
+  {
+    I_SetHeadlessPalette(screen_colours);
+    return;
+  }
+
+  SDL_SetPaletteColors(screen->format->palette, screen_colours, 0, 256);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -531,6 +600,9 @@ static void I_UploadNewPalette(int pal, int force)
 
 void I_ShutdownGraphics(void)
 {
+  if (headless)
+    return;
+
   SDL_FreeCursor(cursors[1]);
   DeactivateMouse();
 }
@@ -569,8 +641,23 @@ void I_HandleCapture(void)
 static int newpal = 0;
 #define NO_PALETTE_CHANGE 1000
 
+static void I_FinishHeadlessUpdate(void)
+{
+  if (newpal != NO_PALETTE_CHANGE) {
+    I_UploadNewPalette(newpal, false);
+    newpal = NO_PALETTE_CHANGE;
+  }
+
+  I_HandleCapture();
+}
+
 void I_FinishUpdate (void)
 {
+  if (headless) {
+    I_FinishHeadlessUpdate();
+    return;
+  }
+
   //e6y: new mouse code
   UpdateGrab();
 
@@ -667,7 +754,10 @@ void I_PreInitGraphics(void)
 
   // Initialize SDL
   unsigned int flags = 0;
-  if (!(dsda_Flag(dsda_arg_nodraw) && dsda_Flag(dsda_arg_nosound)))
+
+  headless = dsda_Flag(dsda_arg_headless);
+
+  if (!headless && !(dsda_Flag(dsda_arg_nodraw) && dsda_Flag(dsda_arg_nosound)))
     flags = SDL_INIT_VIDEO;
 #ifdef PRBOOM_DEBUG
   flags |= SDL_INIT_NOPARACHUTE;
@@ -813,7 +903,7 @@ static void I_FillScreenResolutionsList(void)
 
   // Don't call SDL_ListModes if SDL has not been initialized
   count = 0;
-  if (!nodrawers)
+  if (!nodrawers && !headless)
     count = SDL_GetNumDisplayModes(display_index);
 
   list_size = 0;
@@ -1038,6 +1128,9 @@ static video_mode_t I_DesiredVideoMode(void) {
   dsda_arg_t *arg;
   video_mode_t mode;
 
+  if (headless)
+    return VID_MODESW;
+
   arg = dsda_Arg(dsda_arg_vidmode);
   if (arg->found)
     mode = I_GetModeFromString(arg->value.v_string);
@@ -1056,7 +1149,7 @@ void I_InitScreenResolution(void)
   char c, x;
   dsda_arg_t *arg;
   video_mode_t mode;
-  int init = (sdl_window == NULL);
+  int init = (sdl_window == NULL && !headless_mode_set);
 
   I_GetScreenResolution();
 
@@ -1190,6 +1283,9 @@ void I_InitGraphics(void)
     /* Set the video mode */
     I_UpdateVideoMode();
 
+    if (headless)
+      return;
+
     //e6y: setup the window title
     I_SetWindowCaption();
 
@@ -1223,7 +1319,7 @@ void I_UpdateVideoMode(void)
   screen_multiply = 1;//dsda_IntConfig(dsda_config_render_screen_multiply);
   integer_scaling = dsda_IntConfig(dsda_config_integer_scaling);
 
-  if(sdl_window)
+  if(sdl_window || headless_mode_set)
   {
     // video capturing cannot be continued with new screen settings
     I_CaptureFinish();
@@ -1241,7 +1337,7 @@ void I_UpdateVideoMode(void)
     if (buffer) SDL_FreeSurface(buffer);
     if (sdl_texture) SDL_DestroyTexture(sdl_texture);
     if (sdl_renderer) SDL_DestroyRenderer(sdl_renderer);
-    SDL_DestroyWindow(sdl_window);
+    if (sdl_window) SDL_DestroyWindow(sdl_window);
 
     sdl_renderer = NULL;
     sdl_window = NULL;
@@ -1272,7 +1368,11 @@ void I_UpdateVideoMode(void)
     init_flags |= SDL_WINDOW_RESIZABLE;
 #endif
 
-  if (V_IsOpenGLMode())
+  if (headless)
+  {
+    headless_mode_set = true;
+  }
+  else if (V_IsOpenGLMode())
   {
     SDL_GL_SetAttribute( SDL_GL_RED_SIZE, 0 );
     SDL_GL_SetAttribute( SDL_GL_GREEN_SIZE, 0 );
@@ -1352,7 +1452,7 @@ void I_UpdateVideoMode(void)
     }
   }
 
-  if (sdl_video_window_pos)
+  if (sdl_video_window_pos && sdl_window)
   {
     int x, y;
     if (sscanf(sdl_video_window_pos, "%d,%d", &x, &y) == 2)
@@ -1377,7 +1477,8 @@ void I_UpdateVideoMode(void)
   }
 #endif
 
-  windowid = SDL_GetWindowID(sdl_window);
+  if (sdl_window)
+    windowid = SDL_GetWindowID(sdl_window);
 
   if (V_IsOpenGLMode())
   {
@@ -1389,7 +1490,7 @@ void I_UpdateVideoMode(void)
     lprintf(LO_DEBUG, "I_UpdateVideoMode: 0x%x, %s, %s\n", init_flags, screen && screen->pixels ? "SDL buffer" : "own buffer", screen && SDL_MUSTLOCK(screen) ? "lock-and-copy": "direct access");
 
     // Get the info needed to render to the display
-    if (!SDL_MUSTLOCK(screen))
+    if (screen && !SDL_MUSTLOCK(screen))
     {
       screens[0].not_on_heap = true;
       screens[0].data = (unsigned char *) (screen->pixels);
@@ -1650,116 +1650,337 @@ static automap_style_t AM_wallStyle(int i)
   return ams_invisible;
 }
 
-static void AM_drawWalls(void)
+//
+// Spatial index
+//
+// Lines and sectors are bucketed into a uniform grid at level setup so
+// that a small window (the minimap in particular) only visits the items
+// overlapping it. Visible items are returned in index order, so drawing
+// order (and therefore overlap) matches a full scan. Polyobject lines
+// move, so they are kept outside the grid and always visited.
+//
+
+#define AM_GRID_SHIFT 7 // 128 map units per cell
+
+typedef struct
 {
-  int i;
-  automap_style_t automap_style;
-  static mline_t l;
-  int hide_locks;
+  int orgx, orgy;
+  int width, height;
+  int count;
+  int *offsets;
+  int *items;
+  int *stamps;
+  int stamp;
+  int *dynamic;
+  int dynamic_count;
+} am_grid_t;
+
+static am_grid_t am_line_grid;
+static am_grid_t am_sector_grid;
+static int *am_grid_visible;
+
+static byte *am_polyobj_lines;
+
+static dboolean AM_isPolyobjLine(int i)
+{
+  return am_polyobj_lines && am_polyobj_lines[i];
+}
 
-  hide_locks = map_blinking_locks && (gametic & 16);
+static void AM_lineBox(int i, int *box)
+{
+  box[BOXLEFT] = lines[i].bbox[BOXLEFT] >> FRACTOMAPBITS;
+  box[BOXRIGHT] = lines[i].bbox[BOXRIGHT] >> FRACTOMAPBITS;
+  box[BOXBOTTOM] = lines[i].bbox[BOXBOTTOM] >> FRACTOMAPBITS;
+  box[BOXTOP] = lines[i].bbox[BOXTOP] >> FRACTOMAPBITS;
+}
 
-  // draw the unclipped visible portions of all lines
-  for (i=0;i<numlines;i++)
+static void AM_sectorBox(int i, int *box)
+{
+  box[BOXLEFT] = sectors[i].bbox[BOXLEFT];
+  box[BOXRIGHT] = sectors[i].bbox[BOXRIGHT];
+  box[BOXBOTTOM] = sectors[i].bbox[BOXBOTTOM];
+  box[BOXTOP] = sectors[i].bbox[BOXTOP];
+}
+
+static void AM_gridCells(am_grid_t *grid, const int *box, int *x1, int *x2, int *y1, int *y2)
+{
+  *x1 = BETWEEN(0, grid->width - 1, (box[BOXLEFT] - grid->orgx) >> AM_GRID_SHIFT);
+  *x2 = BETWEEN(0, grid->width - 1, (box[BOXRIGHT] - grid->orgx) >> AM_GRID_SHIFT);
+  *y1 = BETWEEN(0, grid->height - 1, (box[BOXBOTTOM] - grid->orgy) >> AM_GRID_SHIFT);
+  *y2 = BETWEEN(0, grid->height - 1, (box[BOXTOP] - grid->orgy) >> AM_GRID_SHIFT);
+}
+
+static void AM_buildGrid(am_grid_t *grid, int count, void (*get_box)(int, int *),
+                         dboolean (*is_dynamic)(int))
+{
+  int i, x, y, x1, x2, y1, y2;
+  int box[4];
+  int minx = INT_MAX, miny = INT_MAX, maxx = INT_MIN, maxy = INT_MIN;
+  int *fill;
+
+  grid->count = count;
+  grid->stamp = 0;
+  grid->dynamic = Z_MallocLevel(count * sizeof(*grid->dynamic));
+  grid->dynamic_count = 0;
+
+  for (i = 0; i < count; i++)
   {
-    if (lines[i].bbox[BOXLEFT] >> FRACTOMAPBITS > am_frame.bbox[BOXRIGHT] ||
-      lines[i].bbox[BOXRIGHT] >> FRACTOMAPBITS < am_frame.bbox[BOXLEFT] ||
-      lines[i].bbox[BOXBOTTOM] >> FRACTOMAPBITS > am_frame.bbox[BOXTOP] ||
-      lines[i].bbox[BOXTOP] >> FRACTOMAPBITS < am_frame.bbox[BOXBOTTOM])
+    if (is_dynamic && is_dynamic(i))
     {
+      grid->dynamic[grid->dynamic_count++] = i;
       continue;
     }
 
-    l.a.x = lines[i].v1->x >> FRACTOMAPBITS;
-    l.a.y = lines[i].v1->y >> FRACTOMAPBITS;
-    l.b.x = lines[i].v2->x >> FRACTOMAPBITS;
-    l.b.y = lines[i].v2->y >> FRACTOMAPBITS;
+    get_box(i, box);
+    minx = MIN(minx, box[BOXLEFT]);
+    maxx = MAX(maxx, box[BOXRIGHT]);
+    miny = MIN(miny, box[BOXBOTTOM]);
+    maxy = MAX(maxy, box[BOXTOP]);
+  }
 
-    if (automap_rotate)
-    {
-      AM_rotatePoint(&l.a);
-      AM_rotatePoint(&l.b);
-    }
-    else
-    {
-      AM_SetMPointFloatValue(&l.a);
-      AM_SetMPointFloatValue(&l.b);
-    }
+  if (minx > maxx)
+    minx = maxx = miny = maxy = 0;
+
+  grid->orgx = minx;
+  grid->orgy = miny;
+  grid->width = ((maxx - minx) >> AM_GRID_SHIFT) + 1;
+  grid->height = ((maxy - miny) >> AM_GRID_SHIFT) + 1;
+
+  grid->offsets = Z_CallocLevel(grid->width * grid->height + 1, sizeof(*grid->offsets));
+  grid->stamps = Z_CallocLevel(count, sizeof(*grid->stamps));
+
+  // Two passes: count items per cell, then fill in index order
+  for (i = 0; i < count; i++)
+  {
+    if (is_dynamic && is_dynamic(i))
+      continue;
+
+    get_box(i, box);
+    AM_gridCells(grid, box, &x1, &x2, &y1, &y2);
+    for (y = y1; y <= y2; y++)
+      for (x = x1; x <= x2; x++)
+        grid->offsets[y * grid->width + x + 1]++;
+  }
+
+  for (i = 0; i < grid->width * grid->height; i++)
+    grid->offsets[i + 1] += grid->offsets[i];
+
+  grid->items = Z_MallocLevel(grid->offsets[grid->width * grid->height] * sizeof(*grid->items));
+  fill = Z_Malloc(grid->width * grid->height * sizeof(*fill));
+  memcpy(fill, grid->offsets, grid->width * grid->height * sizeof(*fill));
+
+  for (i = 0; i < count; i++)
+  {
+    if (is_dynamic && is_dynamic(i))
+      continue;
+
+    get_box(i, box);
+    AM_gridCells(grid, box, &x1, &x2, &y1, &y2);
+    for (y = y1; y <= y2; y++)
+      for (x = x1; x <= x2; x++)
+        grid->items[fill[y * grid->width + x]++] = i;
+  }
+
+  Z_Free(fill);
+}
+
+void AM_InitSpatialIndex(void)
+{
+  int i, j;
+
+  am_polyobj_lines = Z_CallocLevel(numlines, sizeof(*am_polyobj_lines));
+  for (i = 0; i < po_NumPolyobjs; i++)
+    for (j = 0; j < polyobjs[i].numsegs; j++)
+      am_polyobj_lines[polyobjs[i].segs[j]->linedef->iLineID] = true;
+
+  AM_buildGrid(&am_line_grid, numlines, AM_lineBox, AM_isPolyobjLine);
+  AM_buildGrid(&am_sector_grid, numsectors, AM_sectorBox, NULL);
+
+  am_grid_visible = Z_MallocLevel(MAX(numlines, numsectors) * sizeof(*am_grid_visible));
+}
+
+static int AM_compareIndex(const void *a, const void *b)
+{
+  return *(const int *)a - *(const int *)b;
+}
+
+//
+// AM_gridVisible()
+//
+// Fills am_grid_visible with the items whose cells overlap the frame,
+// in ascending order, and returns how many there are. Large windows fall
+// back to listing every item, which is cheaper than deduplicating.
+//
+static int AM_gridVisible(am_grid_t *grid, dboolean cull)
+{
+  int i, x, y, x1, x2, y1, y2;
+  int count = 0;
+
+  if (cull)
+  {
+    AM_gridCells(grid, am_frame.bbox, &x1, &x2, &y1, &y2);
+
+    if (am_frame.bbox[BOXRIGHT] < grid->orgx || am_frame.bbox[BOXTOP] < grid->orgy ||
+        ((am_frame.bbox[BOXLEFT] - grid->orgx) >> AM_GRID_SHIFT) >= grid->width ||
+        ((am_frame.bbox[BOXBOTTOM] - grid->orgy) >> AM_GRID_SHIFT) >= grid->height)
+      x2 = x1 - 1; // only dynamic items can be visible
+
+    cull = (x2 - x1 + 1) * (y2 - y1 + 1) * 2 < grid->width * grid->height;
+  }
+
+  if (!cull)
+  {
+    for (i = 0; i < grid->count; i++)
+      am_grid_visible[i] = i;
+
+    return grid->count;
+  }
+
+  grid->stamp++;
 
-    automap_style = AM_wallStyle(i);
+  for (i = 0; i < grid->dynamic_count; i++)
+    am_grid_visible[count++] = grid->dynamic[i];
 
-    switch (automap_style)
+  for (y = y1; y <= y2; y++)
+    for (x = x1; x <= x2; x++)
     {
-      case ams_invisible:
-        continue;
+      int cell = y * grid->width + x;
 
-      case ams_locked:
-        if (hide_locks)
-        {
-          AM_drawMline(&l, *mapcolor_grid_p);
-          continue;
-        }
+      for (i = grid->offsets[cell]; i < grid->offsets[cell + 1]; i++)
+      {
+        int item = grid->items[i];
 
-        switch (dsda_DoorType(i))
+        if (grid->stamps[item] != grid->stamp)
         {
-          case 0: // red
-            AM_drawMline(&l, (*mapcolor_rdor_p)? (*mapcolor_rdor_p) : (*mapcolor_cchg_p));
-            continue;
-          case 1: // blue
-            AM_drawMline(&l, (*mapcolor_bdor_p)? (*mapcolor_bdor_p) : (*mapcolor_cchg_p));
-            continue;
-          case 2: // yellow
-            AM_drawMline(&l, (*mapcolor_ydor_p)? (*mapcolor_ydor_p) : (*mapcolor_cchg_p));
-            continue;
-          default:
-            AM_drawMline(&l, (*mapcolor_clsd_p)? (*mapcolor_clsd_p) : (*mapcolor_cchg_p));
-            continue;
+          grid->stamps[item] = grid->stamp;
+          am_grid_visible[count++] = item;
         }
+      }
+    }
 
-      case ams_exit:
-        AM_drawMline(&l, (*mapcolor_exit_p));
-        continue;
+  qsort(am_grid_visible, count, sizeof(*am_grid_visible), AM_compareIndex);
 
-      case ams_one_sided:
-        AM_drawMline(&l, (*mapcolor_wall_p));
-        continue;
+  return count;
+}
 
-      case ams_secret:
-      case ams_unseen_secret:
-        AM_drawMline(&l, (*mapcolor_secr_p));
-        continue;
+static void AM_drawWall(int i, int hide_locks)
+{
+  automap_style_t automap_style;
+  static mline_t l;
 
-      case ams_revealed_secret:
-        AM_drawMline(&l, (*mapcolor_revsecr_p));
-        continue;
+  if (lines[i].bbox[BOXLEFT] >> FRACTOMAPBITS > am_frame.bbox[BOXRIGHT] ||
+    lines[i].bbox[BOXRIGHT] >> FRACTOMAPBITS < am_frame.bbox[BOXLEFT] ||
+    lines[i].bbox[BOXBOTTOM] >> FRACTOMAPBITS > am_frame.bbox[BOXTOP] ||
+    lines[i].bbox[BOXTOP] >> FRACTOMAPBITS < am_frame.bbox[BOXBOTTOM])
+  {
+    return;
+  }
 
-      case ams_teleport:
-        AM_drawMline(&l, (*mapcolor_tele_p));
-        continue;
+  automap_style = AM_wallStyle(i);
 
-      case ams_closed_door:
-        AM_drawMline(&l, (*mapcolor_clsd_p));
-        continue;
+  if (automap_style == ams_invisible)
+    return;
 
-      case ams_floor_diff:
-        AM_drawMline(&l, (*mapcolor_fchg_p));
-        continue;
+  l.a.x = lines[i].v1->x >> FRACTOMAPBITS;
+  l.a.y = lines[i].v1->y >> FRACTOMAPBITS;
+  l.b.x = lines[i].v2->x >> FRACTOMAPBITS;
+  l.b.y = lines[i].v2->y >> FRACTOMAPBITS;
 
-      case ams_ceiling_diff:
-        AM_drawMline(&l, (*mapcolor_cchg_p));
-        continue;
+  if (automap_rotate)
+  {
+    AM_rotatePoint(&l.a);
+    AM_rotatePoint(&l.b);
+  }
+  else
+  {
+    AM_SetMPointFloatValue(&l.a);
+    AM_SetMPointFloatValue(&l.b);
+  }
 
-      case ams_two_sided:
-        AM_drawMline(&l, (*mapcolor_flat_p));
-        continue;
+  switch (automap_style)
+  {
+    case ams_invisible:
+      return;
 
-      case ams_unseen:
-        AM_drawMline(&l, (*mapcolor_unsn_p));
-        continue;
-    }
+    case ams_locked:
+      if (hide_locks)
+      {
+        AM_drawMline(&l, *mapcolor_grid_p);
+        return;
+      }
+
+      switch (dsda_DoorType(i))
+      {
+        case 0: // red
+          AM_drawMline(&l, (*mapcolor_rdor_p)? (*mapcolor_rdor_p) : (*mapcolor_cchg_p));
+          return;
+        case 1: // blue
+          AM_drawMline(&l, (*mapcolor_bdor_p)? (*mapcolor_bdor_p) : (*mapcolor_cchg_p));
+          return;
+        case 2: // yellow
+          AM_drawMline(&l, (*mapcolor_ydor_p)? (*mapcolor_ydor_p) : (*mapcolor_cchg_p));
+          return;
+        default:
+          AM_drawMline(&l, (*mapcolor_clsd_p)? (*mapcolor_clsd_p) : (*mapcolor_cchg_p));
+          return;
+      }
+
+    case ams_exit:
+      AM_drawMline(&l, (*mapcolor_exit_p));
+      return;
+
+    case ams_one_sided:
+      AM_drawMline(&l, (*mapcolor_wall_p));
+      return;
+
+    case ams_secret:
+    case ams_unseen_secret:
+      AM_drawMline(&l, (*mapcolor_secr_p));
+      return;
+
+    case ams_revealed_secret:
+      AM_drawMline(&l, (*mapcolor_revsecr_p));
+      return;
+
+    case ams_teleport:
+      AM_drawMline(&l, (*mapcolor_tele_p));
+      return;
+
+    case ams_closed_door:
+      AM_drawMline(&l, (*mapcolor_clsd_p));
+      return;
+
+    case ams_floor_diff:
+      AM_drawMline(&l, (*mapcolor_fchg_p));
+      return;
+
+    case ams_ceiling_diff:
+      AM_drawMline(&l, (*mapcolor_cchg_p));
+      return;
+
+    case ams_two_sided:
+      AM_drawMline(&l, (*mapcolor_flat_p));
+      return;
+
+    case ams_unseen:
+      AM_drawMline(&l, (*mapcolor_unsn_p));
+      return;
   }
 }
 
+static void AM_drawWalls(void)
+{
+  int i, count;
+  int hide_locks;
+
+  hide_locks = map_blinking_locks && (gametic & 16);
+
+  // draw the unclipped visible portions of all lines
+  count = AM_gridVisible(&am_line_grid, true);
+  for (i = 0; i < count; i++)
+    AM_drawWall(am_grid_visible[i], hide_locks);
+}
+
 //
 // AM_drawLineCharacter()
 //
@@ -2113,9 +2334,14 @@ static void AM_DrawNiceThings(void)
   // walls
   if (dsda_RevealAutomap() == 2)
   {
+    int vi, count;
+
     // for all sectors
-    for (i = 0; i < numsectors; i++)
+    count = AM_gridVisible(&am_sector_grid, !(players[displayplayer].cheats & CF_NOCLIP));
+    for (vi = 0; vi < count; vi++)
     {
+      i = am_grid_visible[vi];
+
       if (!(players[displayplayer].cheats & CF_NOCLIP) &&
         (sectors[i].bbox[BOXLEFT] > am_frame.bbox[BOXRIGHT] ||
         sectors[i].bbox[BOXRIGHT] < am_frame.bbox[BOXLEFT] ||
@@ -2190,7 +2416,7 @@ static void AM_DrawNiceThings(void)
 //
 static void AM_drawThings(void)
 {
-  int   i;
+  int   i, vi, count;
   mobj_t* t;
 
 #if defined(HAVE_LIBSDL2_IMAGE)
@@ -2208,7 +2434,8 @@ static void AM_drawThings(void)
     return;
 
   // for all sectors
-  for (i=0;i<numsectors;i++)
+  count = AM_gridVisible(&am_sector_grid, !(players[displayplayer].cheats & CF_NOCLIP));
+  for (vi = 0; vi < count; vi++)
   {
    // e6y
    // Two-pass method for better usability of automap:
@@ -2218,6 +2445,8 @@ static void AM_drawThings(void)
    int pass;
    int enemies = 0;
 
+   i = am_grid_visible[vi];
+
    if (!(players[displayplayer].cheats & CF_NOCLIP) &&
      (sectors[i].bbox[BOXLEFT] > am_frame.bbox[BOXRIGHT] ||
      sectors[i].bbox[BOXRIGHT] < am_frame.bbox[BOXLEFT] ||
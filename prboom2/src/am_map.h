@@ -84,6 +84,8 @@ void AM_setMarkParams(int num);
 
 void AM_SetResolution(void);
 
+void AM_InitSpatialIndex(void);
+
 typedef struct
 {
  fixed_t x,y;
@@ -61,6 +61,7 @@
 #include "e6y.h"
 
 #include "dsda/args.h"
+#include "dsda/benchmark.h"
 #include "dsda/settings.h"
 #include "dsda/time.h"
 
@@ -145,7 +146,9 @@ void TryRunTics (void)
     if (advancedemo)
       D_DoAdvanceDemo ();
     M_Ticker ();
+    dsda_BeginBenchmarkTic();
     G_Ticker ();
+    dsda_EndBenchmarkTic();
     gametic++;
     FakeNetUpdate();
   }
@@ -57,11 +57,14 @@
 #include "lprintf.h"
 
 #include "dsda/args.h"
+#include "dsda/benchmark.h"
+#include "dsda/deh_hash.h"
 #include "dsda/mobjinfo.h"
 #include "dsda/music.h"
 #include "dsda/sfx.h"
 #include "dsda/sprite.h"
 #include "dsda/state.h"
+#include "dsda/time.h"
 #include "dsda/utility.h"
 
 #define TRUE 1
@@ -119,63 +122,64 @@ const char * deh_getBitsDelims(void)
 
 typedef struct {
   /* cph 2006/08/06 -
-   * if lump != NULL, lump is the start of the lump,
+   * lump is the start of the lump,
    * inp is the current read pos. */
   const byte *inp, *lump;
   long size;
-  /* else, !lump, and f is the file being read */
-  FILE* f;
+  /* files are read whole into data, which is freed when done */
+  char *data;
 } DEHFILE;
 
 // killough 10/98: emulate IO whether input really comes from a file or not
+// Files are read into memory and split into lines the same way as lumps
 
 static char *dehfgets(char *buf, size_t n, DEHFILE *fp)
 {
-  if (!fp->lump)                                     // If this is a real file,
-    return (fgets)(buf, n, fp->f);                   // return regular fgets
   if (!n || !*fp->inp || fp->size <= 0)                // If no more characters
     return NULL;
   if (n == 1)
     fp->size--, *buf = *fp->inp++;
   else
   {                                                // copy buffer
-    char *p = buf;
-    while (n > 1 && *fp->inp && fp->size &&
-           (n--, fp->size--, *p++ = *fp->inp++) != '\n')
-      ;
-    *p = 0;
+    // Copy up to and including the newline; a null byte ends the input
+    size_t len = MIN(n - 1, (size_t) fp->size);
+    const byte *end;
+
+    if ((end = memchr(fp->inp, '\n', len)))
+      len = end - fp->inp + 1;
+    if ((end = memchr(fp->inp, 0, len)))
+      len = end - fp->inp;
+
+    memcpy(buf, fp->inp, len);
+    buf[len] = 0;
+    fp->inp += len;
+    fp->size -= len;
   }
   return buf;                                        // Return buffer pointer
 }
 
 static int dehfeof(DEHFILE *fp)
 {
-  return !fp->lump ? feof(fp->f) : !*fp->inp || fp->size <= 0;
+  return !*fp->inp || fp->size <= 0;
 }
 
 static int dehfgetc(DEHFILE *fp)
 {
-  return !fp->lump ? fgetc(fp->f) : fp->size > 0 ?
-    fp->size--, *fp->inp++ : EOF;
+  return fp->size > 0 ? fp->size--, *fp->inp++ : EOF;
 }
 
 static long dehftell(DEHFILE *fp)
 {
-  return !fp->lump ? ftell(fp->f) : (fp->inp - fp->lump);
+  return fp->inp - fp->lump;
 }
 
 static int dehfseek(DEHFILE *fp, long offset)
 {
-  if (!fp->lump)
-    return fseek(fp->f, offset, SEEK_SET);
-  else
-  {
-    long total = (fp->inp - fp->lump) + fp->size;
-    offset = BETWEEN(0, total, offset);
-    fp->inp = fp->lump + offset;
-    fp->size = total - offset;
-    return 0;
-  }
+  long total = (fp->inp - fp->lump) + fp->size;
+  offset = BETWEEN(0, total, offset);
+  fp->inp = fp->lump + offset;
+  fp->size = total - offset;
+  return 0;
 }
 
 static char *deh_sfx_name(const char *name)
@@ -1140,6 +1144,10 @@ static const char *deh_mobjinfo_fields[] =
   NULL
 };
 
+#define DEH_MOBJINFO_FIELDS (sizeof(deh_mobjinfo_fields) / sizeof(*deh_mobjinfo_fields))
+
+static deh_string_hash_t deh_mobjinfo_hash;
+
 // Strings that are used to indicate flags ("Bits" in mobjinfo)
 // This is an array of bit masks that are related to p_mobj.h
 // values, using the smae names without the MF_ in front.
@@ -1315,6 +1323,10 @@ static const char *deh_state_fields[] = // CPhipps - static const*
   "MBF21 Bits",       // .flags
 };
 
+#define DEH_STATE_FIELDS (sizeof(deh_state_fields) / sizeof(*deh_state_fields))
+
+static deh_string_hash_t deh_state_hash;
+
 static const struct deh_flag_s deh_stateflags_mbf21[] = {
   { "SKILL5FAST", STATEF_SKILL5FAST }, // tics halve on nightmare skill
   { NULL }
@@ -1541,6 +1553,88 @@ dboolean IsDehMaxHealth = false;
 dboolean IsDehMaxSoul = false;
 dboolean IsDehMegaHealth = false;
 
+// Key tables are hashed on first use. The hash ignores case, and the
+// chain is walked with deh_strcasecmp so that the boom parser keeps its
+// case-sensitive matching and the first table entry still wins.
+
+static void deh_hashFields(deh_string_hash_t *hash, const char **fields, int count)
+{
+  int ix;
+
+  for (ix = 0; ix < count && fields[ix]; ix++)
+    dsda_AddDehString(hash, fields[ix], ix);
+}
+
+static const deh_string_entry_t *deh_findKey(const deh_string_hash_t *hash,
+                                             const deh_string_entry_t *entry,
+                                             const char *key)
+{
+  while (entry && deh_strcasecmp(key, entry->key))
+    entry = dsda_NextDehString(hash, entry);
+
+  return entry;
+}
+
+static const deh_string_entry_t *deh_firstField(deh_string_hash_t *hash, const char **fields,
+                                                int count, const char *key)
+{
+  if (!hash->count)
+    deh_hashFields(hash, fields, count);
+
+  return deh_findKey(hash, dsda_FindDehString(hash, key), key);
+}
+
+static const deh_string_entry_t *deh_nextField(const deh_string_hash_t *hash,
+                                               const deh_string_entry_t *entry,
+                                               const char *key)
+{
+  return deh_findKey(hash, dsda_NextDehString(hash, entry), key);
+}
+
+static int deh_findField(deh_string_hash_t *hash, const char **fields, int count, const char *key)
+{
+  const deh_string_entry_t *entry;
+
+  entry = deh_firstField(hash, fields, count, key);
+
+  return entry ? entry->value : -1;
+}
+
+#define DEH_FLAG_TABLES 4
+
+static const struct deh_flag_s *deh_findFlag(const struct deh_flag_s *flags, const char *name)
+{
+  static struct {
+    const struct deh_flag_s *flags;
+    deh_string_hash_t hash;
+  } flag_hashes[DEH_FLAG_TABLES];
+  const deh_string_entry_t *entry;
+  int i;
+
+  for (i = 0; i < DEH_FLAG_TABLES; i++)
+  {
+    if (flag_hashes[i].flags == flags)
+      break;
+
+    if (!flag_hashes[i].flags)
+    {
+      const struct deh_flag_s *flag;
+
+      flag_hashes[i].flags = flags;
+      for (flag = flags; flag->name; flag++)
+        dsda_AddDehString(&flag_hashes[i].hash, flag->name, flag - flags);
+      break;
+    }
+  }
+
+  if (i == DEH_FLAG_TABLES)
+    I_Error("deh_findFlag: too many flag tables");
+
+  entry = deh_findKey(&flag_hashes[i].hash, dsda_FindDehString(&flag_hashes[i].hash, name), name);
+
+  return entry ? &flags[entry->value] : NULL;
+}
+
 static uint64_t deh_stringToFlags(char *strval, const struct deh_flag_s *flags)
 {
   uint64_t value;
@@ -1548,14 +1642,11 @@ static uint64_t deh_stringToFlags(char *strval, const struct deh_flag_s *flags)
   for (value = 0; (strval = strtok(strval, deh_getBitsDelims())); strval = NULL) {
     const struct deh_flag_s *flag;
 
-    for (flag = flags; flag->name; flag++) {
-      if (deh_strcasecmp(strval, flag->name)) continue;
+    flag = deh_findFlag(flags, strval);
 
+    if (flag)
       value |= flag->value;
-      break;
-    }
-
-    if (!flag->name)
+    else
       deh_log("Could not find MBF21 bit mnemonic %s\n", strval);
   }
 
@@ -1650,6 +1741,7 @@ void ProcessDehFile(const char *filename, const char *outfilename, int lumpnum)
   const char *file_or_lump;
   static unsigned last_block;
   static long filepos;
+  static int depth;
 
   processed_dehacked = true;
 
@@ -1671,16 +1763,20 @@ void ProcessDehFile(const char *filename, const char *outfilename, int lumpnum)
 
   if (filename)
   {
-    if (!(infile.f = M_OpenFile(filename, "rt")))
+    int length = M_ReadFileToString(filename, &infile.data);
+
+    if (length < 0)
     {
       lprintf(LO_WARN, "-deh file %s not found\n", filename);
       return;  // should be checked up front anyway
     }
-    infile.lump = NULL;
+    infile.size = length;
+    infile.inp = infile.lump = (const byte *) infile.data;
     file_or_lump = "file";
   }
   else  // DEH file comes from lump indicated by third argument
   {
+    infile.data = NULL;
     infile.size = W_LumpLength(lumpnum);
     infile.inp = infile.lump = W_LumpByNum(lumpnum);
     // [FG] skip empty DEHACKED lumps
@@ -1696,6 +1792,9 @@ void ProcessDehFile(const char *filename, const char *outfilename, int lumpnum)
   lprintf(LO_INFO, "Loading DEH %s %s\n", file_or_lump, filename);
   deh_log("\nLoading DEH %s %s\n\n", file_or_lump, filename);
 
+  if (!depth++)
+    dsda_StartTimer(dsda_timer_dehacked);
+
   // loop until end of file
 
   last_block = DEH_BLOCKMAX - 1;
@@ -1727,7 +1826,7 @@ void ProcessDehFile(const char *filename, const char *outfilename, int lumpnum)
       // killough 10/98: exclude if inside wads (only to discourage
       // the practice, since the code could otherwise handle it)
 
-      if (infile.lump)
+      if (!infile.data)
       {
         deh_log("No files may be included from wads: %s\n", inbuffer);
         continue;
@@ -1772,8 +1871,10 @@ void ProcessDehFile(const char *filename, const char *outfilename, int lumpnum)
     filepos = dehftell(filein);
   }
 
-  if (!infile.lump)
-    fclose(infile.f);                         // Close real file
+  Z_Free(infile.data);                        // Free real file
+
+  if (!--depth)
+    dsda_AddBenchmarkDehTime(dsda_ElapsedTime(dsda_timer_dehacked));
 
   if (outfilename)   // killough 10/98: only at top recursion level
   {
@@ -1800,6 +1901,8 @@ static void deh_procBexCodePointers(DEHFILE *fpin, char *line)
   char mnemonic[DEH_MAXKEYLEN];  // to hold the codepointer mnemonic
   int i; // looper
   dboolean found; // know if we found this one during lookup or not
+  const deh_string_entry_t *entry;
+  static deh_string_hash_t bexptr_hash;
   dsda_deh_state_t deh_state;
 
   // Ty 05/16/98 - initialize it to something, dummy!
@@ -1830,19 +1933,26 @@ static void deh_procBexCodePointers(DEHFILE *fpin, char *line)
 
     deh_state = dsda_GetDehState(indexnum);
 
-    found = FALSE;
-    i= -1; // incremented to start at zero at the top of the loop
-    do  // Ty 05/16/98 - fix loop logic to look for null ending entry
+    // The null ending entry is searched too
+    if (!bexptr_hash.count)
     {
-      ++i;
-      if (!stricmp(key, deh_bexptrs[i].lookup))
-      {  // Ty 06/01/98  - add  to states[].action for new djgcc version
-        deh_state.state->action = deh_bexptrs[i].cptr; // assign
-        deh_log(" - applied %s from codeptr[%d] to states[%d]\n",
-                deh_bexptrs[i].lookup, i, indexnum);
-        found = TRUE;
-      }
-    } while (!found && (deh_bexptrs[i].cptr != NULL));
+      i = -1;
+      do
+      {
+        ++i;
+        dsda_AddDehString(&bexptr_hash, deh_bexptrs[i].lookup, i);
+      } while (deh_bexptrs[i].cptr != NULL);
+    }
+
+    entry = dsda_FindDehString(&bexptr_hash, key);
+    found = entry != NULL;
+    if (found)
+    {  // Ty 06/01/98  - add  to states[].action for new djgcc version
+      i = entry->value;
+      deh_state.state->action = deh_bexptrs[i].cptr; // assign
+      deh_log(" - applied %s from codeptr[%d] to states[%d]\n",
+              deh_bexptrs[i].lookup, i, indexnum);
+    }
 
     if (!found)
       deh_log("Invalid frame pointer mnemonic '%s' at %d\n", mnemonic, indexnum);
@@ -2012,6 +2122,7 @@ static void deh_procThing(DEHFILE *fpin, char *line)
   int internal_index;
   int ix;
   char *strval;
+  const deh_string_entry_t *field;
   dsda_deh_mobjinfo_t deh_mobjinfo;
 
   strncpy(inbuffer, line, DEH_BUFFERMAX - 1);
@@ -2054,8 +2165,9 @@ static void deh_procThing(DEHFILE *fpin, char *line)
       continue;
     }
 
-    for (ix = 0; deh_mobjinfo_fields[ix]; ix++) {
-      if (deh_strcasecmp(key, deh_mobjinfo_fields[ix])) continue;
+    for (field = deh_firstField(&deh_mobjinfo_hash, deh_mobjinfo_fields, DEH_MOBJINFO_FIELDS, key);
+         field; field = deh_nextField(&deh_mobjinfo_hash, field, key)) {
+      ix = field->value;
 
       if (!deh_strcasecmp(key, "MBF21 Bits")) {
         if (bGetData == 1)
@@ -2126,6 +2238,7 @@ static void deh_procFrame(DEHFILE *fpin, char *line)
   int indexnum;
   char *strval;
   int bGetData;
+  int field;
   dsda_deh_state_t deh_state;
 
   strncpy(inbuffer, line, DEH_BUFFERMAX - 1);
@@ -2153,90 +2266,92 @@ static void deh_procFrame(DEHFILE *fpin, char *line)
       continue;
     }
 
-    if (!deh_strcasecmp(key, deh_state_fields[0]))  // Sprite number
+    field = deh_findField(&deh_state_hash, deh_state_fields, DEH_STATE_FIELDS, key);
+
+    if (field == 0)  // Sprite number
     {
       deh_log(" - sprite = %ld\n", (long)value);
       deh_state.state->sprite = (spritenum_t)value;
     }
-    else if (!deh_strcasecmp(key, deh_state_fields[1]))  // Sprite subnumber
+    else if (field == 1)  // Sprite subnumber
     {
       deh_log(" - frame = %ld\n", (long)value);
       deh_state.state->frame = (long)value; // long
     }
-    else if (!deh_strcasecmp(key, deh_state_fields[2]))  // Duration
+    else if (field == 2)  // Duration
     {
       deh_log(" - tics = %ld\n", (long)value);
       deh_state.state->tics = (long)value; // long
     }
-    else if (!deh_strcasecmp(key, deh_state_fields[3]))  // Next frame
+    else if (field == 3)  // Next frame
     {
       deh_log(" - nextstate = %ld\n", (long)value);
       deh_state.state->nextstate = (statenum_t)value;
     }
-    else if (!deh_strcasecmp(key, deh_state_fields[4]))  // Codep frame (not set in Frame deh block)
+    else if (field == 4)  // Codep frame (not set in Frame deh block)
     {
       deh_log(" - codep, should not be set in Frame section!\n");
       /* nop */ ;
     }
-    else if (!deh_strcasecmp(key, deh_state_fields[5]))  // Unknown 1
+    else if (field == 5)  // Unknown 1
     {
       deh_log(" - misc1 = %ld\n", (long)value);
       deh_state.state->misc1 = (long)value; // long
     }
-    else if (!deh_strcasecmp(key, deh_state_fields[6]))  // Unknown 2
+    else if (field == 6)  // Unknown 2
     {
       deh_log(" - misc2 = %ld\n", (long)value);
       deh_state.state->misc2 = (long)value; // long
     }
-    else if (!deh_strcasecmp(key, deh_state_fields[7]))  // Args1
+    else if (field == 7)  // Args1
     {
       deh_log(" - args[0] = %lld\n", (statearg_t)value);
       deh_state.state->args[0] = (statearg_t)value;
       *deh_state.defined_codeptr_args |= (1 << 0);
     }
-    else if (!deh_strcasecmp(key, deh_state_fields[8]))  // Args2
+    else if (field == 8)  // Args2
     {
       deh_log(" - args[1] = %lld\n", (statearg_t)value);
       deh_state.state->args[1] = (statearg_t)value;
       *deh_state.defined_codeptr_args |= (1 << 1);
     }
-    else if (!deh_strcasecmp(key, deh_state_fields[9]))  // Args3
+    else if (field == 9)  // Args3
     {
       deh_log(" - args[2] = %lld\n", (statearg_t)value);
       deh_state.state->args[2] = (statearg_t)value;
       *deh_state.defined_codeptr_args |= (1 << 2);
     }
-    else if (!deh_strcasecmp(key, deh_state_fields[10]))  // Args4
+    else if (field == 10)  // Args4
     {
       deh_log(" - args[3] = %lld\n", (statearg_t)value);
       deh_state.state->args[3] = (statearg_t)value;
       *deh_state.defined_codeptr_args |= (1 << 3);
     }
-    else if (!deh_strcasecmp(key, deh_state_fields[11]))  // Args5
+    else if (field == 11)  // Args5
     {
       deh_log(" - args[4] = %lld\n", (statearg_t)value);
       deh_state.state->args[4] = (statearg_t)value;
       *deh_state.defined_codeptr_args |= (1 << 4);
     }
-    else if (!deh_strcasecmp(key, deh_state_fields[12]))  // Args6
+    else if (field == 12)  // Args6
     {
       deh_log(" - args[5] = %lld\n", (statearg_t)value);
       deh_state.state->args[5] = (statearg_t)value;
       *deh_state.defined_codeptr_args |= (1 << 5);
     }
-    else if (!deh_strcasecmp(key, deh_state_fields[13]))  // Args7
+    else if (field == 13)  // Args7
     {
       deh_log(" - args[6] = %lld\n", (statearg_t)value);
       deh_state.state->args[6] = (statearg_t)value;
       *deh_state.defined_codeptr_args |= (1 << 6);
     }
-    else if (!deh_strcasecmp(key, deh_state_fields[14]))  // Args8
+    else if (field == 14)  // Args8
     {
       deh_log(" - args[7] = %lld\n", (statearg_t)value);
       deh_state.state->args[7] = (statearg_t)value;
       *deh_state.defined_codeptr_args |= (1 << 7);
     }
-    else if (!deh_strcasecmp(key, deh_state_fields[15]))  // MBF21 Bits
+    else if (field == 15)  // MBF21 Bits
     {
       if (bGetData == 1)
       {
@@ -2247,14 +2362,12 @@ static void deh_procFrame(DEHFILE *fpin, char *line)
         for (value = 0; (strval = strtok(strval, deh_getBitsDelims())); strval = NULL) {
           const struct deh_flag_s *flag;
 
-          for (flag = deh_stateflags_mbf21; flag->name; flag++) {
-            if (deh_strcasecmp(strval, flag->name)) continue;
+          flag = deh_findFlag(deh_stateflags_mbf21, strval);
 
+          if (flag) {
             value |= flag->value;
-            break;
           }
-
-          if (!flag->name) {
+          else {
             deh_log("Could not find MBF21 frame bit mnemonic %s\n", strval);
           }
         }
@@ -2502,14 +2615,12 @@ static void deh_procWeapon(DEHFILE *fpin, char *line)
         for (value = 0; (strval = strtok(strval, deh_getBitsDelims())); strval = NULL) {
           const struct deh_flag_s *flag;
 
-          for (flag = deh_weaponflags_mbf21; flag->name; flag++) {
-            if (deh_strcasecmp(strval, flag->name)) continue;
+          flag = deh_findFlag(deh_weaponflags_mbf21, strval);
 
+          if (flag) {
             value |= flag->value;
-            break;
           }
-
-          if (!flag->name) {
+          else {
             deh_log("Could not find MBF21 weapon bit mnemonic %s\n", strval);
           }
         }
@@ -2987,55 +3098,66 @@ static void deh_procStrings(DEHFILE *fpin, char *line)
 //
 dboolean deh_procStringSub(char *key, char *lookfor, char *newstring)
 {
-  dboolean found; // loop exit flag
-  int i;  // looper
+  dboolean found;
+  int i;
+  static deh_string_hash_t lookup_hash;
+  static deh_string_hash_t orig_hash;
+  const deh_string_entry_t *entry;
 
-  found = false;
-  for (i = 0; i < deh_numstrlookup; i++)
+  // The original strings are remembered before any of them is replaced
+  if (!lookup_hash.count)
   {
-    if (deh_strlookup[i].orig == NULL)
+    for (i = 0; i < deh_numstrlookup; i++)
     {
-      deh_strlookup[i].orig = *deh_strlookup[i].ppstr;
+      if (deh_strlookup[i].orig == NULL)
+      {
+        deh_strlookup[i].orig = *deh_strlookup[i].ppstr;
+      }
+
+      dsda_AddDehString(&lookup_hash, deh_strlookup[i].lookup, i);
+      dsda_AddDehString(&orig_hash, deh_strlookup[i].orig, i);
     }
-    found = lookfor ?
-      !stricmp(deh_strlookup[i].orig, lookfor) :
-      !stricmp(deh_strlookup[i].lookup, key);
+  }
 
-    if (found)
+  entry = lookfor ?
+    dsda_FindDehString(&orig_hash, lookfor) :
+    dsda_FindDehString(&lookup_hash, key);
+
+  found = entry != NULL;
+
+  if (found)
+  {
+    char *t;
+
+    i = entry->value;
+    *deh_strlookup[i].ppstr = t = Z_Strdup(newstring); // orphan originalstring
+    // Handle embedded \n's in the incoming string, convert to 0x0a's
     {
-      char *t;
-      *deh_strlookup[i].ppstr = t = Z_Strdup(newstring); // orphan originalstring
-      found = true;
-      // Handle embedded \n's in the incoming string, convert to 0x0a's
+      const char *s;
+      for (s = *deh_strlookup[i].ppstr; *s; ++s, ++t)
       {
-        const char *s;
-        for (s = *deh_strlookup[i].ppstr; *s; ++s, ++t)
-        {
-          if (*s == '\\' && (s[1] == 'n' || s[1] == 'N')) //found one
-            ++s, *t = '\n';  // skip one extra for second character
-          else
-            *t = *s;
-        }
-        *t = '\0';  // cap off the target string
+        if (*s == '\\' && (s[1] == 'n' || s[1] == 'N')) //found one
+          ++s, *t = '\n';  // skip one extra for second character
+        else
+          *t = *s;
       }
+      *t = '\0';  // cap off the target string
+    }
 
-      if (key)
-        deh_log("Assigned key %s => '%s'\n", key, newstring);
-
-      if (!key)
-        deh_log("Assigned '%.12s%s' to'%.12s%s' at key %s\n",
-                lookfor, (strlen(lookfor) > 12) ? "..." : "",
-                newstring, (strlen(newstring) > 12) ? "..." :"",
-                deh_strlookup[i].lookup);
+    if (key)
+      deh_log("Assigned key %s => '%s'\n", key, newstring);
 
-      if (!key) // must have passed an old style string so showBEX
-        deh_log("*BEX FORMAT:\n%s = %s\n*END BEX\n",
-                deh_strlookup[i].lookup, dehReformatStr(newstring));
+    if (!key)
+      deh_log("Assigned '%.12s%s' to'%.12s%s' at key %s\n",
+              lookfor, (strlen(lookfor) > 12) ? "..." : "",
+              newstring, (strlen(newstring) > 12) ? "..." :"",
+              deh_strlookup[i].lookup);
 
-      break;
-    }
+    if (!key) // must have passed an old style string so showBEX
+      deh_log("*BEX FORMAT:\n%s = %s\n*END BEX\n",
+              deh_strlookup[i].lookup, dehReformatStr(newstring));
   }
-  if (!found)
+  else
     deh_log("Could not find '%.12s'\n", key ? key : lookfor);
 
   return found;
@@ -84,12 +84,15 @@
 #include "e6y.h"
 
 #include "dsda/args.h"
+#include "dsda/benchmark.h"
 #include "dsda/configuration.h"
 #include "dsda/demo.h"
 #include "dsda/exdemo.h"
 #include "dsda/features.h"
 #include "dsda/global.h"
+#include "dsda/key_frame_index.h"
 #include "dsda/save.h"
+#include "dsda/segment.h"
 #include "dsda/data_organizer.h"
 #include "dsda/map_format.h"
 #include "dsda/mapinfo.h"
@@ -105,7 +108,11 @@
 #include "dsda/skill_info.h"
 #include "dsda/skip.h"
 #include "dsda/sndinfo.h"
+#include "dsda/startup.h"
+#include "dsda/state_hash.h"
+#include "dsda/stats_stream.h"
 #include "dsda/time.h"
+#include "dsda/trajectory.h"
 #include "dsda/utility.h"
 #include "dsda/wad_stats.h"
 #include "dsda/zipfile.h"
@@ -232,6 +239,8 @@ void D_PostEvent(event_t *ev)
 static void D_Wipe(void)
 {
   dboolean done;
+  dboolean capture_wipe;
+  int capture_frame;
   int wipestart;
   int old_game_speed = 0;
 
@@ -253,17 +262,31 @@ static void D_Wipe(void)
   }
 
   wipestart = dsda_GetTick() - 1;
+  capture_wipe = capturing_video && V_IsSoftwareMode();
+  capture_frame = 0;
 
   do
   {
     int nowtime, tics;
-    do
+
+    if (capture_wipe)
     {
-      I_uSleep(5000); // CPhipps - don't thrash cpu in this loop
-      nowtime = dsda_GetTick();
-      tics = nowtime - wipestart;
+      // Advance by the tics each video frame covers instead of waiting
+      tics = (capture_frame + 1) * TICRATE / cap_fps - capture_frame * TICRATE / cap_fps;
+      ++capture_frame;
+    }
+    else
+    {
+      do
+      {
+        I_uSleep(5000); // CPhipps - don't thrash cpu in this loop
+        nowtime = dsda_GetTick();
+        tics = nowtime - wipestart;
+      }
+      while (!tics);
+
+      wipestart = nowtime;
     }
-    while (!tics);
 
     // elim - Enable render-to-texture for GL so "melt" is rendered at same resolution as the game scene
     if (V_IsOpenGLMode())
@@ -272,7 +295,6 @@ static void D_Wipe(void)
       dsda_GLStartMeltRenderTexture();
     }
 
-    wipestart = nowtime;
     done = wipe_ScreenWipe(tics);
 
     // elim - Render texture to screen
@@ -353,6 +375,9 @@ void D_Display (fixed_t frac)
   // e6y
   if (dsda_SkipMode())
   {
+    if (!dsda_SkipModeFrame())
+      return;
+
     if (HU_DrawDemoProgress(false))
       I_FinishUpdate();
     if (!dsda_InputActive(dsda_input_use))
@@ -460,7 +485,9 @@ void D_Display (fixed_t frac)
     R_InterpolateView(&players[displayplayer], frac);
 
     DSDA_ADD_CONTEXT(sf_player_view);
+    dsda_BeginBenchmarkFrame();
     R_RenderPlayerView(&players[displayplayer]);
+    dsda_EndBenchmarkFrame();
     DSDA_REMOVE_CONTEXT(sf_player_view);
 
     dsda_UpdateRenderStats();
@@ -536,33 +563,42 @@ void D_Display (fixed_t frac)
 //  calls I_GetTime, I_StartFrame, and I_StartTic
 //
 
-FILE *stats_file;
+static char *D_StatsFileName(void)
+{
+  const char *name;
+  char *filename;
 
-void close_stats_file(void) {
-  if (stats_file) {
-    fflush(stats_file);
-    fclose(stats_file);
-  }
+  name = dsda_PlaybackName();
+  filename = strcpy(Z_Malloc(strlen(name)+5), name);
+  filename[strlen(name)-4]=0;
+  return AddDefaultExtension(filename, ".tsv");
 }
 
 static void D_DoomLoop(void)
 {
-  const char *name;
-  char *filename;
+  char *filename, *stream_filename;
+  int stats_level;
+  int stats_episode = -1, stats_map = -1;
 
   if (dsda_IntConfig(dsda_config_startup_delay_ms) > 0)
     I_uSleep(dsda_IntConfig(dsda_config_startup_delay_ms) * 1000);
 
-  I_AtExit(close_stats_file, true, "close_stats_file", exit_priority_normal);
+  I_AtExit(dsda_CloseStatsStream, true, "dsda_CloseStatsStream", exit_priority_normal);
 
-  name = dsda_PlaybackName();
-  lprintf(LO_INFO, "Playing from: \"%s\"\n", name);
-  filename = strcpy(Z_Malloc(strlen(name)+5), name);
-  filename[strlen(name)-4]=0;
-  filename = AddDefaultExtension(filename, ".tsv");
-  lprintf(LO_INFO, "Exporting to: \"%s\"\n", filename);
-  stats_file = M_OpenFile(filename, "wb");
-  fprintf(stats_file, "Tic\tKills\tItems\tSecrets\tHealth\tArmor\tSavings\tWeapons\tCurrent weapon\tBullets\tShels\tRockets\tCell\tAngle\tX\tY\tDistance walked\tDamage dealt\tSelf-damage\tBlack\tGray\tWhite\tSector\n");
+  lprintf(LO_INFO, "Playing from: \"%s\"\n", dsda_PlaybackName());
+  filename = D_StatsFileName();
+  stats_level = dsda_SimpleIntArg(dsda_arg_stats_compression);
+  if (dsda_SegmentWorker())
+  {
+    char *stats_filename = filename;
+
+    filename = dsda_SegmentFileName(stats_filename);
+    Z_Free(stats_filename);
+    stats_level = 0; // the coordinator compresses the joined output
+  }
+  stream_filename = dsda_OpenStatsStream(filename, stats_level);
+  lprintf(LO_INFO, "Exporting to: \"%s\"\n", stream_filename);
+  dsda_StatsPrintf("Tic\tKills\tItems\tSecrets\tHealth\tArmor\tSavings\tWeapons\tCurrent weapon\tBullets\tShels\tRockets\tCell\tAngle\tX\tY\tDistance walked\tDamage dealt\tSelf-damage\tBlack\tGray\tWhite\tSector\n");
 
   for (;;)
   {
@@ -577,12 +613,16 @@ static void D_DoomLoop(void)
     // // process one or more tics
     // if (singletics)
     // {
-      I_StartTic ();
+      dsda_UpdateSkipModeFrame();
+      if (dsda_SkipModeFrame())
+        I_StartTic ();
       G_BuildTiccmd (&local_cmds[consoleplayer][maketic%BACKUPTICS]);
       if (advancedemo)
         D_DoAdvanceDemo ();
       M_Ticker ();
+      dsda_BeginBenchmarkTic();
       G_Ticker ();
+      dsda_EndBenchmarkTic();
       gametic++;
       maketic++;
     // }
@@ -594,7 +634,15 @@ static void D_DoomLoop(void)
 
     if (!dsda_Paused() && !dsda_PausedViaMenu()) {
       R_ResetColorMap();
-      if (players[0].mo) {
+      dsda_ExportTrajectoryFrame();
+      if (gameepisode != stats_episode || gamemap != stats_map) {
+        if (stats_map != -1)
+          dsda_FlushStatsStream();
+        stats_episode = gameepisode;
+        stats_map = gamemap;
+      }
+      if (players[0].mo && dsda_SegmentRow(gametic + dsda_KeyFrameIndexGameticOffset())) {
+        int tic     = gametic + dsda_KeyFrameIndexGameticOffset();
         int health  = players[0].health;
         int armor   = players[0].armorpoints[ARMOR_ARMOR];
         int savings = 4 - players[0].armortype; // 0→<don't care>, 1→3, 2→2
@@ -616,11 +664,11 @@ static void D_DoomLoop(void)
 
         players[0].mo->distanceTraveled += sqrt(vx * vx + vy * vy + vz * vz);
 
-        if (!(gametic & 0xFF))
-          lprintf(LO_INFO, "%d/%d\t%d\t%d\t%d\t%d\n", gametic, demo_tics_count, x, y, sector);
+        if (!(tic & 0xFF))
+          lprintf(LO_INFO, "%d/%d\t%d\t%d\t%d\t%d\n", tic, demo_tics_count, x, y, sector);
 
-        fprintf(stats_file, "%d\t%d\t%d\t%d\t%d\t%d\t%d\t%c2%c%c%c%c%c%c%c\t%d\t%d\t%d\t%d\t%d\t%d\t%.2f\t%.2f\t%d\t%d\t%d\t#%06X\t#%06X\t#%06X\t%d\n",
-                gametic,
+        dsda_StatsPrintf("%d\t%d\t%d\t%d\t%d\t%d\t%d\t%c2%c%c%c%c%c%c%c\t%d\t%d\t%d\t%d\t%d\t%d\t%.2f\t%.2f\t%d\t%d\t%d\t#%06X\t#%06X\t#%06X\t%d\n",
+                tic,
                 players[0].killcount-players[0].maxkilldiscount,
                 players[0].itemcount,
                 players[0].secretcount,
@@ -1681,12 +1729,25 @@ static void D_DoomMainSetup(void)
 
   setbuf(stdout,NULL);
 
+  dsda_StartupPhase("arguments");
+
   if (dsda_Flag(dsda_arg_help))
   {
     dsda_PrintArgHelp();
     I_SafeExit(0);
   }
 
+  arg = dsda_Arg(dsda_arg_dump_trajectory);
+  if (arg->found)
+  {
+    dsda_DumpTrajectory(arg->value.v_string_array[0], atoi(arg->value.v_string_array[1]));
+    I_SafeExit(0);
+  }
+
+  arg = dsda_Arg(dsda_arg_compare_state_hash);
+  if (arg->found)
+    I_SafeExit(dsda_CompareStateHash(arg->value.v_string_array[0], arg->value.v_string_array[1]));
+
   DoLooseFiles();  // Ty 08/29/98 - handle "loose" files on command line
 
   IdentifyVersion();
@@ -1762,6 +1823,7 @@ static void D_DoomMainSetup(void)
   gld_InitCommandLine();
 
   //jff 9/3/98 use logical output routine
+  dsda_StartupPhase("V_Init");
   lprintf(LO_DEBUG, "V_Init: allocate screens.\n");
   V_Init();
 
@@ -1781,6 +1843,9 @@ static void D_DoomMainSetup(void)
 
   HandlePlayback(); // must come before autoload: may detect iwad in footer
 
+  if (dsda_ParallelExtraction())
+    I_SafeExit(dsda_RunParallelExtraction(D_StatsFileName()));
+
   EvaluateDoomVerStr(); // must come after HandlePlayback (may change iwad)
 
   // add wad files from autoload directory before wads from -file parameter
@@ -1843,6 +1908,7 @@ static void D_DoomMainSetup(void)
   D_InitFakeNetGame();
 
   //jff 9/3/98 use logical output routine
+  dsda_StartupPhase("W_Init");
   lprintf(LO_DEBUG, "W_Init: Init WADfiles.\n");
   W_Init(); // CPhipps - handling of wadfiles init changed
 
@@ -1860,10 +1926,17 @@ static void D_DoomMainSetup(void)
     }
   }
 
+  // The lump directory is final from here on
+  dsda_StartStartupJob(dsda_startup_textures);
+  dsda_StartStartupJob(dsda_startup_tranmap);
+
+  dsda_StartupPhase("OPTIONS");
   lprintf(LO_DEBUG, "G_ReloadDefaults: Checking OPTIONS.\n");
   dsda_ParseOptionsLump();
   G_ReloadDefaults();
 
+  dsda_StartupPhase("dehacked");
+
   // e6y
   // option to disable automatic loading of dehacked-in-wad lump
   if (!dsda_Flag(dsda_arg_nodeh))
@@ -1950,6 +2023,7 @@ static void D_DoomMainSetup(void)
   dsda_AppendZDoomMobjInfo();
   dsda_ApplyDefaultMapFormat();
 
+  dsda_StartupPhase("dsda_InitWadStats");
   lprintf(LO_DEBUG, "dsda_InitWadStats: Setting up wad stats.\n");
   dsda_InitWadStats();
 
@@ -1958,9 +2032,11 @@ static void D_DoomMainSetup(void)
   V_InitColorTranslation(); //jff 4/24/98 load color translation lumps
 
   //jff 9/3/98 use logical output routine
+  dsda_StartupPhase("M_Init");
   lprintf(LO_DEBUG, "M_Init: Init miscellaneous info.\n");
   M_Init();
 
+  dsda_StartupPhase("SNDINFO");
   dsda_LoadSndInfo();
 
   if (map_format.sndseq)
@@ -1968,15 +2044,22 @@ static void D_DoomMainSetup(void)
     SN_InitSequenceScript();
   }
 
+  // The sound table is final from here on
+  if (!nosfxparm)
+    dsda_StartStartupJob(dsda_startup_sound_lumps);
+
   //jff 9/3/98 use logical output routine
+  dsda_StartupPhase("R_Init");
   lprintf(LO_DEBUG, "R_Init: Init DOOM refresh daemon - ");
   R_Init();
 
+  dsda_StartupPhase("MAPINFO");
   dsda_LoadWadPreferences();
   dsda_LoadMapInfo();
   dsda_InitSkills();
 
   //jff 9/3/98 use logical output routine
+  dsda_StartupPhase("P_Init");
   lprintf(LO_DEBUG, "\nP_Init: Init Playloop state.\n");
   P_Init();
 
@@ -1987,17 +2070,22 @@ static void D_DoomMainSetup(void)
   dsda_HandleSkip();
 
   //jff 9/3/98 use logical output routine
+  dsda_StartupPhase("I_Init");
   lprintf(LO_DEBUG, "I_Init: Setting up machine state.\n");
   I_Init();
 
   //jff 9/3/98 use logical output routine
+  dsda_StartupPhase("S_Init");
   lprintf(LO_DEBUG, "S_Init: Setting up sound.\n");
   S_Init();
 
   //jff 9/3/98 use logical output routine
+  dsda_StartupPhase("dsda_InitFont");
   lprintf(LO_DEBUG, "dsda_InitFont: Loading the hud fonts.\n");
   dsda_InitFont();
 
+  dsda_StartupPhase("I_InitGraphics");
+
   if (!(dsda_Flag(dsda_arg_nodraw) && dsda_Flag(dsda_arg_nosound)))
     I_InitGraphics();
 
@@ -2009,9 +2097,12 @@ static void D_DoomMainSetup(void)
   }
 
   //jff 9/3/98 use logical output routine
+  dsda_StartupPhase("ST_Init");
   lprintf(LO_DEBUG, "ST_Init: Init status bar.\n");
   ST_Init();
 
+  dsda_EndStartup();
+
   // start the appropriate game based on parms
 
   arg = dsda_Arg(dsda_arg_record);
@@ -29,16 +29,21 @@
 
 #include "dsda/analysis.h"
 #include "dsda/args.h"
+#include "dsda/benchmark.h"
 #include "dsda/build.h"
 #include "dsda/demo.h"
 #include "dsda/exhud.h"
 #include "dsda/features.h"
 #include "dsda/ghost.h"
 #include "dsda/key_frame.h"
+#include "dsda/key_frame_index.h"
 #include "dsda/mouse.h"
+#include "dsda/segment.h"
 #include "dsda/settings.h"
 #include "dsda/split_tracker.h"
+#include "dsda/state_hash.h"
 #include "dsda/tracker.h"
+#include "dsda/trajectory.h"
 #include "dsda/wad_stats.h"
 #include "dsda.h"
 
@@ -178,8 +183,28 @@ void dsda_ReadCommandLine(void) {
   if (arg->found)
     dsda_InitGhostImport(arg->value.v_string_array, arg->count);
 
+  arg = dsda_Arg(dsda_arg_export_trajectory);
+  if (arg->found)
+    dsda_InitTrajectoryExport(arg->value.v_string);
+
+  arg = dsda_Arg(dsda_arg_export_state_hash);
+  if (arg->found)
+    dsda_InitStateHashExport(arg->value.v_string);
+
   if (dsda_Flag(dsda_arg_tas) || dsda_Flag(dsda_arg_build)) dsda_SetTas();
 
+  arg = dsda_Arg(dsda_arg_export_key_frame_index);
+  if (arg->found)
+    dsda_InitKeyFrameIndexExport(arg->value.v_string,
+                                 dsda_SimpleIntArg(dsda_arg_key_frame_index_interval));
+
+  arg = dsda_Arg(dsda_arg_key_frame_index);
+  if (arg->found)
+    dsda_LoadKeyFrameIndex(arg->value.v_string);
+
+  dsda_InitSegment();
+  dsda_InitBenchmark();
+
   dsda_InitKeyFrame();
   dsda_InitCommandHistory();
 }
@@ -385,6 +410,7 @@ int dsda_MaxKillRequirement() {
 
 void dsda_WatchPTickCompleted(void) {
   dsda_FlipLineActivationTracker();
+  dsda_ExportStateHash();
 }
 
 void dsda_WatchCommand(void) {
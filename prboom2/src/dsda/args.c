@@ -108,6 +108,36 @@ static arg_config_t arg_config[dsda_arg_count] = {
     "restores state and demo buffer from a key frame file",
     arg_string,
   },
+  [dsda_arg_export_key_frame_index] = {
+    "-export_key_frame_index", NULL, NULL,
+    "writes compressed key frames at each level start and interval during playback",
+    arg_string,
+  },
+  [dsda_arg_key_frame_index_interval] = {
+    "-key_frame_index_interval", NULL, NULL,
+    "sets the number of tics between exported key frame index entries",
+    arg_int, 1, INT_MAX,
+  },
+  [dsda_arg_key_frame_index] = {
+    "-key_frame_index", NULL, NULL,
+    "uses a key frame index to seek directly when skipping during playback",
+    arg_string,
+  },
+  [dsda_arg_extract_parallel] = {
+    "-extract_parallel", NULL, "0",
+    "splits extraction at key frame index level starts across the given number of processes",
+    arg_int, 0, INT_MAX,
+  },
+  [dsda_arg_extract_segment] = {
+    "-extract_segment", NULL, NULL,
+    "extracts stats between two key frame index tics (used by -extract_parallel)",
+    arg_int_array, -1, INT_MAX, 2, 2,
+  },
+  [dsda_arg_stats_compression] = {
+    "-stats_compression", NULL, "6",
+    "gzips the extracted stats at the given zlib level on a writer thread",
+    arg_int, 0, 9,
+  },
   [dsda_arg_warp] = {
     "-warp", NULL, NULL,
     "warp to the given episode and / or map",
@@ -353,6 +383,26 @@ static arg_config_t arg_config[dsda_arg_count] = {
     "imports at least one ghost file",
     arg_string_array, AT_LEAST_ONE_STRING,
   },
+  [dsda_arg_export_trajectory] = {
+    "-export_trajectory", NULL, NULL,
+    "exports the positions and states of all mobjs each tic",
+    arg_string,
+  },
+  [dsda_arg_dump_trajectory] = {
+    "-dump_trajectory", NULL, NULL,
+    "reconstructs the mobjs at a tic from a trajectory file (FILE TIC) and exits",
+    arg_string_array, EXACT_ARRAY_LENGTH(2),
+  },
+  [dsda_arg_export_state_hash] = {
+    "-export_state_hash", NULL, NULL,
+    "writes per-tic hashes of the sync-relevant game state to the given file",
+    arg_string,
+  },
+  [dsda_arg_compare_state_hash] = {
+    "-compare_state_hash", NULL, NULL,
+    "reports the first tic and component where two state hash files differ and exits",
+    arg_string_array, EXACT_ARRAY_LENGTH(2),
+  },
   [dsda_arg_consoleplayer] = {
     "-consoleplayer", NULL, NULL,
     "sets the console player (for coop playback)",
@@ -478,6 +528,51 @@ static arg_config_t arg_config[dsda_arg_count] = {
     "turn off drawing",
     arg_null,
   },
+  [dsda_arg_column_major] = {
+    "-column_major", NULL, NULL,
+    "draws the software 3D view column by column and transposes it to the screen",
+    arg_null,
+  },
+  [dsda_arg_benchmark_layouts] = {
+    "-benchmark_layouts", NULL, NULL,
+    "alternates row and column major view drawing and reports the time of each after -timedemo",
+    arg_null,
+  },
+  [dsda_arg_benchmark_json] = {
+    "-benchmark_json", NULL, NULL,
+    "writes frame and tic timings with percentiles to the given json file after -timedemo",
+    arg_string,
+  },
+  [dsda_arg_benchmark_archive] = {
+    "-benchmark_archive", NULL, NULL,
+    "archives the game state the given number of times after each level loads and reports the time",
+    arg_int, 1, 100000,
+  },
+  [dsda_arg_startup_profile] = {
+    "-startup_profile", NULL, NULL,
+    "reports the time and zone memory of each startup phase",
+    arg_null,
+  },
+  [dsda_arg_parallel_init] = {
+    "-parallel_init", NULL, NULL,
+    "builds texture tables, pages in sound lumps, and builds the default tranmap on worker threads during startup",
+    arg_null,
+  },
+  [dsda_arg_scalar_spans] = {
+    "-scalar_spans", NULL, NULL,
+    "disables the AVX2 flat span drawer",
+    arg_null,
+  },
+  [dsda_arg_plain_thinkers] = {
+    "-plain_thinkers", NULL, NULL,
+    "runs texture scrollers in the main thinker list instead of their own class",
+    arg_null,
+  },
+  [dsda_arg_headless] = {
+    "-headless", NULL, NULL,
+    "renders in software to memory without a window, for capture and screenshots",
+    arg_null,
+  },
   [dsda_arg_nodeh] = {
     "-nodeh", NULL, NULL,
     "skip dehacked lumps inside wads",
@@ -32,6 +32,12 @@ typedef enum {
   dsda_arg_record,
   dsda_arg_recordfromto,
   dsda_arg_from_key_frame,
+  dsda_arg_export_key_frame_index,
+  dsda_arg_key_frame_index_interval,
+  dsda_arg_key_frame_index,
+  dsda_arg_extract_parallel,
+  dsda_arg_extract_segment,
+  dsda_arg_stats_compression,
   dsda_arg_warp,
   dsda_arg_skill,
   dsda_arg_uv,
@@ -81,6 +87,10 @@ typedef enum {
   dsda_arg_track_playback,
   dsda_arg_export_ghost,
   dsda_arg_import_ghost,
+  dsda_arg_export_trajectory,
+  dsda_arg_dump_trajectory,
+  dsda_arg_export_state_hash,
+  dsda_arg_compare_state_hash,
   dsda_arg_consoleplayer,
   dsda_arg_spechit,
   dsda_arg_setmem,
@@ -106,6 +116,15 @@ typedef enum {
   dsda_arg_nomusic,
   dsda_arg_nosfx,
   dsda_arg_nodraw,
+  dsda_arg_column_major,
+  dsda_arg_benchmark_layouts,
+  dsda_arg_benchmark_json,
+  dsda_arg_benchmark_archive,
+  dsda_arg_startup_profile,
+  dsda_arg_parallel_init,
+  dsda_arg_scalar_spans,
+  dsda_arg_plain_thinkers,
+  dsda_arg_headless,
   dsda_arg_nodeh,
   dsda_arg_nomapinfo,
   dsda_arg_noautoload,
@@ -0,0 +1,188 @@
+//
+// Copyright(C) 2023 by Ryan Krafnick
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	DSDA Benchmark
+//
+//  Per frame render times and per tic game times collected during
+//    -timedemo, summarized as json for the benchmark runner in spec/.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "doomdef.h"
+#include "doomstat.h"
+#include "lprintf.h"
+#include "m_file.h"
+#include "v_video.h"
+#include "z_zone.h"
+
+#include "dsda/args.h"
+#include "dsda/startup.h"
+#include "dsda/time.h"
+
+#include "benchmark.h"
+
+#define DSDA_BENCHMARK_VERSION 1
+
+typedef struct {
+  unsigned int* samples;
+  int count;
+  int size;
+} benchmark_series_t;
+
+static const char* benchmark_filename;
+static benchmark_series_t frame_series;
+static benchmark_series_t tic_series;
+static unsigned long long deh_time;
+
+void dsda_InitBenchmark(void) {
+  dsda_arg_t* arg;
+
+  arg = dsda_Arg(dsda_arg_benchmark_json);
+
+  if (!arg->found)
+    return;
+
+  if (!dsda_Flag(dsda_arg_timedemo))
+    I_Error("-benchmark_json requires -timedemo");
+
+  benchmark_filename = arg->value.v_string;
+}
+
+static void dsda_RecordBenchmarkSample(benchmark_series_t* series, unsigned long long us) {
+  if (series->count == series->size) {
+    series->size = series->size ? series->size * 2 : 4096;
+    series->samples = Z_Realloc(series->samples, series->size * sizeof(*series->samples));
+  }
+
+  series->samples[series->count++] = (unsigned int) us;
+}
+
+void dsda_BeginBenchmarkFrame(void) {
+  if (benchmark_filename)
+    dsda_StartTimer(dsda_timer_benchmark_frame);
+}
+
+void dsda_EndBenchmarkFrame(void) {
+  if (benchmark_filename)
+    dsda_RecordBenchmarkSample(&frame_series, dsda_ElapsedTime(dsda_timer_benchmark_frame));
+}
+
+void dsda_BeginBenchmarkTic(void) {
+  if (benchmark_filename)
+    dsda_StartTimer(dsda_timer_benchmark_tic);
+}
+
+void dsda_EndBenchmarkTic(void) {
+  if (benchmark_filename)
+    dsda_RecordBenchmarkSample(&tic_series, dsda_ElapsedTime(dsda_timer_benchmark_tic));
+}
+
+// Accumulated over every dehacked file and lump loaded at startup
+void dsda_AddBenchmarkDehTime(unsigned long long us) {
+  deh_time += us;
+}
+
+static int dsda_CompareSamples(const void* a, const void* b) {
+  unsigned int x = *(const unsigned int*) a;
+  unsigned int y = *(const unsigned int*) b;
+
+  return (x > y) - (x < y);
+}
+
+// Nearest rank on sorted samples
+static unsigned int dsda_Percentile(const benchmark_series_t* series, int percent) {
+  int rank;
+
+  rank = (series->count * percent + 99) / 100;
+  if (rank < 1)
+    rank = 1;
+
+  return series->samples[rank - 1];
+}
+
+static void dsda_WriteBenchmarkSeries(FILE* file, const char* name,
+                                      benchmark_series_t* series, dboolean last) {
+  unsigned long long total = 0;
+  int i;
+
+  fprintf(file, "  \"%s\": {\n", name);
+  fprintf(file, "    \"count\": %d", series->count);
+
+  if (series->count) {
+    qsort(series->samples, series->count, sizeof(*series->samples), dsda_CompareSamples);
+
+    for (i = 0; i < series->count; ++i)
+      total += series->samples[i];
+
+    fprintf(file, ",\n    \"mean\": %.1f", (double) total / series->count);
+    fprintf(file, ",\n    \"p50\": %u", dsda_Percentile(series, 50));
+    fprintf(file, ",\n    \"p90\": %u", dsda_Percentile(series, 90));
+    fprintf(file, ",\n    \"p99\": %u", dsda_Percentile(series, 99));
+    fprintf(file, ",\n    \"max\": %u", series->samples[series->count - 1]);
+  }
+
+  fprintf(file, "\n  }%s\n", last ? "" : ",");
+}
+
+static void dsda_WriteJSONString(FILE* file, const char* str) {
+  fputc('"', file);
+
+  for (; *str; ++str) {
+    if (*str == '"' || *str == '\\')
+      fputc('\\', file);
+
+    fputc(*str, file);
+  }
+
+  fputc('"', file);
+}
+
+void dsda_WriteBenchmark(unsigned int gametics, unsigned int realtics) {
+  FILE* file;
+
+  if (!benchmark_filename)
+    return;
+
+  file = M_OpenFile(benchmark_filename, "w");
+
+  if (!file) {
+    lprintf(LO_WARN, "dsda_WriteBenchmark: failed to open %s\n", benchmark_filename);
+    return;
+  }
+
+  fprintf(file, "{\n");
+  fprintf(file, "  \"version\": %d,\n", DSDA_BENCHMARK_VERSION);
+  fprintf(file, "  \"demo\": ");
+  dsda_WriteJSONString(file, dsda_Arg(dsda_arg_timedemo)->value.v_string);
+  fprintf(file, ",\n");
+  fprintf(file, "  \"renderer\": \"%s\",\n", V_IsOpenGLMode() ? "opengl" : "software");
+  fprintf(file, "  \"width\": %d,\n", SCREENWIDTH);
+  fprintf(file, "  \"height\": %d,\n", SCREENHEIGHT);
+  fprintf(file, "  \"gametics\": %u,\n", gametics);
+  fprintf(file, "  \"realtics\": %u,\n", realtics);
+  fprintf(file, "  \"fps\": %.1f,\n", realtics ? gametics * (double) TICRATE / realtics : 0.0);
+  fprintf(file, "  \"peak_zone_bytes\": %llu,\n", (unsigned long long) Z_PeakUsage());
+  fprintf(file, "  \"deh_us\": %llu,\n", deh_time);
+  fprintf(file, "  \"startup_us\": %llu,\n", dsda_StartupTime());
+
+  dsda_WriteBenchmarkSeries(file, "frame_us", &frame_series, false);
+  dsda_WriteBenchmarkSeries(file, "tic_us", &tic_series, true);
+
+  fprintf(file, "}\n");
+  fclose(file);
+
+  lprintf(LO_INFO, "dsda_WriteBenchmark: wrote %s\n", benchmark_filename);
+}
@@ -0,0 +1,29 @@
+//
+// Copyright(C) 2023 by Ryan Krafnick
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	DSDA Benchmark
+//
+
+#ifndef __DSDA_BENCHMARK__
+#define __DSDA_BENCHMARK__
+
+void dsda_InitBenchmark(void);
+void dsda_BeginBenchmarkFrame(void);
+void dsda_EndBenchmarkFrame(void);
+void dsda_BeginBenchmarkTic(void);
+void dsda_EndBenchmarkTic(void);
+void dsda_AddBenchmarkDehTime(unsigned long long us);
+void dsda_WriteBenchmark(unsigned int gametics, unsigned int realtics);
+
+#endif
@@ -22,12 +22,18 @@
 #include "doomstat.h"
 #include "lprintf.h"
 #include "m_random.h"
+#include "p_mobj.h"
+#include "p_saveg.h"
+#include "p_spec.h"
+#include "p_tick.h"
 #include "r_state.h"
+#include "z_zone.h"
 
 #include "dsda/build.h"
 #include "dsda/demo.h"
 #include "dsda/features.h"
 #include "dsda/key_frame.h"
+#include "dsda/scroll.h"
 #include "dsda/skip.h"
 #include "dsda/time.h"
 #include "dsda/utility.h"
@@ -36,6 +42,7 @@
 
 #define MAX_BF_DEPTH 35
 #define MAX_BF_CONDITIONS 16
+#define MAX_BF_CACHE_SIZE (1 << 22)
 
 typedef struct {
   int min;
@@ -82,6 +89,20 @@ static dsda_key_frame_t nomo_key_frame;
 static bf_target_t bf_target;
 static ticcmd_t bf_result[MAX_BF_DEPTH];
 
+// States already reached at each depth, keyed by a 64 bit hash
+typedef struct {
+  unsigned long long* keys;
+  int size;
+  int count;
+} bf_cache_t;
+
+static dboolean bf_cache_enabled;
+static bf_cache_t bf_cache[MAX_BF_DEPTH];
+static long long bf_subtree_volume[MAX_BF_DEPTH + 1];
+static long long bf_cache_hits;
+static long long bf_cache_pruned;
+static long long bf_progress_volume;
+
 const char* dsda_bf_attribute_names[dsda_bf_attribute_max] = {
   [dsda_bf_x] = "x",
   [dsda_bf_y] = "y",
@@ -228,6 +249,330 @@ static void dsda_PrintBFProgress(void) {
 
   lprintf(LO_INFO, "  %lld / %lld sequences tested (%d%%) in %.2f seconds!\n",
           bf_volume, bf_volume_max, percent, (float) elapsed_time / 1000);
+
+  if (bf_cache_enabled)
+    lprintf(LO_INFO, "  %lld cache hits, %lld sequences pruned (%d%%)\n",
+            bf_cache_hits, bf_cache_pruned, (int) (100 * bf_cache_pruned / bf_volume_max));
+}
+
+static inline void dsda_BFHashInt(unsigned long long* hash, int value) {
+  *hash = (*hash ^ (unsigned int) value) * 0x100000001b3ull;
+  *hash ^= *hash >> 29;
+}
+
+static int dsda_BFMobjIndex(mobj_t* mo) {
+  // P_ThinkerToIndex stores the position in the thinker list in prev
+  return mo ? (int) (intptr_t) mo->thinker.prev : 0;
+}
+
+static int dsda_BFSectorIndex(sector_t* sector) {
+  return sector ? sector - sectors : -1;
+}
+
+// Returns false for thinkers whose state is not covered here
+static dboolean dsda_BFHashThinker(unsigned long long* hash, thinker_t* th) {
+  if (th->function == T_MoveFloor) {
+    floormove_t* floor = (floormove_t*) th;
+
+    dsda_BFHashInt(hash, dsda_BFSectorIndex(floor->sector));
+    dsda_BFHashInt(hash, floor->type);
+    dsda_BFHashInt(hash, floor->crush);
+    dsda_BFHashInt(hash, floor->direction);
+    dsda_BFHashInt(hash, floor->newspecial.special);
+    dsda_BFHashInt(hash, floor->texture);
+    dsda_BFHashInt(hash, floor->floordestheight);
+    dsda_BFHashInt(hash, floor->speed);
+    dsda_BFHashInt(hash, floor->delayCount);
+    dsda_BFHashInt(hash, floor->resetDelayCount);
+  }
+  else if (th->function == T_MoveCeiling) {
+    ceiling_t* ceiling = (ceiling_t*) th;
+
+    dsda_BFHashInt(hash, dsda_BFSectorIndex(ceiling->sector));
+    dsda_BFHashInt(hash, ceiling->type);
+    dsda_BFHashInt(hash, ceiling->bottomheight);
+    dsda_BFHashInt(hash, ceiling->topheight);
+    dsda_BFHashInt(hash, ceiling->speed);
+    dsda_BFHashInt(hash, ceiling->oldspeed);
+    dsda_BFHashInt(hash, ceiling->crush);
+    dsda_BFHashInt(hash, ceiling->newspecial.special);
+    dsda_BFHashInt(hash, ceiling->texture);
+    dsda_BFHashInt(hash, ceiling->direction);
+    dsda_BFHashInt(hash, ceiling->olddirection);
+  }
+  else if (th->function == T_VerticalDoor) {
+    vldoor_t* door = (vldoor_t*) th;
+
+    dsda_BFHashInt(hash, dsda_BFSectorIndex(door->sector));
+    dsda_BFHashInt(hash, door->type);
+    dsda_BFHashInt(hash, door->topheight);
+    dsda_BFHashInt(hash, door->speed);
+    dsda_BFHashInt(hash, door->direction);
+    dsda_BFHashInt(hash, door->topwait);
+    dsda_BFHashInt(hash, door->topcountdown);
+  }
+  else if (th->function == T_PlatRaise) {
+    plat_t* plat = (plat_t*) th;
+
+    dsda_BFHashInt(hash, dsda_BFSectorIndex(plat->sector));
+    dsda_BFHashInt(hash, plat->type);
+    dsda_BFHashInt(hash, plat->speed);
+    dsda_BFHashInt(hash, plat->low);
+    dsda_BFHashInt(hash, plat->high);
+    dsda_BFHashInt(hash, plat->wait);
+    dsda_BFHashInt(hash, plat->count);
+    dsda_BFHashInt(hash, plat->status);
+    dsda_BFHashInt(hash, plat->oldstatus);
+    dsda_BFHashInt(hash, plat->crush);
+  }
+  else if (th->function == T_MoveElevator) {
+    elevator_t* elevator = (elevator_t*) th;
+
+    dsda_BFHashInt(hash, dsda_BFSectorIndex(elevator->sector));
+    dsda_BFHashInt(hash, elevator->type);
+    dsda_BFHashInt(hash, elevator->direction);
+    dsda_BFHashInt(hash, elevator->floordestheight);
+    dsda_BFHashInt(hash, elevator->ceilingdestheight);
+    dsda_BFHashInt(hash, elevator->speed);
+  }
+  else if (th->function == T_FireFlicker) {
+    fireflicker_t* flick = (fireflicker_t*) th;
+
+    dsda_BFHashInt(hash, dsda_BFSectorIndex(flick->sector));
+    dsda_BFHashInt(hash, flick->count);
+  }
+  else if (th->function == T_LightFlash) {
+    lightflash_t* flash = (lightflash_t*) th;
+
+    dsda_BFHashInt(hash, dsda_BFSectorIndex(flash->sector));
+    dsda_BFHashInt(hash, flash->count);
+  }
+  else if (th->function == T_StrobeFlash) {
+    strobe_t* flash = (strobe_t*) th;
+
+    dsda_BFHashInt(hash, dsda_BFSectorIndex(flash->sector));
+    dsda_BFHashInt(hash, flash->count);
+  }
+  else if (th->function == T_Glow) {
+    glow_t* glow = (glow_t*) th;
+
+    dsda_BFHashInt(hash, dsda_BFSectorIndex(glow->sector));
+    dsda_BFHashInt(hash, glow->direction);
+  }
+  else if (
+    th->function == dsda_UpdateControlSideScroller ||
+    th->function == dsda_UpdateControlFloorScroller ||
+    th->function == dsda_UpdateControlCeilingScroller ||
+    th->function == dsda_UpdateControlFloorCarryScroller
+  ) {
+    control_scroll_t* scroll = (control_scroll_t*) th;
+
+    dsda_BFHashInt(hash, scroll->last_height);
+    dsda_BFHashInt(hash, scroll->vdx);
+    dsda_BFHashInt(hash, scroll->vdy);
+  }
+  else if (
+    // These never change after the level is loaded
+    th->function != dsda_UpdateSideScroller &&
+    th->function != dsda_UpdateFloorScroller &&
+    th->function != dsda_UpdateCeilingScroller &&
+    th->function != dsda_UpdateFloorCarryScroller &&
+    th->function != T_Friction &&
+    th->function != T_Pusher
+  )
+    return false;
+
+  return true;
+}
+
+// Everything the remaining tics or the conditions can depend on.
+// Two states with the same hash are treated as the same node, so a collision
+//   can only prune a branch that should have been tested; any sequence that
+//   is reported as a success was actually played, so the demo is unaffected.
+// A thinker whose state is not hashed makes the key unique to this visit.
+static unsigned long long dsda_BFStateHash(void) {
+  static unsigned int unique_key;
+  unsigned long long hash = 0xcbf29ce484222325ull;
+  thinker_t* th;
+  int i;
+
+  P_ThinkerToIndex();
+
+  dsda_BFHashInt(&hash, rng.rndindex);
+  dsda_BFHashInt(&hash, rng.prndindex);
+  for (i = 0; i < NUMPRCLASS; ++i)
+    dsda_BFHashInt(&hash, rng.seed[i]);
+
+  for (i = 0; i < g_maxplayers; ++i) {
+    player_t* player;
+    int j;
+
+    if (!playeringame[i])
+      continue;
+
+    player = &players[i];
+
+    dsda_BFHashInt(&hash, dsda_BFMobjIndex(player->mo));
+    dsda_BFHashInt(&hash, player->playerstate);
+    dsda_BFHashInt(&hash, player->health);
+    dsda_BFHashInt(&hash, player->armorpoints[ARMOR_ARMOR]);
+    dsda_BFHashInt(&hash, player->armortype);
+    dsda_BFHashInt(&hash, player->readyweapon);
+    dsda_BFHashInt(&hash, player->pendingweapon);
+    dsda_BFHashInt(&hash, player->viewz);
+    dsda_BFHashInt(&hash, player->deltaviewheight);
+    dsda_BFHashInt(&hash, player->bob);
+    dsda_BFHashInt(&hash, player->attackdown);
+    dsda_BFHashInt(&hash, player->usedown);
+    dsda_BFHashInt(&hash, player->refire);
+    dsda_BFHashInt(&hash, player->damagecount);
+    dsda_BFHashInt(&hash, player->bonuscount);
+    dsda_BFHashInt(&hash, dsda_BFMobjIndex(player->attacker));
+
+    for (j = 0; j < NUMPOWERS; ++j)
+      dsda_BFHashInt(&hash, player->powers[j]);
+
+    for (j = 0; j < NUMAMMO; ++j)
+      dsda_BFHashInt(&hash, player->ammo[j]);
+
+    for (j = 0; j < NUMCARDS; ++j)
+      dsda_BFHashInt(&hash, player->cards[j]);
+
+    for (j = 0; j < NUMWEAPONS; ++j)
+      dsda_BFHashInt(&hash, player->weaponowned[j]);
+
+    for (j = 0; j < NUMPSPRITES; ++j) {
+      dsda_BFHashInt(&hash, player->psprites[j].state ? player->psprites[j].state - states : -1);
+      dsda_BFHashInt(&hash, player->psprites[j].tics);
+      dsda_BFHashInt(&hash, player->psprites[j].sx);
+      dsda_BFHashInt(&hash, player->psprites[j].sy);
+    }
+  }
+
+  for (th = thinkercap.next; th != &thinkercap; th = th->next) {
+    mobj_t* mo;
+
+    if (th->function != P_MobjThinker && th->function != P_BlasterMobjThinker) {
+      if (th->function != P_RemoveThinkerDelayed && !dsda_BFHashThinker(&hash, th))
+        dsda_BFHashInt(&hash, ++unique_key);
+
+      continue;
+    }
+
+    mo = (mobj_t*) th;
+
+    dsda_BFHashInt(&hash, mo->type);
+    dsda_BFHashInt(&hash, mo->x);
+    dsda_BFHashInt(&hash, mo->y);
+    dsda_BFHashInt(&hash, mo->z);
+    dsda_BFHashInt(&hash, mo->momx);
+    dsda_BFHashInt(&hash, mo->momy);
+    dsda_BFHashInt(&hash, mo->momz);
+    dsda_BFHashInt(&hash, mo->angle);
+    dsda_BFHashInt(&hash, mo->health);
+    dsda_BFHashInt(&hash, mo->flags);
+    dsda_BFHashInt(&hash, mo->state ? mo->state - states : -1);
+    dsda_BFHashInt(&hash, mo->tics);
+    dsda_BFHashInt(&hash, mo->movedir);
+    dsda_BFHashInt(&hash, mo->movecount);
+    dsda_BFHashInt(&hash, mo->reactiontime);
+    dsda_BFHashInt(&hash, mo->threshold);
+    dsda_BFHashInt(&hash, dsda_BFMobjIndex(mo->target));
+    dsda_BFHashInt(&hash, dsda_BFMobjIndex(mo->tracer));
+    dsda_BFHashInt(&hash, dsda_BFMobjIndex(mo->lastenemy));
+  }
+
+  P_IndexToThinker();
+
+  for (i = 0; i < numsectors; ++i) {
+    dsda_BFHashInt(&hash, sectors[i].floorheight);
+    dsda_BFHashInt(&hash, sectors[i].ceilingheight);
+    dsda_BFHashInt(&hash, sectors[i].lightlevel);
+    dsda_BFHashInt(&hash, sectors[i].special);
+  }
+
+  for (i = 0; i < bf_condition_count; ++i)
+    if (
+      bf_condition[i].operator == dsda_bf_operator_misc &&
+      (
+        bf_condition[i].attribute == dsda_bf_line_skip ||
+        bf_condition[i].attribute == dsda_bf_line_activation
+      )
+    )
+      dsda_BFHashInt(&hash, lines[bf_condition[i].value].player_activations);
+
+  // 0 marks an empty slot
+  return hash ? hash : 1;
+}
+
+static void dsda_ClearBFCache(void) {
+  int i;
+
+  for (i = 0; i < MAX_BF_DEPTH; ++i) {
+    Z_Free(bf_cache[i].keys);
+    bf_cache[i].keys = NULL;
+    bf_cache[i].size = 0;
+    bf_cache[i].count = 0;
+  }
+}
+
+static unsigned long long* dsda_BFCacheSlot(bf_cache_t* cache, unsigned long long key) {
+  int i;
+
+  i = (int) (key & (cache->size - 1));
+  while (cache->keys[i] && cache->keys[i] != key)
+    i = (i + 1) & (cache->size - 1);
+
+  return &cache->keys[i];
+}
+
+static void dsda_GrowBFCache(bf_cache_t* cache) {
+  unsigned long long* old_keys;
+  int old_size;
+  int i;
+
+  old_keys = cache->keys;
+  old_size = cache->size;
+
+  cache->size = old_size ? old_size * 2 : 1024;
+  cache->keys = Z_Calloc(cache->size, sizeof(*cache->keys));
+
+  for (i = 0; i < old_size; ++i)
+    if (old_keys[i])
+      *dsda_BFCacheSlot(cache, old_keys[i]) = old_keys[i];
+
+  Z_Free(old_keys);
+}
+
+// Returns true if the state was already reached at this depth
+static dboolean dsda_CheckBFCache(int frame) {
+  bf_cache_t* cache;
+  unsigned long long key;
+  unsigned long long* slot;
+
+  cache = &bf_cache[frame];
+  key = dsda_BFStateHash();
+
+  // Stop recording once full, but keep answering lookups
+  if (cache->count * 2 >= cache->size) {
+    if (cache->size < MAX_BF_CACHE_SIZE)
+      dsda_GrowBFCache(cache);
+    else if (cache->count * 4 >= cache->size * 3) {
+      slot = dsda_BFCacheSlot(cache, key);
+
+      return *slot != 0;
+    }
+  }
+
+  slot = dsda_BFCacheSlot(cache, key);
+
+  if (*slot)
+    return true;
+
+  *slot = key;
+  ++cache->count;
+
+  return false;
 }
 
 #define BF_FAILURE 0
@@ -253,6 +598,8 @@ static void dsda_EndBF(int result) {
 
   bf_mode = false;
 
+  dsda_ClearBFCache();
+
   if (result == BF_SUCCESS)
     dsda_QueueBuildCommands(bf_result, bf_depth);
   else
@@ -599,6 +946,14 @@ void dsda_BruteForceWithMonsters(void) {
   bf_nomonsters = false;
 }
 
+void dsda_BruteForceWithCache(void) {
+  bf_cache_enabled = true;
+}
+
+void dsda_BruteForceWithoutCache(void) {
+  bf_cache_enabled = false;
+}
+
 dboolean dsda_StartBruteForce(int depth) {
   int i;
 
@@ -618,6 +973,9 @@ dboolean dsda_StartBruteForce(int depth) {
   bf_logictic = true_logictic;
   bf_volume = 0;
   bf_volume_max = 1;
+  bf_progress_volume = 10000;
+  bf_cache_hits = 0;
+  bf_cache_pruned = 0;
 
   for (i = 0; i < bf_depth; ++i) {
     lprintf(LO_INFO, "  %d: F %d:%d S %d:%d T %d:%d B %d\n", i,
@@ -635,8 +993,20 @@ dboolean dsda_StartBruteForce(int depth) {
     brute_force[i].angleturn.i = brute_force[i].angleturn.min;
   }
 
+  bf_subtree_volume[bf_depth] = 1;
+  for (i = bf_depth - 1; i >= 0; --i)
+    bf_subtree_volume[i] = bf_subtree_volume[i + 1] *
+                           (brute_force[i].forwardmove.max - brute_force[i].forwardmove.min + 1) *
+                           (brute_force[i].sidemove.max - brute_force[i].sidemove.min + 1) *
+                           (brute_force[i].angleturn.max - brute_force[i].angleturn.min + 1);
+
+  dsda_ClearBFCache();
+
   lprintf(LO_INFO, "Testing %lld sequences with depth %d\n\n", bf_volume_max, bf_depth);
 
+  if (bf_cache_enabled)
+    lprintf(LO_INFO, "Skipping sequences that repeat an explored state\n\n");
+
   bf_mode = true;
 
   if (bf_nomonsters) {
@@ -652,20 +1022,49 @@ dboolean dsda_StartBruteForce(int depth) {
   return true;
 }
 
+static void dsda_EndExhaustedBF(void) {
+  if (bf_target.enabled && bf_target.evaluated)
+    dsda_EndBF(BF_SUCCESS);
+  else
+    dsda_EndBF(BF_FAILURE);
+}
+
+// Every continuation of this state was tested from the earlier prefix
+static void dsda_PruneBruteForce(int frame) {
+  int i;
+
+  ++bf_cache_hits;
+  bf_cache_pruned += bf_subtree_volume[frame];
+  bf_volume += bf_subtree_volume[frame];
+
+  for (i = frame - 1; i >= 0; --i)
+    if (dsda_AdvanceBruteForceFrame(i))
+      break;
+
+  if (i >= 0)
+    dsda_RestoreBFKeyFrame(i);
+  else
+    dsda_EndExhaustedBF();
+}
+
 void dsda_UpdateBruteForce(void) {
   int frame;
 
   frame = true_logictic - bf_logictic;
 
   if (frame == bf_depth) {
-    if (bf_volume % 10000 == 0)
+    if (bf_volume >= bf_progress_volume) {
       dsda_PrintBFProgress();
+      bf_progress_volume = bf_volume - bf_volume % 10000 + 10000;
+    }
 
     frame = dsda_AdvanceBruteForce();
 
     if (frame >= 0)
       dsda_RestoreBFKeyFrame(frame);
   }
+  else if (bf_cache_enabled && frame > 0 && dsda_CheckBFCache(frame))
+    dsda_PruneBruteForce(frame);
   else
     dsda_StoreBFKeyFrame(frame);
 }
@@ -680,12 +1079,8 @@ void dsda_EvaluateBruteForce(void) {
     dsda_CopyBFResult(brute_force, bf_depth);
     dsda_EndBF(BF_SUCCESS);
   }
-  else if (bf_volume >= bf_volume_max) {
-    if (bf_target.enabled && bf_target.evaluated)
-      dsda_EndBF(BF_SUCCESS);
-    else
-      dsda_EndBF(BF_FAILURE);
-  }
+  else if (bf_volume >= bf_volume_max)
+    dsda_EndExhaustedBF();
 }
 
 void dsda_CopyBruteForceCommand(ticcmd_t* cmd) {
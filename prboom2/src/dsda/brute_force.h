@@ -110,6 +110,8 @@ int dsda_AddBruteForceFrame(int i,
                             byte buttons);
 void dsda_BruteForceWithoutMonsters(void);
 void dsda_BruteForceWithMonsters(void);
+void dsda_BruteForceWithCache(void);
+void dsda_BruteForceWithoutCache(void);
 void dsda_UpdateBruteForce(void);
 void dsda_EvaluateBruteForce(void);
 void dsda_CopyBruteForceCommand(ticcmd_t* cmd);
@@ -0,0 +1,500 @@
+//
+// Copyright(C) 2023 by Ryan Krafnick
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	DSDA Capture Pipeline
+//
+//  Software mode video capture. The game thread copies the 8-bit screen
+//    and palette into a ring slot; a worker pool scales and converts
+//    slots to RGB24 or YUV420 in parallel, and a writer thread feeds
+//    finished frames to the encoder in order.
+//
+
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "lprintf.h"
+#include "z_zone.h"
+
+#include "dsda/configuration.h"
+
+#include "capture_pipeline.h"
+
+#define CAPTURE_MAX_THREADS 16
+
+typedef enum {
+  capture_slot_free,
+  capture_slot_pending,
+  capture_slot_converting,
+  capture_slot_done,
+} capture_slot_state_t;
+
+typedef struct {
+  capture_slot_state_t state;
+  byte* screen;
+  SDL_Color palette[256];
+  byte* frame;
+
+  // Conversion tables, rebuilt when the palette changes
+  SDL_Color table_palette[256];
+  dboolean table_valid;
+  unsigned int rgb[256];
+  byte y[256];
+  byte u[256];
+  byte v[256];
+
+  byte* rows;
+  byte* chroma;
+} capture_slot_t;
+
+static dboolean pipeline_active;
+static dboolean frame_yuv;
+static int source_width;
+static int source_height;
+static int frame_width;
+static int frame_height;
+static size_t frame_size;
+static int* x_source;
+static int* y_source;
+
+static FILE* pipeline_output;
+static capture_slot_t* slots;
+static int slot_count;
+static int next_fill;
+static int next_convert;
+static int next_write;
+static dboolean pipeline_done;
+static int write_errors;
+
+static SDL_Thread* worker_threads[CAPTURE_MAX_THREADS];
+static int worker_count;
+static SDL_Thread* writer_thread;
+static SDL_mutex* pipeline_mutex;
+static SDL_cond* pipeline_cond;
+
+void dsda_InitCapturePipeline(int width, int height) {
+  int scale;
+  int i;
+
+  scale = dsda_IntConfig(dsda_config_cap_scale);
+  frame_yuv = dsda_IntConfig(dsda_config_cap_yuv420);
+
+  source_width = width;
+  source_height = height;
+  frame_width = width * scale;
+  frame_height = height * scale;
+
+  // Same correction the window applies to the canonical modes
+  if (dsda_IntConfig(dsda_config_cap_aspect) && (height == 200 || height == 400))
+    frame_height = frame_height * 6 / 5;
+
+  // 4:2:0 chroma covers 2x2 blocks
+  if (frame_yuv) {
+    frame_width += frame_width & 1;
+    frame_height += frame_height & 1;
+    frame_size = frame_width * frame_height + 2 * (frame_width / 2) * (frame_height / 2);
+  }
+  else
+    frame_size = frame_width * frame_height * 3;
+
+  Z_Free(x_source);
+  x_source = NULL;
+
+  if (frame_width != source_width) {
+    x_source = Z_Malloc(frame_width * sizeof(*x_source));
+
+    for (i = 0; i < frame_width; ++i)
+      x_source[i] = i * source_width / frame_width;
+  }
+
+  y_source = Z_Realloc(y_source, frame_height * sizeof(*y_source));
+
+  for (i = 0; i < frame_height; ++i)
+    y_source[i] = i * source_height / frame_height;
+
+  pipeline_active = true;
+}
+
+dboolean dsda_CapturePipelineActive(void) {
+  return pipeline_active;
+}
+
+int dsda_CapturePipelineWidth(void) {
+  return frame_width;
+}
+
+int dsda_CapturePipelineHeight(void) {
+  return frame_height;
+}
+
+const char* dsda_CapturePixelFormat(void) {
+  return pipeline_active && frame_yuv ? "yuv420p" : "rgb24";
+}
+
+static void dsda_UpdateCaptureTables(capture_slot_t* slot) {
+  int i;
+
+  if (slot->table_valid && !memcmp(slot->table_palette, slot->palette, sizeof(slot->palette)))
+    return;
+
+  for (i = 0; i < 256; ++i) {
+    int r, g, b;
+    byte* entry;
+
+    r = slot->palette[i].r;
+    g = slot->palette[i].g;
+    b = slot->palette[i].b;
+
+    // r, g, b in memory order plus a pad byte
+    entry = (byte*) &slot->rgb[i];
+    entry[0] = r;
+    entry[1] = g;
+    entry[2] = b;
+    entry[3] = 0;
+
+    // BT.601 limited range, biased to keep the shifts non-negative
+    slot->y[i] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+    slot->u[i] = (-38 * r - 74 * g + 112 * b + 128 + (128 << 8)) >> 8;
+    slot->v[i] = (112 * r - 94 * g - 18 * b + 128 + (128 << 8)) >> 8;
+  }
+
+  memcpy(slot->table_palette, slot->palette, sizeof(slot->palette));
+  slot->table_valid = true;
+}
+
+static const byte* dsda_ScaleCaptureRow(const capture_slot_t* slot, int y, byte* dest) {
+  const byte* source;
+  int x;
+
+  source = slot->screen + y_source[y] * source_width;
+
+  if (!x_source)
+    return source;
+
+  for (x = 0; x < frame_width; ++x)
+    dest[x] = source[x_source[x]];
+
+  return dest;
+}
+
+static void dsda_LookupCaptureRow(const byte* table, const byte* source, byte* dest) {
+  int x;
+
+  for (x = 0; x < frame_width; ++x)
+    dest[x] = table[source[x]];
+}
+
+// Writes 4 bytes per pixel and advances 3; the frame has a byte of slack
+static void dsda_ExpandCaptureRow(const unsigned int* rgb, const byte* source, byte* dest) {
+  const byte* end;
+
+  end = source + (frame_width & ~3);
+
+  for (; source < end; source += 4, dest += 12) {
+    memcpy(dest,     &rgb[source[0]], 4);
+    memcpy(dest + 3, &rgb[source[1]], 4);
+    memcpy(dest + 6, &rgb[source[2]], 4);
+    memcpy(dest + 9, &rgb[source[3]], 4);
+  }
+
+  for (end += frame_width & 3; source < end; ++source, dest += 3)
+    memcpy(dest, &rgb[*source], 4);
+}
+
+#ifdef __SSE2__
+// Sums of horizontal pairs from both rows, rounded: 8 results from 16 columns
+static inline __m128i dsda_AverageQuads(const byte* a, const byte* b) {
+  const __m128i mask = _mm_set1_epi16(0x00ff);
+  __m128i va, vb, sum;
+
+  va = _mm_loadu_si128((const __m128i*) a);
+  vb = _mm_loadu_si128((const __m128i*) b);
+
+  sum = _mm_add_epi16(_mm_and_si128(va, mask), _mm_srli_epi16(va, 8));
+  sum = _mm_add_epi16(sum, _mm_and_si128(vb, mask));
+  sum = _mm_add_epi16(sum, _mm_srli_epi16(vb, 8));
+
+  return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+}
+#endif
+
+// Averages each 2x2 block of two full width chroma rows
+static void dsda_SubsampleChroma(const byte* a, const byte* b, byte* dest, int width) {
+  int i = 0;
+
+#ifdef __SSE2__
+  for (; i + 16 <= width; i += 16) {
+    __m128i lo, hi;
+
+    lo = dsda_AverageQuads(a + 2 * i, b + 2 * i);
+    hi = dsda_AverageQuads(a + 2 * i + 16, b + 2 * i + 16);
+
+    _mm_storeu_si128((__m128i*) (dest + i), _mm_packus_epi16(lo, hi));
+  }
+#endif
+
+  for (; i < width; ++i)
+    dest[i] = (a[2 * i] + a[2 * i + 1] + b[2 * i] + b[2 * i + 1] + 2) >> 2;
+}
+
+static void dsda_ConvertCaptureFrame(capture_slot_t* slot) {
+  int y;
+
+  dsda_UpdateCaptureTables(slot);
+
+  if (frame_yuv) {
+    byte* y_plane;
+    byte* u_plane;
+    byte* v_plane;
+    byte* u_top;
+    byte* u_bottom;
+    byte* v_top;
+    byte* v_bottom;
+    int chroma_width;
+
+    chroma_width = frame_width / 2;
+    y_plane = slot->frame;
+    u_plane = y_plane + frame_width * frame_height;
+    v_plane = u_plane + chroma_width * (frame_height / 2);
+
+    u_top = slot->chroma;
+    u_bottom = u_top + frame_width;
+    v_top = u_bottom + frame_width;
+    v_bottom = v_top + frame_width;
+
+    for (y = 0; y < frame_height; y += 2) {
+      const byte* top;
+      const byte* bottom;
+
+      top = dsda_ScaleCaptureRow(slot, y, slot->rows);
+      bottom = dsda_ScaleCaptureRow(slot, y + 1, slot->rows + frame_width);
+
+      dsda_LookupCaptureRow(slot->y, top, y_plane + y * frame_width);
+      dsda_LookupCaptureRow(slot->y, bottom, y_plane + (y + 1) * frame_width);
+
+      dsda_LookupCaptureRow(slot->u, top, u_top);
+      dsda_LookupCaptureRow(slot->u, bottom, u_bottom);
+      dsda_LookupCaptureRow(slot->v, top, v_top);
+      dsda_LookupCaptureRow(slot->v, bottom, v_bottom);
+
+      dsda_SubsampleChroma(u_top, u_bottom, u_plane + (y / 2) * chroma_width, chroma_width);
+      dsda_SubsampleChroma(v_top, v_bottom, v_plane + (y / 2) * chroma_width, chroma_width);
+    }
+  }
+  else {
+    for (y = 0; y < frame_height; ++y)
+      dsda_ExpandCaptureRow(slot->rgb, dsda_ScaleCaptureRow(slot, y, slot->rows),
+                            slot->frame + y * frame_width * 3);
+  }
+}
+
+static int dsda_CaptureWorker(void* data) {
+  while (true) {
+    capture_slot_t* slot;
+
+    SDL_LockMutex(pipeline_mutex);
+
+    while (slots[next_convert].state != capture_slot_pending && !pipeline_done)
+      SDL_CondWait(pipeline_cond, pipeline_mutex);
+
+    // Pending slots are contiguous, so none are left
+    if (slots[next_convert].state != capture_slot_pending) {
+      SDL_UnlockMutex(pipeline_mutex);
+      return 0;
+    }
+
+    slot = &slots[next_convert];
+    slot->state = capture_slot_converting;
+    next_convert = (next_convert + 1) % slot_count;
+
+    SDL_UnlockMutex(pipeline_mutex);
+
+    dsda_ConvertCaptureFrame(slot);
+
+    SDL_LockMutex(pipeline_mutex);
+    slot->state = capture_slot_done;
+    SDL_CondBroadcast(pipeline_cond);
+    SDL_UnlockMutex(pipeline_mutex);
+  }
+}
+
+static int dsda_CaptureWriter(void* data) {
+  while (true) {
+    capture_slot_t* slot;
+    dboolean drained;
+
+    slot = &slots[next_write];
+
+    SDL_LockMutex(pipeline_mutex);
+
+    while (slot->state != capture_slot_done &&
+           !(pipeline_done && slot->state == capture_slot_free))
+      SDL_CondWait(pipeline_cond, pipeline_mutex);
+
+    // The oldest slot is free only once the ring has drained
+    drained = (slot->state == capture_slot_free);
+
+    SDL_UnlockMutex(pipeline_mutex);
+
+    if (drained)
+      return 0;
+
+    if (fwrite(slot->frame, frame_size, 1, pipeline_output) != 1)
+      ++write_errors;
+
+    SDL_LockMutex(pipeline_mutex);
+    slot->state = capture_slot_free;
+    next_write = (next_write + 1) % slot_count;
+    SDL_CondBroadcast(pipeline_cond);
+    SDL_UnlockMutex(pipeline_mutex);
+  }
+}
+
+// Joins whatever threads started and frees the ring
+static void dsda_StopCapturePipeline(void) {
+  int i;
+
+  if (pipeline_mutex && pipeline_cond) {
+    SDL_LockMutex(pipeline_mutex);
+    pipeline_done = true;
+    SDL_CondBroadcast(pipeline_cond);
+    SDL_UnlockMutex(pipeline_mutex);
+  }
+
+  for (i = 0; i < worker_count; ++i)
+    SDL_WaitThread(worker_threads[i], NULL);
+  worker_count = 0;
+
+  if (writer_thread)
+    SDL_WaitThread(writer_thread, NULL);
+  writer_thread = NULL;
+
+  if (pipeline_cond)
+    SDL_DestroyCond(pipeline_cond);
+  if (pipeline_mutex)
+    SDL_DestroyMutex(pipeline_mutex);
+  pipeline_cond = NULL;
+  pipeline_mutex = NULL;
+
+  for (i = 0; i < slot_count; ++i) {
+    Z_Free(slots[i].screen);
+    Z_Free(slots[i].frame);
+    Z_Free(slots[i].rows);
+    Z_Free(slots[i].chroma);
+  }
+
+  Z_Free(slots);
+  slots = NULL;
+
+  pipeline_output = NULL;
+  pipeline_active = false;
+}
+
+// Runs before the encoder command is built, so that a pipeline that
+//   can't start falls back to the plain rgb24 capture in its place
+void dsda_StartCapturePipeline(void) {
+  int requested;
+  int i;
+
+  requested = dsda_IntConfig(dsda_config_cap_threads);
+  requested = BETWEEN(1, CAPTURE_MAX_THREADS, requested);
+
+  slot_count = requested + 2;
+  slots = Z_Calloc(slot_count, sizeof(*slots));
+
+  for (i = 0; i < slot_count; ++i) {
+    slots[i].screen = Z_Malloc(source_width * source_height);
+    slots[i].frame = Z_Malloc(frame_size + 1);
+    slots[i].rows = Z_Malloc(2 * frame_width);
+    slots[i].chroma = Z_Malloc(4 * frame_width);
+  }
+
+  pipeline_output = NULL;
+  pipeline_done = false;
+  write_errors = 0;
+  next_fill = next_convert = next_write = 0;
+  worker_count = 0;
+  writer_thread = NULL;
+
+  pipeline_mutex = SDL_CreateMutex();
+  pipeline_cond = SDL_CreateCond();
+
+  if (pipeline_mutex && pipeline_cond) {
+    for (i = 0; i < requested; ++i) {
+      worker_threads[worker_count] = SDL_CreateThread(dsda_CaptureWorker, "dsda_CaptureWorker", NULL);
+      if (worker_threads[worker_count])
+        ++worker_count;
+    }
+
+    if (worker_count)
+      writer_thread = SDL_CreateThread(dsda_CaptureWriter, "dsda_CaptureWriter", NULL);
+  }
+
+  if (!worker_count || !writer_thread) {
+    lprintf(LO_WARN, "dsda_StartCapturePipeline: %s, capturing on the game thread\n", SDL_GetError());
+    dsda_StopCapturePipeline();
+    return;
+  }
+
+  lprintf(LO_INFO, "dsda_StartCapturePipeline: %dx%d %s on %d threads\n",
+          frame_width, frame_height, dsda_CapturePixelFormat(), worker_count);
+}
+
+void dsda_SetCapturePipelineOutput(FILE* output) {
+  if (pipeline_active)
+    pipeline_output = output;
+}
+
+void dsda_QueueCaptureFrame(const byte* screen, int pitch, const SDL_Color* palette) {
+  capture_slot_t* slot;
+  int y;
+
+  if (!pipeline_output)
+    return;
+
+  slot = &slots[next_fill];
+
+  SDL_LockMutex(pipeline_mutex);
+
+  while (slot->state != capture_slot_free)
+    SDL_CondWait(pipeline_cond, pipeline_mutex);
+
+  SDL_UnlockMutex(pipeline_mutex);
+
+  if (pitch == source_width)
+    memcpy(slot->screen, screen, source_width * source_height);
+  else
+    for (y = 0; y < source_height; ++y)
+      memcpy(slot->screen + y * source_width, screen + y * pitch, source_width);
+
+  memcpy(slot->palette, palette, sizeof(slot->palette));
+
+  SDL_LockMutex(pipeline_mutex);
+  slot->state = capture_slot_pending;
+  next_fill = (next_fill + 1) % slot_count;
+  SDL_CondBroadcast(pipeline_cond);
+  SDL_UnlockMutex(pipeline_mutex);
+}
+
+void dsda_FinishCapturePipeline(void) {
+  if (!slots)
+    return;
+
+  dsda_StopCapturePipeline();
+
+  if (write_errors)
+    lprintf(LO_WARN, "dsda_FinishCapturePipeline: %d frames failed to write\n", write_errors);
+}
@@ -0,0 +1,37 @@
+//
+// Copyright(C) 2023 by Ryan Krafnick
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	DSDA Capture Pipeline
+//
+
+#ifndef __DSDA_CAPTURE_PIPELINE__
+#define __DSDA_CAPTURE_PIPELINE__
+
+#include <stdio.h>
+
+#include "SDL.h"
+
+#include "doomtype.h"
+
+void dsda_InitCapturePipeline(int width, int height);
+dboolean dsda_CapturePipelineActive(void);
+int dsda_CapturePipelineWidth(void);
+int dsda_CapturePipelineHeight(void);
+const char* dsda_CapturePixelFormat(void);
+void dsda_StartCapturePipeline(void);
+void dsda_SetCapturePipelineOutput(FILE* output);
+void dsda_QueueCaptureFrame(const byte* screen, int pitch, const SDL_Color* palette);
+void dsda_FinishCapturePipeline(void);
+
+#endif
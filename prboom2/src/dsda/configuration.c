@@ -806,6 +806,22 @@ dsda_config_t dsda_config[dsda_config_count] = {
     "cap_fps", dsda_config_cap_fps,
     dsda_config_int, 16, 300, { 60 }
   },
+  [dsda_config_cap_scale] = {
+    "cap_scale", dsda_config_cap_scale,
+    dsda_config_int, 1, 8, { 1 }
+  },
+  [dsda_config_cap_aspect] = {
+    "cap_aspect", dsda_config_cap_aspect,
+    CONF_BOOL(0)
+  },
+  [dsda_config_cap_yuv420] = {
+    "cap_yuv420", dsda_config_cap_yuv420,
+    CONF_BOOL(0)
+  },
+  [dsda_config_cap_threads] = {
+    "cap_threads", dsda_config_cap_threads,
+    dsda_config_int, 0, 16, { 0 }
+  },
   [dsda_config_hudadd_crosshair_color] = {
     "hudadd_crosshair_color", dsda_config_hudadd_crosshair_color,
     CONF_CR(3)
@@ -882,6 +898,10 @@ dsda_config_t dsda_config[dsda_config_count] = {
     "dsda_auto_key_frame_timeout", dsda_config_auto_key_frame_timeout,
     dsda_config_int, 0, 25, { 10 }, NULL, NOT_STRICT, dsda_InitKeyFrame
   },
+  [dsda_config_auto_key_frame_memory] = {
+    "dsda_auto_key_frame_memory", dsda_config_auto_key_frame_memory,
+    dsda_config_int, 0, 16384, { 0 }, NULL, NOT_STRICT, dsda_InitKeyFrame
+  },
   [dsda_config_ex_text_scale_x] = {
     "ex_text_scale_x", dsda_config_ex_text_scale_x,
     dsda_config_int, 0, 4000, { 0 }, NULL, NOT_STRICT, dsda_SetupStretchParams
@@ -1149,6 +1169,10 @@ dsda_config_t dsda_config[dsda_config_count] = {
     "render_stretchsky", dsda_config_render_stretchsky,
     CONF_BOOL(1)
   },
+  [dsda_config_patch_cache_mb] = {
+    "patch_cache_mb", dsda_config_patch_cache_mb,
+    dsda_config_int, 0, 4096, { 0 }
+  },
   [dsda_config_gl_fade_mode] = {
     "gl_fade_mode", dsda_config_gl_fade_mode,
     dsda_config_int, 0, 1, { 0 }
@@ -173,6 +173,10 @@ typedef enum {
   dsda_config_cap_remove_tempfiles,
   dsda_config_cap_wipescreen,
   dsda_config_cap_fps,
+  dsda_config_cap_scale,
+  dsda_config_cap_aspect,
+  dsda_config_cap_yuv420,
+  dsda_config_cap_threads,
   dsda_config_hudadd_crosshair_color,
   dsda_config_hudadd_crosshair_target_color,
   dsda_config_hud_displayed,
@@ -192,6 +196,7 @@ typedef enum {
   dsda_config_auto_key_frame_interval,
   dsda_config_auto_key_frame_depth,
   dsda_config_auto_key_frame_timeout,
+  dsda_config_auto_key_frame_memory,
   dsda_config_ex_text_scale_x,
   dsda_config_ex_text_ratio_y,
   dsda_config_wipe_at_full_speed,
@@ -258,6 +263,7 @@ typedef enum {
   dsda_config_render_patches_scalex,
   dsda_config_render_patches_scaley,
   dsda_config_render_stretchsky,
+  dsda_config_patch_cache_mb,
   dsda_config_boom_translucent_sprites,
   dsda_config_show_alive_monsters,
   dsda_config_left_analog_deadzone,
@@ -848,6 +848,18 @@ static dboolean console_BruteForceMonsters(const char* command, const char* args
   return true;
 }
 
+static dboolean console_BruteForceCache(const char* command, const char* args) {
+  dsda_BruteForceWithCache();
+
+  return true;
+}
+
+static dboolean console_BruteForceNoCache(const char* command, const char* args) {
+  dsda_BruteForceWithoutCache();
+
+  return true;
+}
+
 static dboolean console_BruteForceFrame(const char* command, const char* args) {
   int frame;
   int forwardmove_min, forwardmove_max;
@@ -2410,6 +2422,10 @@ static console_command_entry_t console_commands[] = {
   { "bf.nomo", console_BruteForceNoMonsters, CF_DEMO },
   { "brute_force.monsters", console_BruteForceMonsters, CF_DEMO },
   { "bf.mo", console_BruteForceMonsters, CF_DEMO },
+  { "brute_force.cache", console_BruteForceCache, CF_DEMO },
+  { "bf.cache", console_BruteForceCache, CF_DEMO },
+  { "brute_force.nocache", console_BruteForceNoCache, CF_DEMO },
+  { "bf.nocache", console_BruteForceNoCache, CF_DEMO },
   { "build.turbo", console_BuildTurbo, CF_DEMO },
   { "b.turbo", console_BuildTurbo, CF_DEMO },
   { "mf", console_BuildMF, CF_DEMO },
@@ -15,6 +15,10 @@
 //	DSDA Dehacked Hash
 //
 
+#include <ctype.h>
+#include <string.h>
+
+#include "doomtype.h"
 #include "z_zone.h"
 
 #include "deh_hash.h"
@@ -59,3 +63,59 @@ int dsda_GetDehIndex(int index, deh_index_hash_t* hash) {
 
   return entry->index_out;
 }
+
+static unsigned int dsda_DehStringHash(const char* key) {
+  unsigned int hash = 2166136261u;
+
+  for (; *key; ++key) {
+    hash ^= (unsigned char) tolower((unsigned char) *key);
+    hash *= 16777619u;
+  }
+
+  return hash % DEH_STRING_HASH_SIZE;
+}
+
+// Links are stored one-based so that a zeroed hash is empty
+void dsda_AddDehString(deh_string_hash_t* hash, const char* key, int value) {
+  int* link;
+
+  if (hash->count == hash->size) {
+    hash->size = hash->size ? hash->size * 2 : 256;
+    hash->entries = Z_Realloc(hash->entries, hash->size * sizeof(*hash->entries));
+  }
+
+  hash->entries[hash->count].key = key;
+  hash->entries[hash->count].value = value;
+  hash->entries[hash->count].next = 0;
+
+  link = &hash->table[dsda_DehStringHash(key)];
+  while (*link)
+    link = &hash->entries[*link - 1].next;
+
+  *link = ++hash->count;
+}
+
+static const deh_string_entry_t* dsda_MatchDehString(const deh_string_hash_t* hash,
+                                                     int link, const char* key) {
+  while (link) {
+    const deh_string_entry_t* entry;
+
+    entry = &hash->entries[link - 1];
+
+    if (!strcasecmp(entry->key, key))
+      return entry;
+
+    link = entry->next;
+  }
+
+  return NULL;
+}
+
+const deh_string_entry_t* dsda_FindDehString(const deh_string_hash_t* hash, const char* key) {
+  return dsda_MatchDehString(hash, hash->table[dsda_DehStringHash(key)], key);
+}
+
+const deh_string_entry_t* dsda_NextDehString(const deh_string_hash_t* hash,
+                                             const deh_string_entry_t* entry) {
+  return dsda_MatchDehString(hash, entry->next, entry->key);
+}
@@ -33,7 +33,29 @@ typedef struct {
   int end_index;
 } deh_index_hash_t;
 
+#define DEH_STRING_HASH_SIZE 512
+
+typedef struct {
+  const char* key;
+  int value;
+  int next;
+} deh_string_entry_t;
+
+// Keys are hashed without case; entries that differ only in case share a
+//   chain in insertion order, so callers can apply their own comparison.
+typedef struct {
+  int table[DEH_STRING_HASH_SIZE];
+  deh_string_entry_t* entries;
+  int count;
+  int size;
+} deh_string_hash_t;
+
 int dsda_FindDehIndex(int index, deh_index_hash_t* hash);
 int dsda_GetDehIndex(int index, deh_index_hash_t* hash);
 
+void dsda_AddDehString(deh_string_hash_t* hash, const char* key, int value);
+const deh_string_entry_t* dsda_FindDehString(const deh_string_hash_t* hash, const char* key);
+const deh_string_entry_t* dsda_NextDehString(const deh_string_hash_t* hash,
+                                             const deh_string_entry_t* entry);
+
 #endif
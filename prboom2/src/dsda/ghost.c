@@ -48,24 +48,39 @@ typedef struct {
   int tic;
 } dsda_ghost_frame_t;
 
+// Frames of every imported file, one array per field
 typedef struct {
-  dsda_ghost_frame_t frame;
+  fixed_t* x;
+  fixed_t* y;
+  fixed_t* z;
+  angle_t* angle;
+  spritenum_t* sprite;
+  int* frame;
+  int* map;
+  int count;
+} dsda_ghost_frames_t;
+
+// The ghosts of a multiplayer file take turns reading its frames
+typedef struct {
+  int cursor;
+  int end;
+} dsda_ghost_file_t;
+
+typedef struct {
+  dsda_ghost_file_t* file;
+  int last_frame;
+  dboolean done;
   mobj_t* mobj;
-  FILE* fstream;
 } dsda_ghost_t;
 
 typedef struct {
   thinker_t* thinker;
   dsda_ghost_t* ghosts;
   int count;
+  dsda_ghost_file_t* files;
+  dsda_ghost_frames_t frames;
 } dsda_ghost_import_t;
 
-typedef struct {
-  FILE* fstream;
-  int version;
-  int count;
-} dsda_ghost_file_t;
-
 mobjinfo_t dsda_ghost_info = {
   -1,            // doomednum
   S_PLAY,        // spawnstate
@@ -112,68 +127,116 @@ void dsda_InitGhostExport(const char* name) {
   Z_Free(filename);
 }
 
-static void dsda_OpenGhostFile(const char* ghost_name, dsda_ghost_file_t* ghost_file) {
+static void dsda_GrowGhostFrames(dsda_ghost_frames_t* frames, int count) {
+  frames->x = Z_Realloc(frames->x, count * sizeof(*frames->x));
+  frames->y = Z_Realloc(frames->y, count * sizeof(*frames->y));
+  frames->z = Z_Realloc(frames->z, count * sizeof(*frames->z));
+  frames->angle = Z_Realloc(frames->angle, count * sizeof(*frames->angle));
+  frames->sprite = Z_Realloc(frames->sprite, count * sizeof(*frames->sprite));
+  frames->frame = Z_Realloc(frames->frame, count * sizeof(*frames->frame));
+  frames->map = Z_Realloc(frames->map, count * sizeof(*frames->map));
+}
+
+// Returns the number of ghosts in the file
+static int dsda_LoadGhostFile(const char* ghost_name, dsda_ghost_file_t* ghost_file) {
+  dsda_ghost_frames_t* frames;
   char* filename;
-  int read_result;
+  byte* buffer = NULL;
+  int length;
+  int offset;
+  int version;
+  int count;
+  int frame_count;
+  int i;
 
-  memset(ghost_file, 0, sizeof(dsda_ghost_file_t));
+  frames = &dsda_ghost_import.frames;
 
   filename = Z_Malloc(strlen(ghost_name) + 4 + 1);
   AddDefaultExtension(strcpy(filename, ghost_name), ".gst");
 
-  ghost_file->fstream = M_OpenFile(filename, "rb");
+  length = M_ReadFile(filename, &buffer);
 
-  if (ghost_file->fstream == NULL)
+  if (length < 0)
     I_Error("dsda_OpenGhostImport: failed to open %s", ghost_name);
 
-  read_result = fread(&ghost_file->version, sizeof(int), 1, ghost_file->fstream);
-  if (ghost_file->version < DSDA_GHOST_MIN_VERSION ||
-      ghost_file->version > DSDA_GHOST_VERSION ||
-      read_result != 1)
+  if (length >= sizeof(int))
+    memcpy(&version, buffer, sizeof(int));
+
+  if (length < sizeof(int) ||
+      version < DSDA_GHOST_MIN_VERSION ||
+      version > DSDA_GHOST_VERSION)
     I_Error("dsda_OpenGhostImport: unsupported ghost version %s", ghost_name);
 
-  if (ghost_file->version == 1)
-    ghost_file->count = 1;
+  offset = sizeof(int);
+
+  if (version == 1)
+    count = 1;
   else {
-    read_result = fread(&ghost_file->count, sizeof(int), 1, ghost_file->fstream);
-    if (read_result != 1)
+    if (length < 2 * sizeof(int))
       I_Error("dsda_OpenGhostImport: error reading ghost count %s", ghost_name);
+
+    memcpy(&count, buffer + offset, sizeof(int));
+    offset += sizeof(int);
   }
 
-  Z_Free(filename);
-}
+  // A partial frame at the end is never read
+  frame_count = (length - offset) / sizeof(dsda_ghost_frame_t);
+
+  ghost_file->cursor = frames->count;
+  ghost_file->end = frames->count + frame_count;
+
+  dsda_GrowGhostFrames(frames, ghost_file->end);
+
+  for (i = 0; i < frame_count; ++i) {
+    dsda_ghost_frame_t ghost_frame;
+    int index = frames->count + i;
+
+    memcpy(&ghost_frame, buffer + offset + i * sizeof(ghost_frame), sizeof(ghost_frame));
 
-static int dsda_GhostCount(const char* ghost_name) {
-  dsda_ghost_file_t ghost_file;
+    frames->x[index] = ghost_frame.x;
+    frames->y[index] = ghost_frame.y;
+    frames->z[index] = ghost_frame.z;
+    frames->angle[index] = ghost_frame.angle;
+    frames->sprite[index] = ghost_frame.sprite;
+    frames->frame[index] = ghost_frame.frame;
+    frames->map[index] = ghost_frame.map;
+  }
 
-  dsda_OpenGhostFile(ghost_name, &ghost_file);
+  frames->count = ghost_file->end;
 
-  fclose(ghost_file.fstream);
+  Z_Free(buffer);
+  Z_Free(filename);
 
-  return ghost_file.count;
+  return count;
 }
 
+// Ghost files are read whole at import, so playback does no file access
 void dsda_InitGhostImport(const char** ghost_names, int count) {
   int arg_i;
   int ghost_i;
   int i;
-  dsda_ghost_file_t ghost_file;
+  int* ghost_counts;
 
-  ghost_i = 0;
+  ghost_counts = Z_Malloc(count * sizeof(*ghost_counts));
+  dsda_ghost_import.files = Z_Calloc(count, sizeof(*dsda_ghost_import.files));
 
-  for (arg_i = 0; arg_i < count; ++arg_i)
-    dsda_ghost_import.count += dsda_GhostCount(ghost_names[arg_i]);
+  for (arg_i = 0; arg_i < count; ++arg_i) {
+    ghost_counts[arg_i] = dsda_LoadGhostFile(ghost_names[arg_i], &dsda_ghost_import.files[arg_i]);
+    dsda_ghost_import.count += ghost_counts[arg_i];
+  }
 
   dsda_ghost_import.ghosts = Z_Calloc(dsda_ghost_import.count, sizeof(dsda_ghost_t));
 
-  for (arg_i = 0; arg_i < count; ++arg_i) {
-    dsda_OpenGhostFile(ghost_names[arg_i], &ghost_file);
+  ghost_i = 0;
 
-    for (i = 0; i < ghost_file.count; ++i) {
-      dsda_ghost_import.ghosts[ghost_i].fstream = ghost_file.fstream;
+  for (arg_i = 0; arg_i < count; ++arg_i)
+    for (i = 0; i < ghost_counts[arg_i]; ++i) {
+      dsda_ghost_import.ghosts[ghost_i].file = &dsda_ghost_import.files[arg_i];
+      dsda_ghost_import.ghosts[ghost_i].last_frame = -1;
       ++ghost_i;
     }
-  }
+
+  Z_Free(ghost_counts);
 }
 
 void dsda_ExportGhostFrame(void) {
@@ -225,7 +288,7 @@ void dsda_SpawnGhost(void) {
     return;
 
   for (ghost_i = 0; ghost_i < dsda_ghost_import.count; ++ghost_i) {
-    if (dsda_ghost_import.ghosts[ghost_i].fstream == NULL) {
+    if (dsda_ghost_import.ghosts[ghost_i].done) {
       dsda_ghost_import.ghosts[ghost_i].mobj = NULL;
       continue;
     }
@@ -291,16 +354,19 @@ void dsda_SpawnGhost(void) {
 }
 
 void dsda_UpdateGhosts(void* _void) {
+  const dsda_ghost_frames_t* frames;
   dsda_ghost_t* ghost;
   mobj_t* mobj;
   int ghost_i;
-  int read_result;
+  int index;
   dboolean ghost_was_behind;
 
+  frames = &dsda_ghost_import.frames;
+
   for (ghost_i = 0; ghost_i < dsda_ghost_import.count; ++ghost_i) {
     ghost = &dsda_ghost_import.ghosts[ghost_i];
 
-    if (ghost->fstream == NULL) continue;
+    if (ghost->done) continue;
 
     mobj = ghost->mobj;
 
@@ -311,35 +377,38 @@ void dsda_UpdateGhosts(void* _void) {
     mobj->PrevY = mobj->y;
     mobj->PrevZ = mobj->z;
 
-    ghost_was_behind = ghost->frame.map != 0 && ghost->frame.map != gamemap;
+    ghost_was_behind = ghost->last_frame >= 0 &&
+                       frames->map[ghost->last_frame] != 0 &&
+                       frames->map[ghost->last_frame] != gamemap;
 
     // if the ghost was left behind, catch it up
     do {
-      read_result = fread(&ghost->frame, sizeof(dsda_ghost_frame_t), 1, ghost->fstream);
-
-      if (read_result != 1) {
-        fclose(ghost->fstream);
-        ghost->fstream = NULL;
+      if (ghost->file->cursor >= ghost->file->end) {
+        ghost->done = true;
         break;
       }
-    } while (ghost_was_behind && ghost->frame.map != gamemap);
 
-    if (ghost->fstream == NULL) continue;
+      ghost->last_frame = ghost->file->cursor++;
+    } while (ghost_was_behind && frames->map[ghost->last_frame] != gamemap);
+
+    if (ghost->done) continue;
 
     P_UnsetThingPosition(mobj);
 
+    index = ghost->last_frame;
+
     // Roll back one frame and leave position unset until next map
-    if (ghost->frame.map != gamemap) {
-      fseek(ghost->fstream, -(int)sizeof(dsda_ghost_frame_t), SEEK_CUR);
+    if (frames->map[index] != gamemap) {
+      --ghost->file->cursor;
       continue;
     }
 
-    mobj->x = ghost->frame.x;
-    mobj->y = ghost->frame.y;
-    mobj->z = ghost->frame.z;
-    mobj->angle = ghost->frame.angle;
-    mobj->sprite = ghost->frame.sprite;
-    mobj->frame = ghost->frame.frame;
+    mobj->x = frames->x[index];
+    mobj->y = frames->y[index];
+    mobj->z = frames->z[index];
+    mobj->angle = frames->angle[index];
+    mobj->sprite = frames->sprite[index];
+    mobj->frame = frames->frame[index];
 
     P_SetThingPosition(mobj);
   }
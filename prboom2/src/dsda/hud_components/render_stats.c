@@ -22,7 +22,7 @@
 #include "render_stats.h"
 
 typedef struct {
-  dsda_text_t component[2];
+  dsda_text_t component[4];
 } local_component_t;
 
 static local_component_t* local;
@@ -74,12 +74,48 @@ static void dsda_UpdateMaxComponentText(char* str, size_t max_size) {
   );
 }
 
+static void dsda_UpdatePoolComponentText(char* str, size_t max_size) {
+  snprintf(
+    str, max_size,
+    "%sPOOL   PLANES %s%4d %sALLOCS %s%4d",
+    dsda_TextColor(dsda_tc_exhud_render_label),
+    dsda_TextColor(dsda_tc_exhud_render_good),
+    dsda_render_stats.visplane_pool,
+    dsda_TextColor(dsda_tc_exhud_render_label),
+    dsda_render_stats.visplane_allocations ? dsda_TextColor(dsda_tc_exhud_render_bad) :
+                                             dsda_TextColor(dsda_tc_exhud_render_good),
+    dsda_render_stats.visplane_allocations
+  );
+}
+
+static void dsda_UpdateCacheComponentText(char* str, size_t max_size) {
+  snprintf(
+    str, max_size,
+    "%sCACHE KB %s%6d %sHIT %s%6d %sMISS %s%4d %sEVICT %s%4d",
+    dsda_TextColor(dsda_tc_exhud_render_label),
+    dsda_TextColor(dsda_tc_exhud_render_good),
+    dsda_render_stats.patch_cache_kb,
+    dsda_TextColor(dsda_tc_exhud_render_label),
+    dsda_TextColor(dsda_tc_exhud_render_good),
+    dsda_render_stats.patch_cache_hits,
+    dsda_TextColor(dsda_tc_exhud_render_label),
+    dsda_TextColor(dsda_tc_exhud_render_good),
+    dsda_render_stats.patch_cache_misses,
+    dsda_TextColor(dsda_tc_exhud_render_label),
+    dsda_render_stats.patch_cache_evictions ? dsda_TextColor(dsda_tc_exhud_render_bad) :
+                                              dsda_TextColor(dsda_tc_exhud_render_good),
+    dsda_render_stats.patch_cache_evictions
+  );
+}
+
 void dsda_InitRenderStatsHC(int x_offset, int y_offset, int vpt, int* args, int arg_count, void** data) {
   *data = Z_Calloc(1, sizeof(local_component_t));
   local = *data;
 
   dsda_InitTextHC(&local->component[0], x_offset, y_offset, vpt);
   dsda_InitTextHC(&local->component[1], x_offset, y_offset + 8, vpt);
+  dsda_InitTextHC(&local->component[2], x_offset, y_offset + 16, vpt);
+  dsda_InitTextHC(&local->component[3], x_offset, y_offset + 24, vpt);
 }
 
 void dsda_UpdateRenderStatsHC(void* data) {
@@ -87,8 +123,12 @@ void dsda_UpdateRenderStatsHC(void* data) {
 
   dsda_UpdateCurrentComponentText(local->component[0].msg, sizeof(local->component[0].msg));
   dsda_UpdateMaxComponentText(local->component[1].msg, sizeof(local->component[1].msg));
+  dsda_UpdatePoolComponentText(local->component[2].msg, sizeof(local->component[2].msg));
+  dsda_UpdateCacheComponentText(local->component[3].msg, sizeof(local->component[3].msg));
   dsda_RefreshHudText(&local->component[0]);
   dsda_RefreshHudText(&local->component[1]);
+  dsda_RefreshHudText(&local->component[2]);
+  dsda_RefreshHudText(&local->component[3]);
 }
 
 void dsda_DrawRenderStatsHC(void* data) {
@@ -96,4 +136,6 @@ void dsda_DrawRenderStatsHC(void* data) {
 
   dsda_DrawBasicText(&local->component[0]);
   dsda_DrawBasicText(&local->component[1]);
+  dsda_DrawBasicText(&local->component[2]);
+  dsda_DrawBasicText(&local->component[3]);
 }
@@ -17,6 +17,10 @@
 
 #include <time.h>
 
+#include <zlib.h>
+
+#include "SDL.h"
+
 #include "doomstat.h"
 #include "s_advsound.h"
 #include "s_sound.h"
@@ -54,18 +58,50 @@ static dboolean auto_kf_timed_out;
 static int auto_kf_timeout_count;
 
 #define TIMEOUT_LIMIT 1
+#define KF_JOB_COUNT 4
 
 static dsda_key_frame_t first_kf;
 static dsda_key_frame_t quick_kf;
 static dsda_key_frame_t temp_kf;
-static auto_kf_t* auto_key_frames;
 static auto_kf_t* last_auto_kf;
 static int auto_kf_size;
+static int auto_kf_count;
+static size_t auto_kf_memory;
 static int restore_key_frame_index = -1;
+static unsigned int kf_serial;
 
 static int dsda_auto_key_frame_interval;
 static int dsda_auto_key_frame_depth;
 static int dsda_auto_key_frame_timeout;
+static size_t dsda_auto_key_frame_memory;
+
+// Auto key frames are compressed on a worker thread.
+// The main thread owns the ring and all zone allocations:
+//   it hands the worker a raw buffer and a scratch buffer,
+//   then adopts the result on a later tic.
+typedef enum {
+  kf_job_free,
+  kf_job_pending,
+  kf_job_working,
+  kf_job_done,
+} kf_job_state_t;
+
+typedef struct {
+  kf_job_state_t state;
+  auto_kf_t* auto_kf;
+  const byte* source;
+  int length;
+  byte* scratch;
+  uLongf scratch_length;
+  uLongf result_length;
+  dboolean ok;
+} kf_job_t;
+
+static kf_job_t kf_jobs[KF_JOB_COUNT];
+static SDL_Thread* kf_thread;
+static SDL_mutex* kf_mutex;
+static SDL_cond* kf_cond;
+static dboolean kf_quit;
 
 static int autoKeyFrameTimeout(void) {
   return dsda_StartInBuildMode() ? 0 : dsda_auto_key_frame_timeout;
@@ -78,6 +114,11 @@ static int autoKeyFrameDepth(void) {
   return dsda_auto_key_frame_depth;
 }
 
+// With a memory budget the ring keeps as many frames as fit
+static dboolean autoKeyFrameBudget(void) {
+  return dsda_auto_key_frame_memory > 0;
+}
+
 static int autoKeyFrameInterval(void) {
   if (dsda_StartInBuildMode())
     return 1;
@@ -85,8 +126,201 @@ static int autoKeyFrameInterval(void) {
   return dsda_auto_key_frame_interval;
 }
 
+static dboolean dsda_KeyFrameStored(dsda_key_frame_t* kf) {
+  return kf->buffer || kf->compressed;
+}
+
 static dboolean autoKFExists(auto_kf_t* auto_kf) {
-  return auto_kf && auto_kf->auto_index && auto_kf->kf.buffer;
+  return auto_kf && auto_kf->auto_index && dsda_KeyFrameStored(&auto_kf->kf);
+}
+
+static size_t dsda_KeyFrameMemory(dsda_key_frame_t* kf) {
+  return (kf->buffer ? kf->buffer_length : 0) + (kf->compressed ? kf->compressed_length : 0);
+}
+
+static int dsda_CompressKeyFrames(void* data) {
+  SDL_LockMutex(kf_mutex);
+
+  while (true) {
+    kf_job_t* job = NULL;
+    int i;
+
+    for (i = 0; i < KF_JOB_COUNT; ++i)
+      if (kf_jobs[i].state == kf_job_pending) {
+        job = &kf_jobs[i];
+        break;
+      }
+
+    if (!job) {
+      // Pending jobs are finished first so nothing queued is lost
+      if (kf_quit)
+        break;
+
+      SDL_CondWait(kf_cond, kf_mutex);
+      continue;
+    }
+
+    job->state = kf_job_working;
+    SDL_UnlockMutex(kf_mutex);
+
+    job->result_length = job->scratch_length;
+    job->ok = compress2(job->scratch, &job->result_length,
+                        job->source, job->length, Z_BEST_SPEED) == Z_OK;
+
+    SDL_LockMutex(kf_mutex);
+    job->state = kf_job_done;
+    SDL_CondBroadcast(kf_cond);
+  }
+
+  SDL_UnlockMutex(kf_mutex);
+
+  return 0;
+}
+
+// The worker must not be reading a buffer the main thread is about to free
+static void dsda_CancelKeyFrameJob(auto_kf_t* auto_kf) {
+  kf_job_t* job;
+
+  if (!auto_kf->job)
+    return;
+
+  job = &kf_jobs[auto_kf->job - 1];
+
+  SDL_LockMutex(kf_mutex);
+  while (job->state == kf_job_working)
+    SDL_CondWait(kf_cond, kf_mutex);
+  job->state = kf_job_free;
+  SDL_UnlockMutex(kf_mutex);
+
+  auto_kf->job = 0;
+}
+
+static void dsda_AdoptKeyFrameJobs(void) {
+  int i;
+
+  if (!kf_thread)
+    return;
+
+  SDL_LockMutex(kf_mutex);
+
+  for (i = 0; i < KF_JOB_COUNT; ++i) {
+    kf_job_t* job;
+    dsda_key_frame_t* kf;
+
+    job = &kf_jobs[i];
+
+    if (job->state != kf_job_done)
+      continue;
+
+    job->state = kf_job_free;
+    job->auto_kf->job = 0;
+    kf = &job->auto_kf->kf;
+
+    if (!job->ok || kf->buffer != job->source)
+      continue;
+
+    kf->compressed = Z_Malloc(job->result_length);
+    kf->compressed_length = job->result_length;
+    memcpy(kf->compressed, job->scratch, job->result_length);
+
+    auto_kf_memory += kf->compressed_length;
+    auto_kf_memory -= kf->buffer_length;
+
+    Z_Free(kf->buffer);
+    kf->buffer = NULL;
+  }
+
+  SDL_UnlockMutex(kf_mutex);
+}
+
+static void dsda_StopKeyFrameCompression(void) {
+  int i;
+
+  if (!kf_thread)
+    return;
+
+  SDL_LockMutex(kf_mutex);
+  kf_quit = true;
+  SDL_CondBroadcast(kf_cond);
+  SDL_UnlockMutex(kf_mutex);
+
+  SDL_WaitThread(kf_thread, NULL);
+
+  dsda_AdoptKeyFrameJobs();
+
+  kf_thread = NULL;
+  kf_quit = false;
+
+  SDL_DestroyCond(kf_cond);
+  SDL_DestroyMutex(kf_mutex);
+  kf_cond = NULL;
+  kf_mutex = NULL;
+
+  for (i = 0; i < KF_JOB_COUNT; ++i) {
+    Z_Free(kf_jobs[i].scratch);
+    kf_jobs[i].scratch = NULL;
+    kf_jobs[i].scratch_length = 0;
+  }
+}
+
+static void dsda_QueueKeyFrameJob(auto_kf_t* auto_kf) {
+  kf_job_t* job = NULL;
+  uLongf bound;
+  int i;
+
+  if (!kf_thread) {
+    kf_mutex = SDL_CreateMutex();
+    kf_cond = SDL_CreateCond();
+    kf_thread = SDL_CreateThread(dsda_CompressKeyFrames, "dsda_CompressKeyFrames", NULL);
+
+    if (!kf_thread)
+      I_Error("dsda_QueueKeyFrameJob: failed to create thread");
+
+    I_AtExit(dsda_StopKeyFrameCompression, true, "dsda_StopKeyFrameCompression",
+             exit_priority_normal);
+  }
+
+  SDL_LockMutex(kf_mutex);
+  for (i = 0; i < KF_JOB_COUNT; ++i)
+    if (kf_jobs[i].state == kf_job_free) {
+      job = &kf_jobs[i];
+      break;
+    }
+  SDL_UnlockMutex(kf_mutex);
+
+  // The frame stays raw if the worker is behind
+  if (!job)
+    return;
+
+  bound = compressBound(auto_kf->kf.buffer_length);
+  if (job->scratch_length < bound) {
+    Z_Free(job->scratch);
+    job->scratch = Z_Malloc(bound);
+    job->scratch_length = bound;
+  }
+
+  job->auto_kf = auto_kf;
+  job->source = auto_kf->kf.buffer;
+  job->length = auto_kf->kf.buffer_length;
+  auto_kf->job = i + 1;
+
+  SDL_LockMutex(kf_mutex);
+  job->state = kf_job_pending;
+  SDL_CondSignal(kf_cond);
+  SDL_UnlockMutex(kf_mutex);
+}
+
+static void dsda_DropAutoKF(auto_kf_t* auto_kf) {
+  dsda_CancelKeyFrameJob(auto_kf);
+
+  auto_kf_memory -= dsda_KeyFrameMemory(&auto_kf->kf);
+
+  Z_Free(auto_kf->kf.buffer);
+  auto_kf->kf.buffer = NULL;
+  Z_Free(auto_kf->kf.compressed);
+  auto_kf->kf.compressed = NULL;
+
+  auto_kf->auto_index = 0;
 }
 
 void dsda_ForgetAutoKeyFrames(void) {
@@ -96,20 +330,20 @@ void dsda_ForgetAutoKeyFrames(void) {
 
 static void dsda_ResetParentKF(dsda_key_frame_t* kf) {
   kf->parent.auto_kf = NULL;
-  kf->parent.buffer = NULL;
+  kf->parent.serial = 0;
 }
 
 static void dsda_AttachAutoKF(dsda_key_frame_t* kf) {
   if (autoKFExists(last_auto_kf)) {
     kf->parent.auto_kf = last_auto_kf;
-    kf->parent.buffer = last_auto_kf->kf.buffer;
+    kf->parent.serial = last_auto_kf->kf.serial;
   }
   else
     dsda_ResetParentKF(kf);
 }
 
 static void dsda_ResolveParentKF(dsda_key_frame_t* kf) {
-  if (autoKFExists(kf->parent.auto_kf) && kf->parent.auto_kf->kf.buffer == kf->parent.buffer)
+  if (autoKFExists(kf->parent.auto_kf) && kf->parent.auto_kf->kf.serial == kf->parent.serial)
     last_auto_kf = kf->parent.auto_kf;
   else {
     dsda_ResetParentKF(kf);
@@ -137,7 +371,7 @@ static dsda_key_frame_t* dsda_ClosestKeyFrame(int target_tic_count) {
     auto_kf_t* auto_kf;
 
     auto_kf = last_auto_kf;
-    for (auto_kf = last_auto_kf; auto_kf && auto_kf->kf.buffer; dsda_RewindKF(&auto_kf))
+    for (auto_kf = last_auto_kf; auto_kf && dsda_KeyFrameStored(&auto_kf->kf); dsda_RewindKF(&auto_kf))
       if (auto_kf->kf.game_tic_count <= target_tic_count)
         if (!closest || auto_kf->kf.game_tic_count > closest->game_tic_count) {
           closest = &auto_kf->kf;
@@ -165,41 +399,79 @@ static dsda_key_frame_t* dsda_ClosestKeyFrame(int target_tic_count) {
 
 void dsda_CopyKeyFrame(dsda_key_frame_t* dest, dsda_key_frame_t* source) {
   *dest = *source;
-  dest->buffer = Z_Malloc(dest->buffer_length);
-  memcpy(dest->buffer, source->buffer, dest->buffer_length);
+
+  if (source->buffer) {
+    dest->buffer = Z_Malloc(dest->buffer_length);
+    memcpy(dest->buffer, source->buffer, dest->buffer_length);
+  }
+
+  if (source->compressed) {
+    dest->compressed = Z_Malloc(dest->compressed_length);
+    memcpy(dest->compressed, source->compressed, dest->compressed_length);
+  }
 }
 
-void dsda_InitKeyFrame(void) {
-  int i;
+static auto_kf_t* dsda_NewAutoKF(void) {
+  auto_kf_t* auto_kf;
+
+  auto_kf = Z_Calloc(1, sizeof(*auto_kf));
+  ++auto_kf_count;
 
+  return auto_kf;
+}
+
+static void dsda_FreeAutoKeyFrames(void) {
+  auto_kf_t* auto_kf;
+
+  if (!last_auto_kf)
+    return;
+
+  last_auto_kf->prev->next = NULL;
+
+  while (last_auto_kf) {
+    auto_kf = last_auto_kf;
+    last_auto_kf = auto_kf->next;
+
+    dsda_DropAutoKF(auto_kf);
+    Z_Free(auto_kf);
+  }
+
+  auto_kf_count = 0;
+  auto_kf_memory = 0;
+}
+
+void dsda_InitKeyFrame(void) {
   dsda_auto_key_frame_interval = dsda_IntConfig(dsda_config_auto_key_frame_interval);
   dsda_auto_key_frame_depth = dsda_IntConfig(dsda_config_auto_key_frame_depth);
   dsda_auto_key_frame_timeout = dsda_IntConfig(dsda_config_auto_key_frame_timeout);
+  dsda_auto_key_frame_memory =
+    (size_t) dsda_IntConfig(dsda_config_auto_key_frame_memory) * 1024 * 1024;
+
+  dsda_FreeAutoKeyFrames();
 
   auto_kf_size = autoKeyFrameDepth();
 
-  if (!auto_kf_size) {
-    last_auto_kf = NULL;
+  if (!auto_kf_size && !autoKeyFrameBudget())
     return;
-  }
-
-  if (auto_key_frames != NULL)
-    Z_Free(auto_key_frames);
 
   ++auto_kf_size; // chain includes a terminator
 
-  auto_key_frames = Z_Calloc(auto_kf_size, sizeof(auto_kf_t));
-
-  auto_key_frames[0].prev = &auto_key_frames[auto_kf_size - 1];
-  auto_key_frames[auto_kf_size - 1].next = &auto_key_frames[0];
+  // The ring grows up to the depth or the memory budget as frames are stored
+  last_auto_kf = dsda_NewAutoKF();
+  last_auto_kf->next = dsda_NewAutoKF();
+  last_auto_kf->prev = last_auto_kf->next;
+  last_auto_kf->next->next = last_auto_kf;
+  last_auto_kf->next->prev = last_auto_kf;
+}
 
-  for (i = 0; i < auto_kf_size - 1; ++i)
-    auto_key_frames[i].next = &auto_key_frames[i + 1];
+void dsda_AutoKeyFrameUsage(int* count, size_t* memory) {
+  auto_kf_t* auto_kf;
 
-  for (i = 1; i < auto_kf_size; ++i)
-    auto_key_frames[i].prev = &auto_key_frames[i - 1];
+  *count = 0;
+  *memory = auto_kf_memory;
 
-  last_auto_kf = &auto_key_frames[auto_kf_size - 1];
+  for (auto_kf = last_auto_kf; autoKFExists(auto_kf); dsda_RewindKF(&auto_kf))
+    ++*count;
 }
 
 void dsda_ExportKeyFrame(byte* buffer, int length) {
@@ -220,6 +492,7 @@ void dsda_ExportKeyFrame(byte* buffer, int length) {
 // Stripped down version of G_DoSaveGame
 void dsda_StoreKeyFrame(dsda_key_frame_t* key_frame, byte complete, byte export) {
   key_frame->game_tic_count = true_logictic;
+  key_frame->serial = ++kf_serial;
 
   P_InitSaveBuffer();
 
@@ -235,7 +508,9 @@ void dsda_StoreKeyFrame(dsda_key_frame_t* key_frame, byte complete, byte export)
   dsda_ArchiveAll();
 
   if (key_frame->buffer != NULL) Z_Free(key_frame->buffer);
+  if (key_frame->compressed != NULL) Z_Free(key_frame->compressed);
 
+  key_frame->compressed = NULL;
   key_frame->buffer = savebuffer;
   key_frame->buffer_length = save_p - savebuffer;
 
@@ -256,18 +531,30 @@ void dsda_RestoreKeyFrame(dsda_key_frame_t* key_frame, dboolean skip_wipe) {
   void G_AfterLoad(void);
 
   byte complete;
+  byte* inflated = NULL;
 
-  if (key_frame->buffer == NULL) {
+  if (!dsda_KeyFrameStored(key_frame)) {
     doom_printf("No key frame found");
     return;
   }
 
+  if (!key_frame->buffer) {
+    uLongf length;
+
+    length = key_frame->buffer_length;
+    inflated = Z_Malloc(length);
+
+    if (uncompress(inflated, &length, key_frame->compressed, key_frame->compressed_length) != Z_OK ||
+        length != key_frame->buffer_length)
+      I_Error("dsda_RestoreKeyFrame: corrupt compressed key frame");
+  }
+
   dsda_TrackFeature(uf_keyframe);
 
   if (skip_wipe || dsda_BuildMode())
     dsda_SkipNextWipe();
 
-  save_p = key_frame->buffer;
+  save_p = inflated ? inflated : key_frame->buffer;
 
   P_LOAD_BYTE(complete);
   P_LOAD_X(key_frame->game_tic_count);
@@ -280,6 +567,8 @@ void dsda_RestoreKeyFrame(dsda_key_frame_t* key_frame, dboolean skip_wipe) {
 
   dsda_UnArchiveAll();
 
+  Z_Free(inflated);
+
   dsda_RestoreCommandHistory();
 
   restore_key_frame_index = (totalleveltimes + leveltime) / (35 * autoKeyFrameInterval());
@@ -345,8 +634,15 @@ void dsda_RewindAutoKeyFrame(void) {
   load_kf = last_auto_kf;
   dsda_RewindKF(&load_kf);
 
-  if (load_kf)
+  if (load_kf) {
+    int count;
+    size_t memory;
+
     dsda_RestoreKeyFrame(&load_kf->kf, true);
+
+    dsda_AutoKeyFrameUsage(&count, &memory);
+    doom_printf("Restored key frame (%d kept in %d KB)", count, (int) (memory / 1024));
+  }
   else
     doom_printf("No key frame found"); // rewind past the depth limit
 }
@@ -356,15 +652,68 @@ void dsda_ResetAutoKeyFrameTimeout(void) {
   auto_kf_timeout_count = 0;
 }
 
+static dboolean dsda_GrowAutoKeyFrames(void) {
+  auto_kf_t* terminator;
+
+  terminator = last_auto_kf->next;
+
+  // After a rewind the newer frames are overwritten as before
+  if (dsda_KeyFrameStored(&terminator->kf))
+    return false;
+
+  // Dropped frames leave spare links to reuse first
+  if (!autoKFExists(terminator->next) && terminator->next != last_auto_kf)
+    return false;
+
+  if (autoKeyFrameBudget())
+    return auto_kf_memory < dsda_auto_key_frame_memory;
+
+  return auto_kf_count < auto_kf_size;
+}
+
+static void dsda_AdvanceAutoKF(void) {
+  if (dsda_GrowAutoKeyFrames()) {
+    auto_kf_t* auto_kf;
+
+    auto_kf = dsda_NewAutoKF();
+    auto_kf->prev = last_auto_kf;
+    auto_kf->next = last_auto_kf->next;
+    last_auto_kf->next->prev = auto_kf;
+    last_auto_kf->next = auto_kf;
+  }
+  else
+    dsda_DropAutoKF(last_auto_kf->next->next);
+
+  last_auto_kf = last_auto_kf->next;
+  dsda_DropAutoKF(last_auto_kf);
+  last_auto_kf->auto_index = last_auto_kf->prev->auto_index + 1;
+}
+
+// Drop the oldest frames until the ring fits in the budget
+static void dsda_TrimAutoKeyFrames(void) {
+  auto_kf_t* oldest;
+
+  if (!autoKeyFrameBudget())
+    return;
+
+  for (oldest = last_auto_kf->next->next;
+       auto_kf_memory > dsda_auto_key_frame_memory && oldest != last_auto_kf;
+       oldest = oldest->next)
+    if (dsda_KeyFrameStored(&oldest->kf))
+      dsda_DropAutoKF(oldest);
+}
+
 void dsda_UpdateAutoKeyFrames(void) {
   int key_frame_index;
   int current_time;
   int interval_tics;
   dsda_key_frame_t* current_key_frame;
 
+  dsda_AdoptKeyFrameJobs();
+
   if (
     auto_kf_timed_out ||
-    auto_kf_size == 0 ||
+    !last_auto_kf ||
     gamestate != GS_LEVEL ||
     gameaction != ga_nothing
   ) return;
@@ -382,9 +731,7 @@ void dsda_UpdateAutoKeyFrames(void) {
       return;
     }
 
-    last_auto_kf = last_auto_kf->next;
-    last_auto_kf->next->auto_index = 0;
-    last_auto_kf->auto_index = last_auto_kf->prev->auto_index + 1;
+    dsda_AdvanceAutoKF();
 
     current_key_frame = &last_auto_kf->kf;
 
@@ -411,5 +758,9 @@ void dsda_UpdateAutoKeyFrames(void) {
 
     if (!first_kf.buffer)
       dsda_CopyKeyFrame(&first_kf, current_key_frame);
+
+    auto_kf_memory += current_key_frame->buffer_length;
+    dsda_TrimAutoKeyFrames();
+    dsda_QueueKeyFrameJob(last_auto_kf);
   }
 }
@@ -18,24 +18,30 @@
 #ifndef __DSDA_KEY_FRAME__
 #define __DSDA_KEY_FRAME__
 
+#include <stddef.h>
+
 #include "doomtype.h"
 
 struct auto_kf_s;
 
 typedef struct {
-  byte* buffer;
+  unsigned int serial;
   struct auto_kf_s* auto_kf;
 } parent_kf_t;
 
 typedef struct {
   byte* buffer;
   int buffer_length;
+  byte* compressed;
+  int compressed_length;
   int game_tic_count;
+  unsigned int serial;
   parent_kf_t parent;
 } dsda_key_frame_t;
 
 typedef struct auto_kf_s {
   int auto_index;
+  int job;
   dsda_key_frame_t kf;
   struct auto_kf_s* prev;
   struct auto_kf_s* next;
@@ -54,5 +60,6 @@ void dsda_RewindAutoKeyFrame(void);
 void dsda_ResetAutoKeyFrameTimeout(void);
 void dsda_UpdateAutoKeyFrames(void);
 void dsda_ForgetAutoKeyFrames(void);
+void dsda_AutoKeyFrameUsage(int* count, size_t* memory);
 
 #endif
@@ -0,0 +1,251 @@
+//
+// Copyright(C) 2023 by Ryan Krafnick
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	DSDA Key Frame Index
+//
+//  Sidecar file of compressed key frames written during a first playback
+//    pass, so that later passes can start from any stored tic.
+//
+
+#include <stdio.h>
+#include <zlib.h>
+
+#include "doomstat.h"
+#include "g_game.h"
+#include "lprintf.h"
+#include "m_file.h"
+#include "w_wad.h"
+#include "z_zone.h"
+
+#include "dsda/key_frame.h"
+#include "dsda/state_hash.h"
+
+#include "key_frame_index.h"
+
+#define DSDA_KEY_FRAME_INDEX_VERSION 2
+#define DEFAULT_INDEX_INTERVAL (60 * TICRATE)
+#define INDEX_HEADER_SIZE 8
+
+static FILE* index_export;
+static int index_interval;
+static int last_index_tic = -1;
+static dsda_key_frame_t index_kf;
+
+static FILE* index_file;
+static dsda_key_frame_index_entry_t* index_entries;
+static int index_count;
+static int index_seek_tic = -1;
+static int index_gametic_offset;
+
+static char* dsda_KeyFrameIndexFileName(const char* name) {
+  char* filename;
+
+  filename = Z_Malloc(strlen(name) + 4 + 1);
+  AddDefaultExtension(strcpy(filename, name), ".kfi");
+
+  return filename;
+}
+
+void dsda_InitKeyFrameIndexExport(const char* name, int interval) {
+  int version;
+  char* filename;
+
+  filename = dsda_KeyFrameIndexFileName(name);
+
+  index_export = M_OpenFile(filename, "wb");
+
+  if (index_export == NULL)
+    I_Error("dsda_InitKeyFrameIndexExport: failed to open %s", filename);
+
+  version = DSDA_KEY_FRAME_INDEX_VERSION;
+  fwrite(&version, sizeof(int), 1, index_export);
+
+  index_interval = interval > 0 ? interval : DEFAULT_INDEX_INTERVAL;
+
+  Z_Free(filename);
+}
+
+void dsda_LoadKeyFrameIndex(const char* name) {
+  int version;
+  int header[INDEX_HEADER_SIZE];
+  char* filename;
+  long file_length;
+  int size = 0;
+
+  filename = dsda_KeyFrameIndexFileName(name);
+
+  index_file = M_OpenFile(filename, "rb");
+
+  if (index_file == NULL)
+    I_Error("dsda_LoadKeyFrameIndex: failed to open %s", filename);
+
+  if (fread(&version, sizeof(int), 1, index_file) != 1 ||
+      version != DSDA_KEY_FRAME_INDEX_VERSION)
+    I_Error("dsda_LoadKeyFrameIndex: unsupported index version %s", filename);
+
+  fseek(index_file, 0, SEEK_END);
+  file_length = ftell(index_file);
+  fseek(index_file, sizeof(int), SEEK_SET);
+
+  while (fread(header, sizeof(header), 1, index_file) == 1) {
+    dsda_key_frame_index_entry_t* entry;
+
+    if (index_count == size) {
+      size = size ? size * 2 : 64;
+      index_entries = Z_Realloc(index_entries, size * sizeof(*index_entries));
+    }
+
+    entry = &index_entries[index_count];
+    entry->tic = header[0];
+    entry->gametic = header[1];
+    entry->hash = (unsigned int) header[2];
+    entry->episode = header[3];
+    entry->map = header[4];
+    entry->level_start = header[5];
+    entry->length = header[6];
+    entry->compressed_length = header[7];
+    entry->offset = ftell(index_file);
+
+    // A truncated final entry (interrupted first pass) is ignored
+    if (entry->offset + entry->compressed_length > file_length)
+      break;
+
+    fseek(index_file, entry->compressed_length, SEEK_CUR);
+
+    ++index_count;
+  }
+
+  lprintf(LO_INFO, "dsda_LoadKeyFrameIndex: %d key frames in %s\n", index_count, filename);
+
+  Z_Free(filename);
+}
+
+dboolean dsda_KeyFrameIndexLoaded(void) {
+  return index_file != NULL && index_count > 0;
+}
+
+int dsda_KeyFrameIndexCount(void) {
+  return index_count;
+}
+
+const dsda_key_frame_index_entry_t* dsda_KeyFrameIndexEntry(int i) {
+  return &index_entries[i];
+}
+
+// Difference between this process's gametic and the one the index was written at
+int dsda_KeyFrameIndexGameticOffset(void) {
+  return index_gametic_offset;
+}
+
+void dsda_QueueKeyFrameIndexSeek(int tic) {
+  index_seek_tic = tic;
+}
+
+static void dsda_ExportKeyFrameIndexEntry(dboolean level_start) {
+  int header[INDEX_HEADER_SIZE];
+  uLongf compressed_length;
+  byte* compressed;
+
+  dsda_StoreKeyFrame(&index_kf, false, false);
+
+  compressed_length = compressBound(index_kf.buffer_length);
+  compressed = Z_Malloc(compressed_length);
+
+  if (compress2(compressed, &compressed_length,
+                index_kf.buffer, index_kf.buffer_length, Z_BEST_SPEED) != Z_OK)
+    I_Error("dsda_ExportKeyFrameIndexEntry: failed to compress key frame");
+
+  header[0] = index_kf.game_tic_count;
+  header[1] = gametic;
+  header[2] = (int) dsda_StateHash();
+  header[3] = gameepisode;
+  header[4] = gamemap;
+  header[5] = level_start;
+  header[6] = index_kf.buffer_length;
+  header[7] = (int) compressed_length;
+
+  fwrite(header, sizeof(header), 1, index_export);
+  fwrite(compressed, 1, compressed_length, index_export);
+
+  Z_Free(compressed);
+}
+
+static void dsda_RestoreKeyFrameIndexEntry(dsda_key_frame_index_entry_t* entry) {
+  dsda_key_frame_t key_frame = { 0 };
+  uLongf length;
+  byte* compressed;
+
+  compressed = Z_Malloc(entry->compressed_length);
+
+  if (fseek(index_file, entry->offset, SEEK_SET) ||
+      fread(compressed, entry->compressed_length, 1, index_file) != 1)
+    I_Error("dsda_RestoreKeyFrameIndexEntry: failed to read key frame at tic %d", entry->tic);
+
+  length = entry->length;
+  key_frame.buffer = Z_Malloc(length);
+  key_frame.buffer_length = entry->length;
+
+  if (uncompress(key_frame.buffer, &length, compressed, entry->compressed_length) != Z_OK ||
+      length != entry->length)
+    I_Error("dsda_RestoreKeyFrameIndexEntry: corrupt key frame at tic %d", entry->tic);
+
+  Z_Free(compressed);
+
+  dsda_RestoreKeyFrame(&key_frame, true);
+  Z_Free(key_frame.buffer);
+
+  index_gametic_offset = entry->gametic - gametic;
+}
+
+static void dsda_SeekKeyFrameIndex(int tic) {
+  dsda_key_frame_index_entry_t* closest = NULL;
+  int i;
+
+  for (i = 0; i < index_count; ++i)
+    if (index_entries[i].tic <= tic)
+      if (!closest || index_entries[i].tic >= closest->tic)
+        closest = &index_entries[i];
+
+  // Playing from here is already as close as we can get
+  if (!closest || closest->tic <= true_logictic)
+    return;
+
+  dsda_RestoreKeyFrameIndexEntry(closest);
+}
+
+void dsda_UpdateKeyFrameIndex(void) {
+  dboolean level_start;
+
+  if (gamestate != GS_LEVEL || gameaction != ga_nothing)
+    return;
+
+  if (index_seek_tic >= 0) {
+    if (demoplayback && dsda_KeyFrameIndexLoaded())
+      dsda_SeekKeyFrameIndex(index_seek_tic);
+
+    index_seek_tic = -1;
+
+    return;
+  }
+
+  if (!index_export || true_logictic == last_index_tic)
+    return;
+
+  level_start = (leveltime == 0);
+
+  if (level_start || true_logictic % index_interval == 0) {
+    dsda_ExportKeyFrameIndexEntry(level_start);
+    last_index_tic = true_logictic;
+  }
+}
@@ -0,0 +1,44 @@
+//
+// Copyright(C) 2023 by Ryan Krafnick
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	DSDA Key Frame Index
+//
+
+#ifndef __DSDA_KEY_FRAME_INDEX__
+#define __DSDA_KEY_FRAME_INDEX__
+
+#include "doomtype.h"
+
+typedef struct {
+  int tic;
+  int gametic;
+  unsigned int hash;
+  int episode;
+  int map;
+  int level_start;
+  int length;
+  int compressed_length;
+  long offset;
+} dsda_key_frame_index_entry_t;
+
+void dsda_InitKeyFrameIndexExport(const char* name, int interval);
+void dsda_LoadKeyFrameIndex(const char* name);
+dboolean dsda_KeyFrameIndexLoaded(void);
+int dsda_KeyFrameIndexCount(void);
+const dsda_key_frame_index_entry_t* dsda_KeyFrameIndexEntry(int i);
+int dsda_KeyFrameIndexGameticOffset(void);
+void dsda_QueueKeyFrameIndexSeek(int tic);
+void dsda_UpdateKeyFrameIndex(void);
+
+#endif
@@ -19,19 +19,58 @@
 #include "sounds.h"
 #include "w_wad.h"
 #include "lprintf.h"
+#include "z_zone.h"
 
 #include "dsda/time.h"
 
 #include "memory.h"
 
+typedef struct {
+  const byte* data;
+  int length;
+} sound_lump_t;
+
+static sound_lump_t* sound_lumps;
+static int sound_lump_count;
+
 void dsda_CacheSoundLumps(void) {
   int i;
 
+  sound_lumps = Z_Malloc(num_sfx * sizeof(*sound_lumps));
+  sound_lump_count = 0;
+
   for (i = 0; i < num_sfx; ++i) {
     sfxinfo_t *sfx = &S_sfx[i];
     sfx->lumpnum = I_GetSfxLumpNum(sfx);
 
-    if (sfx->lumpnum >= 0)
-      W_LockLumpNum(sfx->lumpnum);
+    if (sfx->lumpnum >= 0) {
+      sound_lump_t* lump = &sound_lumps[sound_lump_count];
+
+      lump->data = W_LockLumpNum(sfx->lumpnum);
+      lump->length = W_LumpLength(sfx->lumpnum);
+
+      if (lump->data)
+        ++sound_lump_count;
+    }
   }
 }
+
+// The mixer reads sound lumps in place, which can mean mapped wad pages.
+// Reading one byte per page pulls them in before the first sound plays.
+void dsda_TouchSoundLumps(void) {
+  static volatile byte sink;
+  byte sum = 0;
+  int i, j;
+
+  for (i = 0; i < sound_lump_count; ++i)
+    for (j = 0; j < sound_lumps[i].length; j += 4096)
+      sum += sound_lumps[i].data[j];
+
+  sink = sum;
+}
+
+void dsda_FreeSoundLumpTable(void) {
+  Z_Free(sound_lumps);
+  sound_lumps = NULL;
+  sound_lump_count = 0;
+}
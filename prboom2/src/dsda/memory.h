@@ -19,5 +19,7 @@
 #define __DSDA_MEMORY__
 
 void dsda_CacheSoundLumps(void);
+void dsda_TouchSoundLumps(void);
+void dsda_FreeSoundLumpTable(void);
 
 #endif
@@ -101,7 +101,8 @@ void dsda_ArchiveMSecNodes(void) {
       msecnode = msecnode->m_snext;
     }
 
-    P_SAVE_X(count);
+    CheckSaveGame(sizeof(count) + count * sizeof(th->prev));
+    P_WRITE_X(count);
 
     msecnode = sectors[sector_i].touching_thinglist;
     while (msecnode) {
@@ -113,7 +114,7 @@ void dsda_ArchiveMSecNodes(void) {
         continue;
       }
 
-      P_SAVE_X(th->prev);
+      P_WRITE_X(th->prev);
 
       msecnode = msecnode->m_snext;
     }
@@ -132,13 +133,14 @@ void dsda_ArchiveMSecNodes(void) {
       msecnode = msecnode->m_tnext;
     }
 
-    P_SAVE_X(count);
+    CheckSaveGame(sizeof(count) + count * sizeof(sector_i));
+    P_WRITE_X(count);
 
     msecnode = ((mobj_t*) th)->touching_sectorlist;
     while (msecnode) {
       sector_i = msecnode->m_sector - sectors;
 
-      P_SAVE_X(sector_i);
+      P_WRITE_X(sector_i);
 
       msecnode = msecnode->m_tnext;
     }
@@ -192,14 +192,24 @@ int dsda_PlaybackTics(void) {
   return playback_tics;
 }
 
+// Store an offset rather than the pointer so key frames work across processes
 void dsda_StorePlaybackPosition(void) {
+  int playback_offset;
+
+  playback_offset = playback_p ? playback_p - playback_origin_p : -1;
+
   P_SAVE_X(playback_tics);
-  P_SAVE_X(playback_p);
+  P_SAVE_X(playback_offset);
 }
 
 void dsda_RestorePlaybackPosition(void) {
+  int playback_offset;
+
   P_LOAD_X(playback_tics);
-  P_LOAD_X(playback_p);
+  P_LOAD_X(playback_offset);
+
+  playback_p = playback_origin_p && playback_offset >= 0 ?
+               playback_origin_p + playback_offset : NULL;
 }
 
 void dsda_ClearPlaybackStream(void) {
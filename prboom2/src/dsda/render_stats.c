@@ -37,6 +37,24 @@ static void dsda_UpdateMaxValues(dsda_render_stats_t* x, dsda_render_stats_t* y)
 
   if (x->vissprites < y->vissprites)
     x->vissprites = y->vissprites;
+
+  if (x->visplane_pool < y->visplane_pool)
+    x->visplane_pool = y->visplane_pool;
+
+  if (x->visplane_allocations < y->visplane_allocations)
+    x->visplane_allocations = y->visplane_allocations;
+
+  if (x->patch_cache_kb < y->patch_cache_kb)
+    x->patch_cache_kb = y->patch_cache_kb;
+
+  if (x->patch_cache_hits < y->patch_cache_hits)
+    x->patch_cache_hits = y->patch_cache_hits;
+
+  if (x->patch_cache_misses < y->patch_cache_misses)
+    x->patch_cache_misses = y->patch_cache_misses;
+
+  if (x->patch_cache_evictions < y->patch_cache_evictions)
+    x->patch_cache_evictions = y->patch_cache_evictions;
 }
 
 void dsda_BeginRenderStats(void) {
@@ -72,6 +90,22 @@ void dsda_RecordDrawSegs(int n) {
   frame_stats.drawsegs += n;
 }
 
+void dsda_RecordVisPlanePool(int size) {
+  frame_stats.visplane_pool = size;
+}
+
+// Counted per interval rather than per frame, since growth is rare
+void dsda_RecordVisPlaneAllocations(int n) {
+  interval_stats.visplane_allocations += n;
+}
+
+void dsda_RecordPatchCache(int kb, int hits, int misses, int evictions) {
+  frame_stats.patch_cache_kb = kb;
+  interval_stats.patch_cache_hits += hits;
+  interval_stats.patch_cache_misses += misses;
+  interval_stats.patch_cache_evictions += evictions;
+}
+
 void dsda_UpdateRenderStats(void) {
   dsda_UpdateMaxValues(&interval_stats, &frame_stats);
 
@@ -22,8 +22,17 @@ typedef struct {
   int visplanes;
   int drawsegs;
   int vissprites;
+  int visplane_pool;
+  int visplane_allocations;
+  int patch_cache_kb;
+  int patch_cache_hits;
+  int patch_cache_misses;
+  int patch_cache_evictions;
 } dsda_render_stats_t;
 
+extern dsda_render_stats_t dsda_render_stats;
+extern dsda_render_stats_t dsda_render_stats_max;
+
 void dsda_BeginRenderStats(void);
 void dsda_RecordVisSprite(void);
 void dsda_RecordVisSprites(int n);
@@ -31,6 +40,9 @@ void dsda_RecordVisPlane(void);
 void dsda_RecordVisPlanes(int n);
 void dsda_RecordDrawSeg(void);
 void dsda_RecordDrawSegs(int n);
+void dsda_RecordVisPlanePool(int size);
+void dsda_RecordVisPlaneAllocations(int n);
+void dsda_RecordPatchCache(int kb, int hits, int misses, int evictions);
 void dsda_UpdateRenderStats(void);
 
 #endif
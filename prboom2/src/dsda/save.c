@@ -16,6 +16,7 @@
 //
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "doomstat.h"
 #include "g_game.h"
@@ -23,6 +24,7 @@
 #include "z_zone.h"
 #include "p_saveg.h"
 #include "p_map.h"
+#include "r_state.h"
 #include "s_sound.h"
 
 #include "dsda/args.h"
@@ -33,6 +35,7 @@
 #include "dsda/mapinfo.h"
 #include "dsda/music.h"
 #include "dsda/options.h"
+#include "dsda/time.h"
 
 #include "save.h"
 
@@ -162,7 +165,12 @@ void dsda_ArchiveAll(void) {
   dsda_ArchiveInternal();
 }
 
+static dboolean unarchiving;
+static dboolean archive_benchmark_queued;
+
 void dsda_UnArchiveAll(void) {
+  unarchiving = true;
+
   dsda_UnArchiveContext();
 
   P_MapStart();
@@ -180,6 +188,66 @@ void dsda_UnArchiveAll(void) {
   P_MapEnd();
 
   dsda_UnArchiveInternal();
+
+  unarchiving = false;
+}
+
+// Levels loaded by an unarchive are skipped, since the save buffer is in use
+void dsda_QueueArchiveBenchmark(void) {
+  if (!unarchiving && dsda_SimpleIntArg(dsda_arg_benchmark_archive) > 0)
+    archive_benchmark_queued = true;
+}
+
+// Runs from G_Ticker once no load is in progress.
+// Archives are repeated back to back, so every one should be identical.
+void dsda_BenchmarkArchive(void) {
+  int i;
+  int count;
+  byte* first = NULL;
+  size_t length = 0;
+  dboolean stable = true;
+  unsigned long long elapsed;
+  unsigned long long total = 0;
+  unsigned long long best = 0;
+
+  if (!archive_benchmark_queued)
+    return;
+
+  archive_benchmark_queued = false;
+  count = dsda_SimpleIntArg(dsda_arg_benchmark_archive);
+
+  for (i = 0; i < count; ++i) {
+    P_InitSaveBuffer();
+
+    dsda_StartTimer(dsda_timer_archive_benchmark);
+    dsda_ArchiveAll();
+    elapsed = dsda_ElapsedTime(dsda_timer_archive_benchmark);
+
+    total += elapsed;
+    if (!i || elapsed < best)
+      best = elapsed;
+
+    if (!first) {
+      first = savebuffer;
+      length = save_p - savebuffer;
+      P_ForgetSaveBuffer();
+    }
+    else {
+      if (save_p - savebuffer != length || memcmp(first, savebuffer, length))
+        stable = false;
+
+      P_FreeSaveBuffer();
+    }
+  }
+
+  Z_Free(first);
+
+  lprintf(LO_INFO, "dsda_BenchmarkArchive: %d archives of %lu bytes (%d sectors, %d lines), "
+                   "mean %llu us, best %llu us\n",
+          count, (unsigned long) length, numsectors, numlines, total / count, best);
+
+  if (!stable)
+    lprintf(LO_WARN, "dsda_BenchmarkArchive: repeated archives differ\n");
 }
 
 void dsda_InitSaveDir(void) {
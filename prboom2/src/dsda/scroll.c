@@ -17,36 +17,37 @@
 
 #include "p_tick.h"
 #include "r_state.h"
+#include "z_zone.h"
 
 #include "scroll.h"
 
-static void dsda_UpdateSideScrollerPosition(scroll_t* s, fixed_t dx, fixed_t dy) {
+static void dsda_UpdateSideScrollerPosition(int affectee, int flags, fixed_t dx, fixed_t dy) {
   side_t* side;
 
   if (!dx && !dy)
     return;
 
-  side = sides + s->affectee;
-  if (!s->flags)
+  side = sides + affectee;
+  if (!flags)
   {
     side->textureoffset += dx;
     side->rowoffset += dy;
   }
   else
   {
-    if (s->flags & SCROLL_TOP)
+    if (flags & SCROLL_TOP)
     {
       side->textureoffset_top += dx;
       side->rowoffset_top += dy;
     }
 
-    if (s->flags & SCROLL_MID)
+    if (flags & SCROLL_MID)
     {
       side->textureoffset_mid += dx;
       side->rowoffset_mid += dy;
     }
 
-    if (s->flags & SCROLL_BOTTOM)
+    if (flags & SCROLL_BOTTOM)
     {
       side->textureoffset_bottom += dx;
       side->rowoffset_bottom += dy;
@@ -54,24 +55,24 @@ static void dsda_UpdateSideScrollerPosition(scroll_t* s, fixed_t dx, fixed_t dy)
   }
 }
 
-static void dsda_UpdateFloorScrollerPosition(scroll_t* s, fixed_t dx, fixed_t dy) {
+static void dsda_UpdateFloorScrollerPosition(int affectee, fixed_t dx, fixed_t dy) {
   sector_t* sec;
 
   if (!dx && !dy)
     return;
 
-  sec = sectors + s->affectee;
+  sec = sectors + affectee;
   sec->floor_xoffs += dx;
   sec->floor_yoffs += dy;
 }
 
-static void dsda_UpdateCeilingScrollerPosition(scroll_t* s, fixed_t dx, fixed_t dy) {
+static void dsda_UpdateCeilingScrollerPosition(int affectee, fixed_t dx, fixed_t dy) {
   sector_t* sec;
 
   if (!dx && !dy)
     return;
 
-  sec = sectors + s->affectee;
+  sec = sectors + affectee;
   sec->ceiling_xoffs += dx;
   sec->ceiling_yoffs += dy;
 }
@@ -146,29 +147,29 @@ static void dsda_UpdateControlScroller(control_scroll_t* s) {
 
 void dsda_UpdateControlSideScroller(control_scroll_t* s) {
   dsda_UpdateControlScroller(s);
-  dsda_UpdateSideScrollerPosition(&s->scroll, s->vdx, s->vdy);
+  dsda_UpdateSideScrollerPosition(s->scroll.affectee, s->scroll.flags, s->vdx, s->vdy);
 }
 
 void dsda_UpdateSideScroller(scroll_t* s) {
-  dsda_UpdateSideScrollerPosition(s, s->dx, s->dy);
+  dsda_UpdateSideScrollerPosition(s->affectee, s->flags, s->dx, s->dy);
 }
 
 void dsda_UpdateControlFloorScroller(control_scroll_t* s) {
   dsda_UpdateControlScroller(s);
-  dsda_UpdateFloorScrollerPosition(&s->scroll, s->vdx, s->vdy);
+  dsda_UpdateFloorScrollerPosition(s->scroll.affectee, s->vdx, s->vdy);
 }
 
 void dsda_UpdateFloorScroller(scroll_t* s) {
-  dsda_UpdateFloorScrollerPosition(s, s->dx, s->dy);
+  dsda_UpdateFloorScrollerPosition(s->affectee, s->dx, s->dy);
 }
 
 void dsda_UpdateControlCeilingScroller(control_scroll_t* s) {
   dsda_UpdateControlScroller(s);
-  dsda_UpdateCeilingScrollerPosition(&s->scroll, s->vdx, s->vdy);
+  dsda_UpdateCeilingScrollerPosition(s->scroll.affectee, s->vdx, s->vdy);
 }
 
 void dsda_UpdateCeilingScroller(scroll_t* s) {
-  dsda_UpdateCeilingScrollerPosition(s, s->dx, s->dy);
+  dsda_UpdateCeilingScrollerPosition(s->affectee, s->dx, s->dy);
 }
 
 void dsda_UpdateControlFloorCarryScroller(control_scroll_t* s) {
@@ -177,7 +178,7 @@ void dsda_UpdateControlFloorCarryScroller(control_scroll_t* s) {
 }
 
 void dsda_UpdateFloorCarryScroller(scroll_t* s) {
-  dsda_UpdateFloorScrollerPosition(s, s->dx, s->dy);
+  dsda_UpdateFloorScrollerPosition(s->affectee, s->dx, s->dy);
 }
 
 void dsda_UpdateZDoomFloorScroller(scroll_t* s) {
@@ -483,3 +484,78 @@ void dsda_AddThruster(fixed_t dx, fixed_t dy, int affectee, int flags) {
   dsda_InitScroller(scroll, dx, dy, affectee, flags);
   P_AddThinker(&scroll->thinker);
 }
+
+// Texture scrollers only move texture and flat offsets that no other thinker
+//   reads, so they can run apart from the thinker list with the same result.
+// Vertical side scrollers are left out because 3D midtextures use the row
+//   offset for collision.
+dboolean dsda_IsTextureScroller(thinker_t* th) {
+  return (th->function == dsda_UpdateSideScroller && !((scroll_t*) th)->dy) ||
+         th->function == dsda_UpdateFloorScroller ||
+         th->function == dsda_UpdateCeilingScroller;
+}
+
+// The fields of a texture scroller never change after it is added,
+//   so each one runs from a packed copy instead of its thinker
+typedef struct {
+  int affectee;
+  int flags;
+  fixed_t dx;
+  fixed_t dy;
+} texture_scroll_t;
+
+typedef struct {
+  texture_scroll_t* scrolls;
+  int count;
+  int size;
+} texture_scroll_list_t;
+
+static texture_scroll_list_t side_scrolls;
+static texture_scroll_list_t floor_scrolls;
+static texture_scroll_list_t ceiling_scrolls;
+
+void dsda_ResetTextureScrollers(void) {
+  side_scrolls.count = 0;
+  floor_scrolls.count = 0;
+  ceiling_scrolls.count = 0;
+}
+
+void dsda_AddTextureScroller(scroll_t* s) {
+  texture_scroll_list_t* list;
+  texture_scroll_t* scroll;
+
+  if (!s->dx && !s->dy)
+    return;
+
+  list = s->thinker.function == dsda_UpdateSideScroller  ? &side_scrolls  :
+         s->thinker.function == dsda_UpdateFloorScroller ? &floor_scrolls :
+                                                           &ceiling_scrolls;
+
+  if (list->count == list->size) {
+    list->size = list->size ? list->size * 2 : 256;
+    list->scrolls = Z_Realloc(list->scrolls, list->size * sizeof(*list->scrolls));
+  }
+
+  scroll = &list->scrolls[list->count++];
+  scroll->affectee = s->affectee;
+  scroll->flags = s->flags;
+  scroll->dx = s->dx;
+  scroll->dy = s->dy;
+}
+
+void dsda_RunTextureScrollers(void) {
+  texture_scroll_t* scroll;
+  texture_scroll_t* end;
+
+  end = side_scrolls.scrolls + side_scrolls.count;
+  for (scroll = side_scrolls.scrolls; scroll < end; ++scroll)
+    dsda_UpdateSideScrollerPosition(scroll->affectee, scroll->flags, scroll->dx, 0);
+
+  end = floor_scrolls.scrolls + floor_scrolls.count;
+  for (scroll = floor_scrolls.scrolls; scroll < end; ++scroll)
+    dsda_UpdateFloorScrollerPosition(scroll->affectee, scroll->dx, scroll->dy);
+
+  end = ceiling_scrolls.scrolls + ceiling_scrolls.count;
+  for (scroll = ceiling_scrolls.scrolls; scroll < end; ++scroll)
+    dsda_UpdateCeilingScrollerPosition(scroll->affectee, scroll->dx, scroll->dy);
+}
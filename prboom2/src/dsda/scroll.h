@@ -86,4 +86,9 @@ void dsda_AddZDoomFloorScroller(fixed_t dx, fixed_t dy, int affectee, int flags)
 void dsda_AddZDoomCeilingScroller(fixed_t dx, fixed_t dy, int affectee, int flags);
 void dsda_AddThruster(fixed_t dx, fixed_t dy, int affectee, int flags);
 
+dboolean dsda_IsTextureScroller(thinker_t* th);
+void dsda_ResetTextureScrollers(void);
+void dsda_AddTextureScroller(scroll_t* s);
+void dsda_RunTextureScrollers(void);
+
 #endif
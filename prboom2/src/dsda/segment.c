@@ -0,0 +1,502 @@
+//
+// Copyright(C) 2023 by Ryan Krafnick
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	DSDA Segment
+//
+//  Splits stats extraction of one demo at the level starts recorded in a
+//    key frame index. The coordinator runs one worker process per level,
+//    each restoring its starting key frame, then joins the outputs and
+//    checks that every worker ended in the state the next one started from.
+//
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+#endif
+
+#include "SDL.h"
+
+#include "doomstat.h"
+#include "g_game.h"
+#include "i_main.h"
+#include "i_system.h"
+#include "lprintf.h"
+#include "m_file.h"
+#include "z_zone.h"
+
+#include "dsda/args.h"
+#include "dsda/key_frame_index.h"
+#include "dsda/state_hash.h"
+#include "dsda/stats_stream.h"
+#include "dsda/utility.h"
+
+#include "segment.h"
+
+extern int dsda_argc;
+extern char** dsda_argv;
+
+#ifndef _WIN32
+extern char** environ;
+#endif
+
+static dboolean segment_worker;
+static int segment_start = -1;
+static int segment_end = -1;
+static int segment_start_gametic = INT_MIN;
+static char* segment_end_filename;
+
+typedef struct {
+  int start;
+  int end;
+  const dsda_key_frame_index_entry_t* boundary;
+  char** argv;
+  char range[2][16];
+  int result;
+} segment_job_t;
+
+static segment_job_t* segment_jobs;
+static int segment_job_count;
+static int next_segment_job;
+static SDL_mutex* segment_job_mutex;
+
+static char* dsda_SegmentPartName(const char* filename, int start, const char* ext) {
+  dsda_string_t name;
+
+  dsda_InitString(&name, NULL);
+  dsda_StringPrintF(&name, "%s.%d.%s", filename, start, ext);
+
+  return name.string;
+}
+
+static const dsda_key_frame_index_entry_t* dsda_FindIndexEntry(int tic) {
+  int i;
+
+  for (i = 0; i < dsda_KeyFrameIndexCount(); ++i)
+    if (dsda_KeyFrameIndexEntry(i)->tic == tic)
+      return dsda_KeyFrameIndexEntry(i);
+
+  return NULL;
+}
+
+void dsda_InitSegment(void) {
+  dsda_arg_t* arg;
+
+  arg = dsda_Arg(dsda_arg_extract_segment);
+  if (!arg->found)
+    return;
+
+  if (!dsda_KeyFrameIndexLoaded())
+    I_Error("-extract_segment requires -key_frame_index");
+
+  segment_worker = true;
+  segment_start = arg->value.v_int_array[0];
+  segment_end = arg->value.v_int_array[1];
+
+  if (segment_start >= 0) {
+    const dsda_key_frame_index_entry_t* entry;
+
+    entry = dsda_FindIndexEntry(segment_start);
+
+    if (!entry)
+      I_Error("dsda_InitSegment: no key frame at tic %d", segment_start);
+
+    segment_start_gametic = entry->gametic;
+    dsda_QueueKeyFrameIndexSeek(segment_start);
+  }
+}
+
+dboolean dsda_SegmentWorker(void) {
+  return segment_worker;
+}
+
+char* dsda_SegmentFileName(const char* filename) {
+  segment_end_filename = dsda_SegmentPartName(filename, segment_start, "end");
+
+  return dsda_SegmentPartName(filename, segment_start, "part");
+}
+
+// Rows at or before the restored key frame belong to the previous segment
+dboolean dsda_SegmentRow(int tic) {
+  return !segment_worker || tic > segment_start_gametic;
+}
+
+void dsda_UpdateSegment(void) {
+  FILE* file;
+
+  if (!segment_worker || segment_end < 0)
+    return;
+
+  if (gamestate != GS_LEVEL || gameaction != ga_nothing || true_logictic < segment_end)
+    return;
+
+  file = M_OpenFile(segment_end_filename, "wb");
+
+  if (!file)
+    I_Error("dsda_UpdateSegment: failed to open %s", segment_end_filename);
+
+  fprintf(file, "%d %u\n", true_logictic, dsda_StateHash());
+  fclose(file);
+
+  I_SafeExit(0);
+}
+
+dboolean dsda_ParallelExtraction(void) {
+  return dsda_Arg(dsda_arg_extract_parallel)->found;
+}
+
+// The worker gets the coordinator's own arguments as an argv array,
+//   so nothing is ever interpreted by a shell.
+static void dsda_BuildSegmentArgs(segment_job_t* job) {
+  int i;
+  int argc = 0;
+
+  job->argv = Z_Malloc((dsda_argc + 4) * sizeof(*job->argv));
+  job->argv[argc++] = dsda_argv[0];
+
+  for (i = 1; i < dsda_argc; ++i) {
+    int value;
+
+    if (!stricmp(dsda_argv[i], "-extract_parallel")) {
+      if (i + 1 < dsda_argc && sscanf(dsda_argv[i + 1], "%d", &value) == 1)
+        ++i;
+
+      continue;
+    }
+
+    // Only the coordinator's playback wrote these
+    if (!stricmp(dsda_argv[i], "-export_key_frame_index") ||
+        !stricmp(dsda_argv[i], "-export_trajectory") ||
+        !stricmp(dsda_argv[i], "-export_state_hash")) {
+      ++i;
+
+      continue;
+    }
+
+    job->argv[argc++] = dsda_argv[i];
+  }
+
+  snprintf(job->range[0], sizeof(job->range[0]), "%d", job->start);
+  snprintf(job->range[1], sizeof(job->range[1]), "%d", job->end);
+
+  job->argv[argc++] = "-extract_segment";
+  job->argv[argc++] = job->range[0];
+  job->argv[argc++] = job->range[1];
+  job->argv[argc] = NULL;
+}
+
+#ifdef _WIN32
+
+// CreateProcess takes one command line, which the child splits again
+//   following the msvcrt rules: backslashes are only special before a quote.
+static void dsda_QuoteSegmentArg(dsda_string_t* command, const char* arg) {
+  const char* p;
+
+  if (command->string && command->string[0])
+    dsda_StringCat(command, " ");
+
+  if (arg[0] && !strpbrk(arg, " \t\n\v\"")) {
+    dsda_StringCat(command, arg);
+    return;
+  }
+
+  dsda_StringCat(command, "\"");
+
+  for (p = arg; ; ++p) {
+    int backslashes = 0;
+
+    while (*p == '\\') {
+      ++backslashes;
+      ++p;
+    }
+
+    if (!*p) {
+      while (backslashes--)
+        dsda_StringCat(command, "\\\\");
+      break;
+    }
+
+    if (*p == '"') {
+      while (backslashes--)
+        dsda_StringCat(command, "\\\\");
+      dsda_StringCat(command, "\\\"");
+    }
+    else {
+      char c[2] = { *p, '\0' };
+
+      while (backslashes--)
+        dsda_StringCat(command, "\\");
+      dsda_StringCat(command, c);
+    }
+  }
+
+  dsda_StringCat(command, "\"");
+}
+
+static int dsda_RunSegmentProcess(char** argv) {
+  dsda_string_t command;
+  STARTUPINFO startup_info;
+  PROCESS_INFORMATION process_info;
+  DWORD exit_code;
+  int i;
+
+  dsda_InitString(&command, NULL);
+
+  for (i = 0; argv[i]; ++i)
+    dsda_QuoteSegmentArg(&command, argv[i]);
+
+  ZeroMemory(&startup_info, sizeof(startup_info));
+  startup_info.cb = sizeof(startup_info);
+
+  if (!CreateProcess(NULL, command.string, NULL, NULL, FALSE, 0, NULL, NULL,
+                     &startup_info, &process_info)) {
+    lprintf(LO_WARN, "dsda_RunSegmentProcess: CreateProcess failed (%lu)\n",
+            (unsigned long) GetLastError());
+    dsda_FreeString(&command);
+    return -1;
+  }
+
+  dsda_FreeString(&command);
+
+  WaitForSingleObject(process_info.hProcess, INFINITE);
+
+  if (!GetExitCodeProcess(process_info.hProcess, &exit_code))
+    exit_code = (DWORD) -1;
+
+  CloseHandle(process_info.hThread);
+  CloseHandle(process_info.hProcess);
+
+  return (int) exit_code;
+}
+
+#else
+
+static int dsda_RunSegmentProcess(char** argv) {
+  pid_t pid;
+  int status;
+  int error;
+
+  error = posix_spawnp(&pid, argv[0], NULL, NULL, argv, environ);
+  if (error) {
+    lprintf(LO_WARN, "dsda_RunSegmentProcess: failed to start %s (%s)\n",
+            argv[0], strerror(error));
+    return -1;
+  }
+
+  while (waitpid(pid, &status, 0) == -1)
+    if (errno != EINTR)
+      return -1;
+
+  if (WIFEXITED(status))
+    return WEXITSTATUS(status);
+
+  return -1;
+}
+
+#endif
+
+static int dsda_SegmentThread(void* data) {
+  while (true) {
+    segment_job_t* job;
+
+    SDL_LockMutex(segment_job_mutex);
+    job = next_segment_job < segment_job_count ? &segment_jobs[next_segment_job++] : NULL;
+    SDL_UnlockMutex(segment_job_mutex);
+
+    if (!job)
+      return 0;
+
+    job->result = dsda_RunSegmentProcess(job->argv);
+  }
+}
+
+static dboolean dsda_VerifySegment(const char* filename, segment_job_t* job) {
+  FILE* file;
+  char* end_filename;
+  int tic;
+  unsigned int hash;
+  dboolean result = false;
+
+  end_filename = dsda_SegmentPartName(filename, job->start, "end");
+
+  file = M_OpenFile(end_filename, "rb");
+
+  if (!file) {
+    lprintf(LO_WARN, "Segment %d: missing end state\n", job->start);
+  }
+  else {
+    if (fscanf(file, "%d %u", &tic, &hash) != 2)
+      lprintf(LO_WARN, "Segment %d: unreadable end state\n", job->start);
+    else if (tic != job->boundary->tic || hash != job->boundary->hash)
+      lprintf(LO_WARN, "Segment %d: ended at tic %d hash %08x, expected tic %d hash %08x\n",
+              job->start, tic, hash, job->boundary->tic, job->boundary->hash);
+    else
+      result = true;
+
+    fclose(file);
+    M_remove(end_filename);
+  }
+
+  Z_Free(end_filename);
+
+  return result;
+}
+
+static dboolean dsda_AppendSegment(const char* filename, int start, dboolean skip_header) {
+  FILE* file;
+  char* part_filename;
+  char buffer[4096];
+  size_t length;
+
+  part_filename = dsda_SegmentPartName(filename, start, "part");
+
+  file = M_OpenFile(part_filename, "rb");
+
+  if (!file) {
+    lprintf(LO_WARN, "Segment %d: missing output\n", start);
+    Z_Free(part_filename);
+
+    return false;
+  }
+
+  if (skip_header) {
+    int c;
+
+    while ((c = fgetc(file)) != EOF && c != '\n');
+  }
+
+  while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    dsda_StatsWrite(buffer, length);
+
+  // Each segment is one level
+  dsda_FlushStatsStream();
+
+  fclose(file);
+  M_remove(part_filename);
+  Z_Free(part_filename);
+
+  return true;
+}
+
+int dsda_RunParallelExtraction(const char* filename) {
+  SDL_Thread** threads;
+  int thread_count;
+  int started;
+  int previous;
+  int i;
+  dboolean success = true;
+
+  if (!dsda_KeyFrameIndexLoaded())
+    I_Error("-extract_parallel requires -key_frame_index");
+
+  segment_jobs = Z_Calloc(dsda_KeyFrameIndexCount() + 1, sizeof(*segment_jobs));
+
+  previous = -1;
+  for (i = 0; i < dsda_KeyFrameIndexCount(); ++i) {
+    const dsda_key_frame_index_entry_t* entry;
+
+    entry = dsda_KeyFrameIndexEntry(i);
+
+    if (!entry->level_start || entry->tic <= 0 || entry->tic <= previous)
+      continue;
+
+    segment_jobs[segment_job_count].start = previous;
+    segment_jobs[segment_job_count].end = entry->tic;
+    segment_jobs[segment_job_count].boundary = entry;
+    ++segment_job_count;
+
+    previous = entry->tic;
+  }
+
+  segment_jobs[segment_job_count].start = previous;
+  segment_jobs[segment_job_count].end = -1;
+  ++segment_job_count;
+
+  for (i = 0; i < segment_job_count; ++i)
+    dsda_BuildSegmentArgs(&segment_jobs[i]);
+
+  thread_count = dsda_Arg(dsda_arg_extract_parallel)->value.v_int;
+  if (thread_count <= 0)
+    thread_count = SDL_GetCPUCount();
+  if (thread_count > segment_job_count)
+    thread_count = segment_job_count;
+  if (thread_count < 1)
+    thread_count = 1;
+
+  lprintf(LO_INFO, "dsda_RunParallelExtraction: %d segments on %d processes\n",
+          segment_job_count, thread_count);
+
+  segment_job_mutex = SDL_CreateMutex();
+  threads = Z_Malloc(thread_count * sizeof(*threads));
+
+  started = 0;
+  for (i = 0; i < thread_count; ++i) {
+    threads[started] = SDL_CreateThread(dsda_SegmentThread, "dsda_SegmentThread", NULL);
+
+    if (!threads[started]) {
+      lprintf(LO_WARN, "dsda_RunParallelExtraction: SDL_CreateThread failed: %s\n",
+              SDL_GetError());
+      break;
+    }
+
+    ++started;
+  }
+
+  // Whatever is left in the queue runs here if no worker thread started
+  if (!started)
+    dsda_SegmentThread(NULL);
+
+  for (i = 0; i < started; ++i)
+    SDL_WaitThread(threads[i], NULL);
+
+  Z_Free(threads);
+  SDL_DestroyMutex(segment_job_mutex);
+
+  for (i = 0; i < segment_job_count; ++i) {
+    if (segment_jobs[i].result) {
+      lprintf(LO_WARN, "Segment %d: worker exited with status %d\n",
+              segment_jobs[i].start, segment_jobs[i].result);
+      success = false;
+    }
+
+    if (segment_jobs[i].boundary && !dsda_VerifySegment(filename, &segment_jobs[i]))
+      success = false;
+  }
+
+  Z_Free(dsda_OpenStatsStream(filename, dsda_SimpleIntArg(dsda_arg_stats_compression)));
+
+  for (i = 0; i < segment_job_count; ++i)
+    if (!dsda_AppendSegment(filename, segment_jobs[i].start, i > 0))
+      success = false;
+
+  dsda_CloseStatsStream();
+
+  for (i = 0; i < segment_job_count; ++i)
+    Z_Free(segment_jobs[i].argv);
+
+  Z_Free(segment_jobs);
+
+  lprintf(LO_INFO, "dsda_RunParallelExtraction: %s\n",
+          success ? "segments joined and verified" : "segment verification failed");
+
+  return success ? 0 : 1;
+}
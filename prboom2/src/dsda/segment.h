@@ -0,0 +1,31 @@
+//
+// Copyright(C) 2023 by Ryan Krafnick
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	DSDA Segment
+//
+
+#ifndef __DSDA_SEGMENT__
+#define __DSDA_SEGMENT__
+
+#include "doomtype.h"
+
+void dsda_InitSegment(void);
+dboolean dsda_SegmentWorker(void);
+char* dsda_SegmentFileName(const char* filename);
+dboolean dsda_SegmentRow(int tic);
+void dsda_UpdateSegment(void);
+dboolean dsda_ParallelExtraction(void);
+int dsda_RunParallelExtraction(const char* filename);
+
+#endif
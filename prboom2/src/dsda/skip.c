@@ -28,12 +28,20 @@
 #include "dsda/args.h"
 #include "dsda/build.h"
 #include "dsda/features.h"
+#include "dsda/key_frame_index.h"
 #include "dsda/pause.h"
 #include "dsda/playback.h"
+#include "dsda/time.h"
 
 #include "skip.h"
 
 static dboolean skip_mode;
+static dboolean skip_frame = true;
+static dboolean skip_sound_started;
+
+// Input and the progress bar are refreshed at this wall clock rate while
+//   skipping, so the loop runs at playsim speed in between
+static const unsigned long long skip_frame_us = 1000000 / 30;
 
 static int demo_skiptics;
 static dboolean skip_until_next_map;
@@ -47,6 +55,22 @@ dboolean dsda_SkipMode(void) {
   return skip_mode;
 }
 
+void dsda_UpdateSkipModeFrame(void) {
+  if (!skip_mode) {
+    skip_frame = true;
+    return;
+  }
+
+  skip_frame = dsda_ElapsedTime(dsda_timer_skip_frame) >= skip_frame_us;
+
+  if (skip_frame)
+    dsda_StartTimer(dsda_timer_skip_frame);
+}
+
+dboolean dsda_SkipModeFrame(void) {
+  return skip_frame;
+}
+
 static void dsda_CacheSkipSetting(dboolean* old, dboolean* current) {
   *old = *current;
   *current = true;
@@ -74,8 +98,11 @@ void dsda_EnterSkipMode(void) {
   dsda_TrackFeature(uf_skip);
 
   skip_mode = true;
+  skip_sound_started = S_SoundStarted();
+  dsda_StartTimer(dsda_timer_skip_frame);
 
   M_ClearMenus();
+  S_Stop();
   dsda_ApplySkipSettings();
   dsda_ResetPauseMode();
   S_StopMusic();
@@ -87,6 +114,7 @@ void dsda_EnterSkipMode(void) {
 
 void dsda_ExitSkipMode(void) {
   skip_mode = false;
+  skip_frame = true;
 
   dsda_ResetSkipSettings();
 
@@ -99,8 +127,14 @@ void dsda_ExitSkipMode(void) {
   demo_skiptics = 0;
 
   I_Init2();
-  I_InitSound();
-  S_Init();
+
+  // Channels were stopped on entry, so running sound only needs its music
+  //   back. Sound is started here when skipping began during startup.
+  if (!skip_sound_started) {
+    I_InitSound();
+    S_Init();
+  }
+
   S_RestartMusic();
 
   if (V_IsOpenGLMode())
@@ -226,6 +260,12 @@ void dsda_HandleSkip(void) {
     skip_until_map = warpmap;
     skip_until_episode = warpepisode;
 
+    // Jump to the closest indexed key frame and play the rest
+    if (warpmap == -1 && demo_skiptics > 0 && dsda_KeyFrameIndexLoaded()) {
+      skip_until_logictic = demo_skiptics;
+      dsda_QueueKeyFrameIndexSeek(demo_skiptics);
+    }
+
     dsda_EnterSkipMode();
   }
 }
@@ -18,6 +18,8 @@
 #include "doomtype.h"
 
 dboolean dsda_SkipMode(void);
+void dsda_UpdateSkipModeFrame(void);
+dboolean dsda_SkipModeFrame(void);
 void dsda_EnterSkipMode(void);
 void dsda_ExitSkipMode(void);
 void dsda_ToggleSkipMode(void);
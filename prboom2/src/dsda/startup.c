@@ -0,0 +1,232 @@
+//
+// Copyright(C) 2023 by Ryan Krafnick
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	DSDA Startup
+//
+//  Times the phases of D_DoomMainSetup and the zone memory they use.
+//
+//  With -parallel_init, the table builds that only need the final lump
+//    directory run on worker threads. Each job is prepared on the main
+//    thread, which reads its lumps and allocates its buffers, so the
+//    worker never touches the zone, the lump cache, or the console.
+//    Without the flag, each job runs in place when its result is first
+//    needed.
+//
+
+#include "SDL.h"
+
+#include "doomtype.h"
+#include "lprintf.h"
+#include "r_data.h"
+#include "z_zone.h"
+
+#include "dsda/args.h"
+#include "dsda/memory.h"
+#include "dsda/time.h"
+#include "dsda/tranmap.h"
+
+#include "startup.h"
+
+#define MAX_STARTUP_PHASES 64
+
+typedef struct {
+  const char* name;
+  unsigned long long start;
+  unsigned long long time;
+  size_t zone;
+  long long zone_delta;
+} startup_phase_t;
+
+static startup_phase_t startup_phases[MAX_STARTUP_PHASES];
+static int startup_phase_count;
+static dboolean startup_phase_open;
+static dboolean startup_ended;
+
+typedef struct {
+  const char* name;
+  void (*prepare)(void);
+  void (*build)(void);
+  void (*finish)(void);
+  SDL_Thread* thread;
+  dboolean prepared;
+  dboolean finished;
+  dboolean worker;
+  unsigned long long start;
+  unsigned long long time;
+} startup_job_t;
+
+static startup_job_t startup_jobs[DSDA_STARTUP_JOB_COUNT] = {
+  [dsda_startup_textures] = {
+    "textures", R_PrepareTextures, R_BuildTextures, R_FinishTextures
+  },
+  [dsda_startup_sound_lumps] = {
+    "sound lumps", dsda_CacheSoundLumps, dsda_TouchSoundLumps, dsda_FreeSoundLumpTable
+  },
+  [dsda_startup_tranmap] = {
+    "tranmap", dsda_PrepareDefaultTranMap, dsda_BuildDefaultTranMap, dsda_FinishDefaultTranMap
+  },
+};
+
+static void dsda_CloseStartupPhase(void) {
+  startup_phase_t* phase;
+  size_t zone;
+
+  if (!startup_phase_open)
+    return;
+
+  phase = &startup_phases[startup_phase_count - 1];
+  zone = Z_Usage();
+
+  phase->time = dsda_ElapsedTime(dsda_timer_startup) - phase->start;
+  phase->zone_delta = (long long) zone - (long long) phase->zone;
+  phase->zone = zone;
+
+  startup_phase_open = false;
+}
+
+void dsda_StartupPhase(const char* name) {
+  startup_phase_t* phase;
+
+  if (startup_ended)
+    return;
+
+  if (!startup_phase_count)
+    dsda_StartTimer(dsda_timer_startup);
+
+  dsda_CloseStartupPhase();
+
+  if (startup_phase_count == MAX_STARTUP_PHASES)
+    return;
+
+  phase = &startup_phases[startup_phase_count++];
+  phase->name = name;
+  phase->start = dsda_ElapsedTime(dsda_timer_startup);
+  phase->zone = Z_Usage();
+
+  startup_phase_open = true;
+}
+
+static void dsda_BuildStartupJob(startup_job_t* job) {
+  job->start = dsda_ElapsedTime(dsda_timer_startup);
+  job->build();
+  job->time = dsda_ElapsedTime(dsda_timer_startup) - job->start;
+}
+
+static int dsda_StartupJobThread(void* data) {
+  dsda_BuildStartupJob(data);
+
+  return 0;
+}
+
+void dsda_StartStartupJob(dsda_startup_job_t job) {
+  startup_job_t* startup_job;
+
+  startup_job = &startup_jobs[job];
+
+  if (startup_job->prepared || !dsda_Flag(dsda_arg_parallel_init))
+    return;
+
+  startup_job->prepare();
+  startup_job->prepared = true;
+
+  startup_job->thread = SDL_CreateThread(dsda_StartupJobThread, startup_job->name, startup_job);
+
+  // The build runs in place when the job finishes
+  if (!startup_job->thread) {
+    lprintf(LO_WARN, "dsda_StartStartupJob: %s\n", SDL_GetError());
+    return;
+  }
+
+  startup_job->worker = true;
+}
+
+void dsda_FinishStartupJob(dsda_startup_job_t job) {
+  startup_job_t* startup_job;
+
+  startup_job = &startup_jobs[job];
+
+  if (startup_job->finished)
+    return;
+
+  if (!startup_job->prepared) {
+    startup_job->prepare();
+    startup_job->prepared = true;
+  }
+
+  if (startup_job->thread) {
+    SDL_WaitThread(startup_job->thread, NULL);
+    startup_job->thread = NULL;
+  }
+  else
+    dsda_BuildStartupJob(startup_job);
+
+  startup_job->finish();
+  startup_job->finished = true;
+}
+
+static void dsda_PrintStartupProfile(void) {
+  unsigned long long total;
+  int i;
+
+  total = dsda_StartupTime();
+
+  lprintf(LO_INFO, "Startup profile:\n");
+  lprintf(LO_INFO, "  %-24s %10s %10s %10s %10s\n", "phase", "start ms", "time ms", "zone KB", "delta KB");
+
+  for (i = 0; i < startup_phase_count; ++i) {
+    startup_phase_t* phase = &startup_phases[i];
+
+    lprintf(LO_INFO, "  %-24s %10.1f %10.1f %10llu %+10lld\n", phase->name,
+            phase->start / 1000.0, phase->time / 1000.0,
+            (unsigned long long) phase->zone / 1024, phase->zone_delta / 1024);
+  }
+
+  for (i = 0; i < DSDA_STARTUP_JOB_COUNT; ++i) {
+    startup_job_t* job = &startup_jobs[i];
+
+    if (!job->finished)
+      continue;
+
+    lprintf(LO_INFO, "  %-24s %10.1f %10.1f %21s\n", job->name,
+            job->start / 1000.0, job->time / 1000.0,
+            job->worker ? "(worker)" : "(in place)");
+  }
+
+  lprintf(LO_INFO, "  %-24s %10s %10.1f %10llu peak\n", "total", "",
+          total / 1000.0, (unsigned long long) Z_PeakUsage() / 1024);
+}
+
+void dsda_EndStartup(void) {
+  int i;
+
+  if (startup_ended)
+    return;
+
+  for (i = 0; i < DSDA_STARTUP_JOB_COUNT; ++i)
+    if (startup_jobs[i].prepared)
+      dsda_FinishStartupJob(i);
+
+  dsda_CloseStartupPhase();
+  startup_ended = true;
+
+  if (dsda_Flag(dsda_arg_startup_profile))
+    dsda_PrintStartupProfile();
+}
+
+unsigned long long dsda_StartupTime(void) {
+  if (!startup_phase_count)
+    return 0;
+
+  return startup_phases[startup_phase_count - 1].start + startup_phases[startup_phase_count - 1].time;
+}
@@ -0,0 +1,34 @@
+//
+// Copyright(C) 2023 by Ryan Krafnick
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	DSDA Startup
+//
+
+#ifndef __DSDA_STARTUP__
+#define __DSDA_STARTUP__
+
+typedef enum {
+  dsda_startup_textures,
+  dsda_startup_sound_lumps,
+  dsda_startup_tranmap,
+  DSDA_STARTUP_JOB_COUNT
+} dsda_startup_job_t;
+
+void dsda_StartupPhase(const char* name);
+void dsda_StartStartupJob(dsda_startup_job_t job);
+void dsda_FinishStartupJob(dsda_startup_job_t job);
+void dsda_EndStartup(void);
+unsigned long long dsda_StartupTime(void);
+
+#endif
@@ -0,0 +1,298 @@
+//
+// Copyright(C) 2023 by Ryan Krafnick
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	DSDA State Hash
+//
+//  Hash of the sync-relevant game state, comparable across processes
+//    and builds. Each component is hashed separately so that a desync
+//    can be attributed to the part of the state that diverged first.
+//
+
+#include <stdio.h>
+
+#include "doomstat.h"
+#include "lprintf.h"
+#include "m_file.h"
+#include "m_random.h"
+#include "p_mobj.h"
+#include "p_tick.h"
+#include "r_state.h"
+#include "w_wad.h"
+#include "z_zone.h"
+
+#include "dsda/brute_force.h"
+
+#include "state_hash.h"
+
+#define DSDA_STATE_HASH_VERSION 1
+
+// xxHash32 constants
+#define HASH_PRIME1 2654435761u
+#define HASH_PRIME2 2246822519u
+#define HASH_PRIME3 3266489917u
+#define HASH_PRIME5 374761393u
+
+#define HASH_ROTL(x, r) (((x) << (r)) | ((x) >> (32 - (r))))
+
+static FILE* state_hash_export;
+static int state_hash_last_tic = -1;
+
+static const char* state_hash_component_names[state_hash_count] = {
+  [state_hash_rng] = "rng",
+  [state_hash_players] = "players",
+  [state_hash_mobjs] = "mobjs",
+  [state_hash_sectors] = "sectors",
+};
+
+static inline void dsda_HashInt(unsigned int* hash, int value) {
+  *hash += (unsigned int) value * HASH_PRIME3;
+  *hash = HASH_ROTL(*hash, 17) * HASH_PRIME1;
+}
+
+static unsigned int dsda_FinalizeHash(unsigned int hash) {
+  hash ^= hash >> 15;
+  hash *= HASH_PRIME2;
+  hash ^= hash >> 13;
+  hash *= HASH_PRIME3;
+  hash ^= hash >> 16;
+
+  return hash;
+}
+
+static unsigned int dsda_HashRNG(void) {
+  unsigned int hash = HASH_PRIME5;
+  int i;
+
+  dsda_HashInt(&hash, rng.rndindex);
+  dsda_HashInt(&hash, rng.prndindex);
+  for (i = 0; i < NUMPRCLASS; ++i)
+    dsda_HashInt(&hash, rng.seed[i]);
+
+  return dsda_FinalizeHash(hash);
+}
+
+static unsigned int dsda_HashPlayers(void) {
+  unsigned int hash = HASH_PRIME5;
+  int i;
+
+  dsda_HashInt(&hash, gameepisode);
+  dsda_HashInt(&hash, gamemap);
+  dsda_HashInt(&hash, leveltime);
+
+  for (i = 0; i < g_maxplayers; ++i) {
+    player_t* player;
+
+    if (!playeringame[i])
+      continue;
+
+    player = &players[i];
+
+    dsda_HashInt(&hash, player->health);
+    dsda_HashInt(&hash, player->killcount);
+    dsda_HashInt(&hash, player->itemcount);
+    dsda_HashInt(&hash, player->secretcount);
+
+    if (player->mo) {
+      dsda_HashInt(&hash, player->mo->x);
+      dsda_HashInt(&hash, player->mo->y);
+      dsda_HashInt(&hash, player->mo->z);
+      dsda_HashInt(&hash, player->mo->momx);
+      dsda_HashInt(&hash, player->mo->momy);
+      dsda_HashInt(&hash, player->mo->momz);
+      dsda_HashInt(&hash, player->mo->angle);
+    }
+  }
+
+  return dsda_FinalizeHash(hash);
+}
+
+static unsigned int dsda_HashMobjs(void) {
+  thinker_t* th;
+  unsigned int hash = HASH_PRIME5;
+
+  for (th = thinkercap.next; th != &thinkercap; th = th->next) {
+    mobj_t* mo;
+
+    if (th->function != P_MobjThinker && th->function != P_BlasterMobjThinker)
+      continue;
+
+    mo = (mobj_t*) th;
+
+    dsda_HashInt(&hash, mo->type);
+    dsda_HashInt(&hash, mo->x);
+    dsda_HashInt(&hash, mo->y);
+    dsda_HashInt(&hash, mo->z);
+    dsda_HashInt(&hash, mo->momx);
+    dsda_HashInt(&hash, mo->momy);
+    dsda_HashInt(&hash, mo->momz);
+    dsda_HashInt(&hash, mo->angle);
+    dsda_HashInt(&hash, mo->health);
+  }
+
+  return dsda_FinalizeHash(hash);
+}
+
+static unsigned int dsda_HashSectors(void) {
+  unsigned int hash = HASH_PRIME5;
+  int i;
+
+  for (i = 0; i < numsectors; ++i) {
+    dsda_HashInt(&hash, sectors[i].floorheight);
+    dsda_HashInt(&hash, sectors[i].ceilingheight);
+  }
+
+  return dsda_FinalizeHash(hash);
+}
+
+void dsda_StateHashComponents(unsigned int* hashes) {
+  hashes[state_hash_rng] = dsda_HashRNG();
+  hashes[state_hash_players] = dsda_HashPlayers();
+  hashes[state_hash_mobjs] = dsda_HashMobjs();
+  hashes[state_hash_sectors] = dsda_HashSectors();
+}
+
+unsigned int dsda_StateHash(void) {
+  unsigned int hashes[state_hash_count];
+  unsigned int hash = HASH_PRIME5;
+  int i;
+
+  dsda_StateHashComponents(hashes);
+
+  for (i = 0; i < state_hash_count; ++i)
+    dsda_HashInt(&hash, hashes[i]);
+
+  return dsda_FinalizeHash(hash);
+}
+
+static char* dsda_StateHashFileName(const char* name) {
+  char* filename;
+
+  filename = Z_Malloc(strlen(name) + 4 + 1);
+  AddDefaultExtension(strcpy(filename, name), ".hsh");
+
+  return filename;
+}
+
+void dsda_InitStateHashExport(const char* name) {
+  int version;
+  char* filename;
+
+  filename = dsda_StateHashFileName(name);
+
+  state_hash_export = M_OpenFile(filename, "wb");
+
+  if (state_hash_export == NULL)
+    I_Error("dsda_InitStateHashExport: failed to open %s", filename);
+
+  version = DSDA_STATE_HASH_VERSION;
+  fwrite(&version, sizeof(int), 1, state_hash_export);
+
+  Z_Free(filename);
+}
+
+// Record layout: tic, then one hash per component
+// Tics are strictly increasing and each one is written once, when it is
+//   first completed. Tics replayed after a rewind or key frame restore are
+//   not written again, and nothing is written while brute force searches.
+void dsda_ExportStateHash(void) {
+  unsigned int record[1 + state_hash_count];
+
+  if (!state_hash_export || dsda_BruteForce() || true_logictic <= state_hash_last_tic)
+    return;
+
+  state_hash_last_tic = true_logictic;
+
+  record[0] = true_logictic;
+  dsda_StateHashComponents(&record[1]);
+
+  fwrite(record, sizeof(record), 1, state_hash_export);
+}
+
+static FILE* dsda_OpenStateHash(const char* name) {
+  FILE* file;
+  char* filename;
+  int version;
+
+  filename = dsda_StateHashFileName(name);
+
+  file = M_OpenFile(filename, "rb");
+
+  if (file == NULL)
+    I_Error("dsda_CompareStateHash: failed to open %s", filename);
+
+  if (fread(&version, sizeof(int), 1, file) != 1 || version != DSDA_STATE_HASH_VERSION)
+    I_Error("dsda_CompareStateHash: unsupported version %s", filename);
+
+  Z_Free(filename);
+
+  return file;
+}
+
+// Returns 0 when the streams match, 1 otherwise
+int dsda_CompareStateHash(const char* name_a, const char* name_b) {
+  FILE* file_a;
+  FILE* file_b;
+  unsigned int record_a[1 + state_hash_count];
+  unsigned int record_b[1 + state_hash_count];
+  dboolean end_a, end_b;
+  int count = 0;
+  int result = 0;
+
+  file_a = dsda_OpenStateHash(name_a);
+  file_b = dsda_OpenStateHash(name_b);
+
+  while (true) {
+    int i;
+
+    end_a = fread(record_a, sizeof(record_a), 1, file_a) != 1;
+    end_b = fread(record_b, sizeof(record_b), 1, file_b) != 1;
+
+    if (end_a || end_b)
+      break;
+
+    if (!memcmp(record_a, record_b, sizeof(record_a))) {
+      ++count;
+      continue;
+    }
+
+    if (record_a[0] != record_b[0]) {
+      lprintf(LO_INFO, "Tic mismatch at record %d: %u vs %u\n", count, record_a[0], record_b[0]);
+    }
+    else {
+      lprintf(LO_INFO, "First desync at tic %u:", record_a[0]);
+      for (i = 0; i < state_hash_count; ++i)
+        if (record_a[i + 1] != record_b[i + 1])
+          lprintf(LO_INFO, " %s", state_hash_component_names[i]);
+      lprintf(LO_INFO, "\n");
+    }
+
+    result = 1;
+    break;
+  }
+
+  if (!result) {
+    if (end_a != end_b) {
+      lprintf(LO_INFO, "Streams match for %d tics, but %s ends first\n",
+              count, end_a ? name_a : name_b);
+      result = 1;
+    }
+    else
+      lprintf(LO_INFO, "Streams match for %d tics\n", count);
+  }
+
+  fclose(file_a);
+  fclose(file_b);
+
+  return result;
+}
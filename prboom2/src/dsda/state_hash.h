@@ -0,0 +1,35 @@
+//
+// Copyright(C) 2023 by Ryan Krafnick
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	DSDA State Hash
+//
+
+#ifndef __DSDA_STATE_HASH__
+#define __DSDA_STATE_HASH__
+
+typedef enum {
+  state_hash_rng,
+  state_hash_players,
+  state_hash_mobjs,
+  state_hash_sectors,
+  state_hash_count,
+} state_hash_component_t;
+
+void dsda_StateHashComponents(unsigned int* hashes);
+unsigned int dsda_StateHash(void);
+void dsda_InitStateHashExport(const char* name);
+void dsda_ExportStateHash(void);
+int dsda_CompareStateHash(const char* name_a, const char* name_b);
+
+#endif
@@ -0,0 +1,369 @@
+//
+// Copyright(C) 2023 by Ryan Krafnick
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	DSDA Stats Stream
+//
+//  Extraction output is formatted into blocks on the game thread and
+//    handed to a writer thread, which optionally gzips them. Flushes at
+//    level boundaries end a deflate block, so a truncated file still
+//    decompresses up to the last completed level. If the writer thread
+//    can't be started, blocks are written on the game thread instead.
+//
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "SDL.h"
+
+#include "lprintf.h"
+#include "m_file.h"
+#include "z_zone.h"
+
+#include "stats_stream.h"
+
+#define STATS_BLOCK_SIZE (1 << 20)
+#define STATS_MAX_QUEUED 8
+
+typedef struct stats_block_s {
+  struct stats_block_s* next;
+  size_t length;
+  dboolean flush;
+  char data[STATS_BLOCK_SIZE];
+} stats_block_t;
+
+static FILE* stats_output;
+static int stats_level;
+static z_stream stats_zstream;
+static unsigned char* stats_zbuffer;
+
+static stats_block_t* stats_block;
+static stats_block_t* stats_queue_head;
+static stats_block_t* stats_queue_tail;
+static int stats_queued;
+static dboolean stats_done;
+
+// Set by the writer on the first failed write; reported on the game thread
+static const char* stats_error;
+static dboolean stats_error_reported;
+
+static SDL_Thread* stats_thread;
+static SDL_mutex* stats_mutex;
+static SDL_cond* stats_cond;
+
+// Each writer returns an error description, or NULL on success
+static const char* dsda_DeflateStats(const void* data, size_t length, int flush) {
+  stats_zstream.next_in = (Bytef*) data;
+  stats_zstream.avail_in = (uInt) length;
+
+  do {
+    size_t count;
+
+    stats_zstream.next_out = stats_zbuffer;
+    stats_zstream.avail_out = STATS_BLOCK_SIZE;
+
+    if (deflate(&stats_zstream, flush) == Z_STREAM_ERROR)
+      return "compression failed";
+
+    count = STATS_BLOCK_SIZE - stats_zstream.avail_out;
+
+    if (fwrite(stats_zbuffer, 1, count, stats_output) != count)
+      return "write failed";
+  } while (stats_zstream.avail_out == 0);
+
+  return NULL;
+}
+
+static const char* dsda_WriteStatsBlock(stats_block_t* block) {
+  const char* error;
+
+  if (stats_level)
+    error = dsda_DeflateStats(block->data, block->length, block->flush ? Z_FULL_FLUSH : Z_NO_FLUSH);
+  else if (fwrite(block->data, 1, block->length, stats_output) != block->length)
+    error = "write failed";
+  else
+    error = NULL;
+
+  if (!error && block->flush && fflush(stats_output))
+    error = "flush failed";
+
+  return error;
+}
+
+static void dsda_ReportStatsError(void) {
+  if (stats_error && !stats_error_reported) {
+    lprintf(LO_WARN, "dsda_StatsStream: %s, no further output is written\n", stats_error);
+    stats_error_reported = true;
+  }
+}
+
+static int dsda_StatsThread(void* data) {
+  while (true) {
+    stats_block_t* block;
+    const char* error;
+
+    SDL_LockMutex(stats_mutex);
+
+    while (!stats_queue_head && !stats_done)
+      SDL_CondWait(stats_cond, stats_mutex);
+
+    block = stats_queue_head;
+
+    if (block) {
+      stats_queue_head = block->next;
+      if (!stats_queue_head)
+        stats_queue_tail = NULL;
+      --stats_queued;
+      SDL_CondSignal(stats_cond);
+    }
+
+    error = stats_error;
+
+    SDL_UnlockMutex(stats_mutex);
+
+    if (!block)
+      return 0;
+
+    if (!error) {
+      error = dsda_WriteStatsBlock(block);
+
+      if (error) {
+        SDL_LockMutex(stats_mutex);
+        stats_error = error;
+        SDL_UnlockMutex(stats_mutex);
+      }
+    }
+
+    free(block);
+  }
+}
+
+// Blocks are malloc'd because the writer thread frees them
+static stats_block_t* dsda_NewStatsBlock(void) {
+  stats_block_t* block;
+
+  block = malloc(sizeof(*block));
+
+  if (!block)
+    I_Error("dsda_NewStatsBlock: out of memory");
+
+  block->next = NULL;
+  block->length = 0;
+  block->flush = false;
+
+  return block;
+}
+
+static void dsda_QueueStatsBlock(dboolean flush) {
+  stats_block->flush = flush;
+
+  if (!stats_thread) {
+    if (!stats_error)
+      stats_error = dsda_WriteStatsBlock(stats_block);
+
+    dsda_ReportStatsError();
+
+    stats_block->length = 0;
+    stats_block->flush = false;
+
+    return;
+  }
+
+  SDL_LockMutex(stats_mutex);
+
+  // Output stopped at the first failure, so drop the block
+  if (stats_error) {
+    dsda_ReportStatsError();
+    SDL_UnlockMutex(stats_mutex);
+
+    stats_block->length = 0;
+
+    return;
+  }
+
+  // Keep memory bounded if the disk can't keep up
+  while (stats_queued >= STATS_MAX_QUEUED)
+    SDL_CondWait(stats_cond, stats_mutex);
+
+  if (stats_queue_tail)
+    stats_queue_tail->next = stats_block;
+  else
+    stats_queue_head = stats_block;
+  stats_queue_tail = stats_block;
+  ++stats_queued;
+
+  SDL_CondSignal(stats_cond);
+  SDL_UnlockMutex(stats_mutex);
+
+  stats_block = dsda_NewStatsBlock();
+}
+
+char* dsda_OpenStatsStream(const char* filename, int level) {
+  char* stream_filename;
+
+  stream_filename = Z_Malloc(strlen(filename) + 4);
+  strcpy(stream_filename, filename);
+  if (level)
+    strcat(stream_filename, ".gz");
+
+  stats_output = M_OpenFile(stream_filename, "wb");
+
+  if (!stats_output)
+    I_Error("dsda_OpenStatsStream: failed to open %s", stream_filename);
+
+  stats_level = level;
+
+  if (stats_level) {
+    memset(&stats_zstream, 0, sizeof(stats_zstream));
+
+    // 16 + MAX_WBITS selects the gzip wrapper
+    if (deflateInit2(&stats_zstream, stats_level, Z_DEFLATED,
+                     16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+      I_Error("dsda_OpenStatsStream: failed to initialize compression");
+
+    stats_zbuffer = malloc(STATS_BLOCK_SIZE);
+
+    if (!stats_zbuffer)
+      I_Error("dsda_OpenStatsStream: out of memory");
+  }
+
+  stats_block = dsda_NewStatsBlock();
+  stats_done = false;
+  stats_error = NULL;
+  stats_error_reported = false;
+
+  stats_mutex = SDL_CreateMutex();
+  stats_cond = SDL_CreateCond();
+  stats_thread = NULL;
+
+  if (stats_mutex && stats_cond)
+    stats_thread = SDL_CreateThread(dsda_StatsThread, "dsda_StatsThread", NULL);
+
+  if (!stats_thread) {
+    lprintf(LO_WARN, "dsda_OpenStatsStream: writing on the game thread (%s)\n", SDL_GetError());
+
+    if (stats_cond)
+      SDL_DestroyCond(stats_cond);
+    if (stats_mutex)
+      SDL_DestroyMutex(stats_mutex);
+
+    stats_cond = NULL;
+    stats_mutex = NULL;
+  }
+
+  return stream_filename;
+}
+
+void dsda_StatsWrite(const void* data, size_t length) {
+  const char* source = data;
+
+  while (length) {
+    size_t chunk;
+
+    chunk = STATS_BLOCK_SIZE - stats_block->length;
+    if (chunk > length)
+      chunk = length;
+
+    memcpy(stats_block->data + stats_block->length, source, chunk);
+    stats_block->length += chunk;
+    source += chunk;
+    length -= chunk;
+
+    if (stats_block->length == STATS_BLOCK_SIZE)
+      dsda_QueueStatsBlock(false);
+  }
+}
+
+void dsda_StatsPrintf(const char* format, ...) {
+  va_list v;
+  int length;
+  size_t available;
+
+  available = STATS_BLOCK_SIZE - stats_block->length;
+
+  va_start(v, format);
+  length = vsnprintf(stats_block->data + stats_block->length, available, format, v);
+  va_end(v);
+
+  if (length < 0)
+    return;
+
+  if ((size_t) length < available) {
+    stats_block->length += length;
+    return;
+  }
+
+  // Row didn't fit in the current block
+  {
+    char* row;
+
+    row = Z_Malloc(length + 1);
+
+    va_start(v, format);
+    vsnprintf(row, length + 1, format, v);
+    va_end(v);
+
+    dsda_StatsWrite(row, length);
+    Z_Free(row);
+  }
+}
+
+void dsda_FlushStatsStream(void) {
+  if (!stats_output)
+    return;
+
+  dsda_QueueStatsBlock(true);
+}
+
+void dsda_CloseStatsStream(void) {
+  if (!stats_output)
+    return;
+
+  dsda_QueueStatsBlock(true);
+
+  if (stats_thread) {
+    SDL_LockMutex(stats_mutex);
+    stats_done = true;
+    SDL_CondSignal(stats_cond);
+    SDL_UnlockMutex(stats_mutex);
+
+    SDL_WaitThread(stats_thread, NULL);
+    stats_thread = NULL;
+
+    SDL_DestroyCond(stats_cond);
+    SDL_DestroyMutex(stats_mutex);
+    stats_cond = NULL;
+    stats_mutex = NULL;
+  }
+
+  free(stats_block);
+  stats_block = NULL;
+
+  if (stats_level) {
+    if (!stats_error)
+      stats_error = dsda_DeflateStats(NULL, 0, Z_FINISH);
+
+    deflateEnd(&stats_zstream);
+    free(stats_zbuffer);
+    stats_zbuffer = NULL;
+  }
+
+  if (fclose(stats_output) && !stats_error)
+    stats_error = "close failed";
+  stats_output = NULL;
+
+  dsda_ReportStatsError();
+}
@@ -0,0 +1,29 @@
+//
+// Copyright(C) 2023 by Ryan Krafnick
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	DSDA Stats Stream
+//
+
+#ifndef __DSDA_STATS_STREAM__
+#define __DSDA_STATS_STREAM__
+
+#include <stddef.h>
+
+char* dsda_OpenStatsStream(const char* filename, int level);
+void dsda_StatsWrite(const void* data, size_t length);
+void dsda_StatsPrintf(const char* format, ...) __attribute__((format(printf,1,2)));
+void dsda_FlushStatsStream(void);
+void dsda_CloseStatsStream(void);
+
+#endif
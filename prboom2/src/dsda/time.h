@@ -24,6 +24,13 @@ typedef enum {
   dsda_timer_key_frame,
   dsda_timer_brute_force,
   dsda_timer_render_stats,
+  dsda_timer_view_layout,
+  dsda_timer_benchmark_frame,
+  dsda_timer_benchmark_tic,
+  dsda_timer_dehacked,
+  dsda_timer_startup,
+  dsda_timer_skip_frame,
+  dsda_timer_archive_benchmark,
   dsda_timer_temp,
   DSDA_TIMER_COUNT
 } dsda_timer_t;
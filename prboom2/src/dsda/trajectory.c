@@ -0,0 +1,489 @@
+//
+// Copyright(C) 2023 by Ryan Krafnick
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	DSDA Trajectory
+//
+//  Compact per-tic stream of every mobj's position and state.
+//  Records are an opcode byte followed by varint fields.
+//  Positions and angles are written as zigzag deltas from the previous tic,
+//    and only when they change.
+//
+
+#include <stdio.h>
+
+#include "doomstat.h"
+#include "i_system.h"
+#include "info.h"
+#include "lprintf.h"
+#include "m_file.h"
+#include "p_mobj.h"
+#include "p_tick.h"
+#include "w_wad.h"
+#include "z_zone.h"
+
+#include "dsda/utility.h"
+
+#include "trajectory.h"
+
+#define DSDA_TRAJECTORY_VERSION 1
+
+typedef enum {
+  trj_tic = 1,
+  trj_level,
+  trj_spawn,
+  trj_update,
+  trj_despawn,
+} trj_record_t;
+
+#define TRJ_X     0x01
+#define TRJ_Y     0x02
+#define TRJ_Z     0x04
+#define TRJ_ANGLE 0x08
+#define TRJ_STATE 0x10
+
+typedef struct {
+  fixed_t x;
+  fixed_t y;
+  fixed_t z;
+  angle_t angle;
+  int state;
+  int type;
+  int stamp;
+  int live_index;
+  dboolean live;
+} trj_mobj_t;
+
+typedef struct {
+  trj_mobj_t* mobjs;
+  int size;
+  int* live;
+  int live_count;
+  int live_size;
+} trj_table_t;
+
+typedef struct {
+  byte* data;
+  size_t length;
+  size_t size;
+} trj_buffer_t;
+
+static FILE* trj_file;
+static trj_buffer_t trj_buffer;
+static trj_table_t trj_export;
+static int trj_id_count;
+static int trj_stamp;
+static int trj_gametic;
+static int trj_leveltime;
+static int trj_map = -1;
+static int trj_episode = -1;
+
+static trj_mobj_t* dsda_TrajectoryMobj(trj_table_t* table, int id) {
+  if (id >= table->size) {
+    int old_size = table->size;
+
+    table->size = table->size ? table->size * 2 : 256;
+    while (id >= table->size)
+      table->size *= 2;
+
+    table->mobjs = Z_Realloc(table->mobjs, table->size * sizeof(*table->mobjs));
+    memset(table->mobjs + old_size, 0, (table->size - old_size) * sizeof(*table->mobjs));
+  }
+
+  return &table->mobjs[id];
+}
+
+static void dsda_AddLiveTrajectory(trj_table_t* table, int id) {
+  trj_mobj_t* entry;
+
+  if (table->live_count == table->live_size) {
+    table->live_size = table->live_size ? table->live_size * 2 : 256;
+    table->live = Z_Realloc(table->live, table->live_size * sizeof(*table->live));
+  }
+
+  entry = &table->mobjs[id];
+  entry->live = true;
+  entry->live_index = table->live_count;
+  table->live[table->live_count++] = id;
+}
+
+static void dsda_RemoveLiveTrajectory(trj_table_t* table, int id) {
+  trj_mobj_t* entry;
+  int last_id;
+
+  entry = &table->mobjs[id];
+  last_id = table->live[--table->live_count];
+  table->live[entry->live_index] = last_id;
+  table->mobjs[last_id].live_index = entry->live_index;
+  entry->live = false;
+}
+
+static void dsda_ClearTrajectories(trj_table_t* table) {
+  int i;
+
+  for (i = 0; i < table->live_count; ++i)
+    table->mobjs[table->live[i]].live = false;
+
+  table->live_count = 0;
+}
+
+static void dsda_WriteTrajectoryByte(byte value) {
+  if (trj_buffer.length == trj_buffer.size) {
+    trj_buffer.size = trj_buffer.size ? trj_buffer.size * 2 : 4096;
+    trj_buffer.data = Z_Realloc(trj_buffer.data, trj_buffer.size);
+  }
+
+  trj_buffer.data[trj_buffer.length++] = value;
+}
+
+static void dsda_WriteTrajectoryVarInt(unsigned int value) {
+  while (value >= 0x80) {
+    dsda_WriteTrajectoryByte((byte) (value | 0x80));
+    value >>= 7;
+  }
+
+  dsda_WriteTrajectoryByte((byte) value);
+}
+
+static void dsda_WriteTrajectorySignedVarInt(int value) {
+  dsda_WriteTrajectoryVarInt(((unsigned int) value << 1) ^ (unsigned int) (value >> 31));
+}
+
+static unsigned int dsda_ReadTrajectoryVarInt(const byte** p, const byte* end) {
+  unsigned int value = 0;
+  int shift = 0;
+
+  do {
+    if (*p >= end || shift > 28)
+      I_Error("dsda_ReadTrajectoryVarInt: corrupt trajectory file");
+
+    value |= (unsigned int) (**p & 0x7f) << shift;
+    shift += 7;
+  } while (*(*p)++ & 0x80);
+
+  return value;
+}
+
+static int dsda_ReadTrajectorySignedVarInt(const byte** p, const byte* end) {
+  unsigned int value;
+
+  value = dsda_ReadTrajectoryVarInt(p, end);
+
+  return (int) (value >> 1) ^ -(int) (value & 1);
+}
+
+static int dsda_TrajectoryState(mobj_t* mo) {
+  return mo->state ? mo->state - states : 0;
+}
+
+static dboolean dsda_IsTrajectoryThinker(thinker_t* th) {
+  return th->function == P_MobjThinker || th->function == P_BlasterMobjThinker;
+}
+
+void dsda_InitTrajectoryExport(const char* name) {
+  int version;
+  char* filename;
+
+  filename = Z_Malloc(strlen(name) + 4 + 1);
+  AddDefaultExtension(strcpy(filename, name), ".trj");
+
+  trj_file = M_OpenFile(filename, "wb");
+
+  if (trj_file == NULL)
+    I_Error("dsda_InitTrajectoryExport: failed to open %s", filename);
+
+  version = DSDA_TRAJECTORY_VERSION;
+  fwrite(&version, sizeof(int), 1, trj_file);
+
+  Z_Free(filename);
+
+  I_AtExit(dsda_CloseTrajectoryExport, true, "dsda_CloseTrajectoryExport", exit_priority_normal);
+}
+
+void dsda_CloseTrajectoryExport(void) {
+  if (trj_file == NULL)
+    return;
+
+  if (trj_buffer.length)
+    fwrite(trj_buffer.data, 1, trj_buffer.length, trj_file);
+  trj_buffer.length = 0;
+
+  if (fclose(trj_file))
+    lprintf(LO_WARN, "dsda_CloseTrajectoryExport: failed to close trajectory file\n");
+
+  trj_file = NULL;
+}
+
+static void dsda_StartTrajectoryLevel(void) {
+  thinker_t* th;
+
+  dsda_ClearTrajectories(&trj_export);
+
+  // Mobjs restored from a key frame keep their ids
+  trj_id_count = 0;
+  for (th = thinkercap.next; th != &thinkercap; th = th->next)
+    if (dsda_IsTrajectoryThinker(th) && ((mobj_t*) th)->trajectory_id > trj_id_count)
+      trj_id_count = ((mobj_t*) th)->trajectory_id;
+
+  trj_map = gamemap;
+  trj_episode = gameepisode;
+
+  dsda_WriteTrajectoryByte(trj_level);
+  dsda_WriteTrajectoryVarInt(gameepisode);
+  dsda_WriteTrajectoryVarInt(gamemap);
+}
+
+static void dsda_ExportTrajectorySpawn(mobj_t* mo, trj_mobj_t* entry) {
+  entry->x = mo->x;
+  entry->y = mo->y;
+  entry->z = mo->z;
+  entry->angle = mo->angle;
+  entry->state = dsda_TrajectoryState(mo);
+  entry->type = mo->type;
+
+  dsda_AddLiveTrajectory(&trj_export, mo->trajectory_id);
+
+  dsda_WriteTrajectoryByte(trj_spawn);
+  dsda_WriteTrajectoryVarInt(mo->trajectory_id);
+  dsda_WriteTrajectorySignedVarInt(entry->type);
+  dsda_WriteTrajectorySignedVarInt(entry->x);
+  dsda_WriteTrajectorySignedVarInt(entry->y);
+  dsda_WriteTrajectorySignedVarInt(entry->z);
+  dsda_WriteTrajectoryVarInt(entry->angle);
+  dsda_WriteTrajectoryVarInt(entry->state);
+}
+
+static void dsda_ExportTrajectoryUpdate(mobj_t* mo, trj_mobj_t* entry) {
+  int state;
+  byte mask = 0;
+
+  state = dsda_TrajectoryState(mo);
+
+  if (mo->x != entry->x) mask |= TRJ_X;
+  if (mo->y != entry->y) mask |= TRJ_Y;
+  if (mo->z != entry->z) mask |= TRJ_Z;
+  if (mo->angle != entry->angle) mask |= TRJ_ANGLE;
+  if (state != entry->state) mask |= TRJ_STATE;
+
+  if (!mask)
+    return;
+
+  dsda_WriteTrajectoryByte(trj_update);
+  dsda_WriteTrajectoryVarInt(mo->trajectory_id);
+  dsda_WriteTrajectoryByte(mask);
+
+  if (mask & TRJ_X)
+    dsda_WriteTrajectorySignedVarInt(mo->x - entry->x);
+
+  if (mask & TRJ_Y)
+    dsda_WriteTrajectorySignedVarInt(mo->y - entry->y);
+
+  if (mask & TRJ_Z)
+    dsda_WriteTrajectorySignedVarInt(mo->z - entry->z);
+
+  if (mask & TRJ_ANGLE)
+    dsda_WriteTrajectorySignedVarInt((int) (mo->angle - entry->angle));
+
+  if (mask & TRJ_STATE)
+    dsda_WriteTrajectoryVarInt(state);
+
+  entry->x = mo->x;
+  entry->y = mo->y;
+  entry->z = mo->z;
+  entry->angle = mo->angle;
+  entry->state = state;
+}
+
+void dsda_ExportTrajectoryFrame(void) {
+  thinker_t* th;
+  int i;
+
+  if (trj_file == NULL || gamestate != GS_LEVEL)
+    return;
+
+  dsda_WriteTrajectoryByte(trj_tic);
+  dsda_WriteTrajectoryVarInt(gametic - trj_gametic);
+  trj_gametic = gametic;
+
+  if (gamemap != trj_map || gameepisode != trj_episode || leveltime < trj_leveltime)
+    dsda_StartTrajectoryLevel();
+
+  trj_leveltime = leveltime;
+
+  ++trj_stamp;
+
+  for (th = thinkercap.next; th != &thinkercap; th = th->next) {
+    mobj_t* mo;
+    trj_mobj_t* entry;
+
+    if (!dsda_IsTrajectoryThinker(th))
+      continue;
+
+    mo = (mobj_t*) th;
+
+    if (!mo->trajectory_id)
+      mo->trajectory_id = ++trj_id_count;
+
+    entry = dsda_TrajectoryMobj(&trj_export, mo->trajectory_id);
+
+    if (entry->live)
+      dsda_ExportTrajectoryUpdate(mo, entry);
+    else
+      dsda_ExportTrajectorySpawn(mo, entry);
+
+    entry->stamp = trj_stamp;
+  }
+
+  // Anything we didn't visit is gone (removed thinkers no longer count as mobjs)
+  for (i = trj_export.live_count - 1; i >= 0; --i) {
+    int id = trj_export.live[i];
+
+    if (trj_export.mobjs[id].stamp != trj_stamp) {
+      dsda_RemoveLiveTrajectory(&trj_export, id);
+
+      dsda_WriteTrajectoryByte(trj_despawn);
+      dsda_WriteTrajectoryVarInt(id);
+    }
+  }
+
+  fwrite(trj_buffer.data, 1, trj_buffer.length, trj_file);
+  trj_buffer.length = 0;
+}
+
+void dsda_DumpTrajectory(const char* name, int tic) {
+  byte* buffer;
+  const byte* p;
+  const byte* end;
+  char* filename;
+  FILE* output;
+  trj_table_t table = { 0 };
+  int length;
+  int version;
+  int current_tic = 0;
+  int episode = 0;
+  int map = 0;
+  int id;
+
+  filename = Z_Malloc(strlen(name) + 4 + 1);
+  AddDefaultExtension(strcpy(filename, name), ".trj");
+
+  length = M_ReadFile(filename, &buffer);
+  if (length < (int) sizeof(int))
+    I_Error("dsda_DumpTrajectory: failed to read %s", filename);
+
+  memcpy(&version, buffer, sizeof(int));
+  if (version != DSDA_TRAJECTORY_VERSION)
+    I_Error("dsda_DumpTrajectory: unsupported trajectory version %s", filename);
+
+  p = buffer + sizeof(int);
+  end = buffer + length;
+
+  while (p < end) {
+    trj_mobj_t* entry;
+    byte record;
+    byte mask;
+
+    record = *p++;
+
+    if (record == trj_tic) {
+      int next_tic;
+
+      next_tic = current_tic + dsda_ReadTrajectoryVarInt(&p, end);
+      if (next_tic > tic)
+        break;
+
+      current_tic = next_tic;
+      continue;
+    }
+
+    switch (record) {
+      case trj_level:
+        dsda_ClearTrajectories(&table);
+        episode = dsda_ReadTrajectoryVarInt(&p, end);
+        map = dsda_ReadTrajectoryVarInt(&p, end);
+        break;
+      case trj_spawn:
+        id = dsda_ReadTrajectoryVarInt(&p, end);
+        entry = dsda_TrajectoryMobj(&table, id);
+        entry->type = dsda_ReadTrajectorySignedVarInt(&p, end);
+        entry->x = dsda_ReadTrajectorySignedVarInt(&p, end);
+        entry->y = dsda_ReadTrajectorySignedVarInt(&p, end);
+        entry->z = dsda_ReadTrajectorySignedVarInt(&p, end);
+        entry->angle = dsda_ReadTrajectoryVarInt(&p, end);
+        entry->state = dsda_ReadTrajectoryVarInt(&p, end);
+        if (!entry->live)
+          dsda_AddLiveTrajectory(&table, id);
+        break;
+      case trj_update:
+        id = dsda_ReadTrajectoryVarInt(&p, end);
+        if (id >= table.size || !table.mobjs[id].live || p >= end)
+          I_Error("dsda_DumpTrajectory: corrupt trajectory file %s", filename);
+        entry = &table.mobjs[id];
+        mask = *p++;
+        if (mask & TRJ_X)
+          entry->x += dsda_ReadTrajectorySignedVarInt(&p, end);
+        if (mask & TRJ_Y)
+          entry->y += dsda_ReadTrajectorySignedVarInt(&p, end);
+        if (mask & TRJ_Z)
+          entry->z += dsda_ReadTrajectorySignedVarInt(&p, end);
+        if (mask & TRJ_ANGLE)
+          entry->angle += dsda_ReadTrajectorySignedVarInt(&p, end);
+        if (mask & TRJ_STATE)
+          entry->state = dsda_ReadTrajectoryVarInt(&p, end);
+        break;
+      case trj_despawn:
+        id = dsda_ReadTrajectoryVarInt(&p, end);
+        if (id >= table.size || !table.mobjs[id].live)
+          I_Error("dsda_DumpTrajectory: corrupt trajectory file %s", filename);
+        dsda_RemoveLiveTrajectory(&table, id);
+        break;
+      default:
+        I_Error("dsda_DumpTrajectory: unknown record %d in %s", record, filename);
+    }
+  }
+
+  dsda_CutExtension(filename);
+  filename = Z_Realloc(filename, strlen(filename) + 16 + 4 + 1);
+  sprintf(filename + strlen(filename), "-%d.tsv", tic);
+
+  lprintf(LO_INFO, "Exporting tic %d (episode %d map %d) to: \"%s\"\n",
+          current_tic, episode, map, filename);
+
+  output = M_OpenFile(filename, "wb");
+  if (output == NULL)
+    I_Error("dsda_DumpTrajectory: failed to open %s", filename);
+
+  fprintf(output, "Id\tType\tX\tY\tZ\tAngle\tState\n");
+
+  for (id = 1; id < table.size; ++id) {
+    trj_mobj_t* entry = &table.mobjs[id];
+
+    if (!entry->live)
+      continue;
+
+    fprintf(output, "%d\t%d\t%.4f\t%.4f\t%.4f\t%u\t%d\n",
+            id, entry->type,
+            (double) entry->x / FRACUNIT,
+            (double) entry->y / FRACUNIT,
+            (double) entry->z / FRACUNIT,
+            entry->angle >> ANGLETOFINESHIFT,
+            entry->state);
+  }
+
+  fclose(output);
+
+  Z_Free(table.mobjs);
+  Z_Free(table.live);
+  Z_Free(filename);
+  Z_Free(buffer);
+}
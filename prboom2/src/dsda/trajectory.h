@@ -0,0 +1,26 @@
+//
+// Copyright(C) 2023 by Ryan Krafnick
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	DSDA Trajectory
+//
+
+#ifndef __DSDA_TRAJECTORY__
+#define __DSDA_TRAJECTORY__
+
+void dsda_InitTrajectoryExport(const char* name);
+void dsda_CloseTrajectoryExport(void);
+void dsda_ExportTrajectoryFrame(void);
+void dsda_DumpTrajectory(const char* name, int tic);
+
+#endif
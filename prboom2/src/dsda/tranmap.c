@@ -15,8 +15,15 @@
 //	DSDA TRANMAP
 //
 
+#include <limits.h>
 #include <string.h>
 
+#include "SDL.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "md5.h"
 #include "lprintf.h"
 #include "m_file.h"
@@ -24,6 +31,7 @@
 #include "z_zone.h"
 
 #include "dsda/data_organizer.h"
+#include "dsda/startup.h"
 #include "dsda/utility.h"
 
 #include "tranmap.h"
@@ -76,6 +84,114 @@ static void dsda_InitTranMapPaletteDir(void) {
   M_MakeDir(tranmap_palette_dir, true);
 }
 
+#define TSC 12 /* number of fixed point digits in filter percent */
+
+typedef struct {
+  int pal[3][256];
+  int tot[256];
+#ifdef __SSE2__
+  // Colors as (r, g) and (b, 0) pairs of shorts for _mm_madd_epi16
+  short pal_rg[512];
+  short pal_b[512];
+#endif
+} tranmap_palette_t;
+
+static void dsda_InitTranMapPalette(tranmap_palette_t* palette, const byte* playpal) {
+  int i;
+
+  // Transpose the palette and precompute the squared lengths
+  for (i = 0; i < 256; ++i) {
+    const byte* p = playpal + i * 3;
+
+    palette->pal[0][i] = p[0];
+    palette->pal[1][i] = p[1];
+    palette->pal[2][i] = p[2];
+    palette->tot[i] = (p[0] * p[0] + p[1] * p[1] + p[2] * p[2]) << (TSC - 1);
+
+#ifdef __SSE2__
+    palette->pal_rg[i * 2] = p[0];
+    palette->pal_rg[i * 2 + 1] = p[1];
+    palette->pal_b[i * 2] = p[2];
+    palette->pal_b[i * 2 + 1] = 0;
+#endif
+  }
+}
+
+#ifdef __SSE2__
+
+// The blended components fit in 20 bits, so each is split into 10 bit
+//   halves that multiply with the 8 bit palette inside 16 bit lanes.
+// Ties go to the highest color, as in the scalar search below.
+static byte dsda_NearestTranMapColor(const tranmap_palette_t* palette, int r, int g, int b) {
+  __m128i rg_hi, rg_lo, b_hi, b_lo;
+  __m128i best, best_color, color, step;
+  int best_err[4], best_index[4];
+  int c, k, result;
+
+  rg_hi = _mm_set1_epi32(((g >> 10) << 16) | (r >> 10));
+  rg_lo = _mm_set1_epi32(((g & 1023) << 16) | (r & 1023));
+  b_hi = _mm_set1_epi32(b >> 10);
+  b_lo = _mm_set1_epi32(b & 1023);
+
+  best = _mm_set1_epi32(INT_MAX);
+  best_color = _mm_setzero_si128();
+  color = _mm_setr_epi32(252, 253, 254, 255);
+  step = _mm_set1_epi32(4);
+
+  for (c = 252; c >= 0; c -= 4) {
+    __m128i rg, b0, dot, err, less;
+
+    rg = _mm_loadu_si128((const __m128i*) &palette->pal_rg[c * 2]);
+    b0 = _mm_loadu_si128((const __m128i*) &palette->pal_b[c * 2]);
+
+    dot = _mm_add_epi32(_mm_madd_epi16(rg, rg_hi), _mm_madd_epi16(b0, b_hi));
+    dot = _mm_slli_epi32(dot, 10);
+    dot = _mm_add_epi32(dot, _mm_add_epi32(_mm_madd_epi16(rg, rg_lo), _mm_madd_epi16(b0, b_lo)));
+    err = _mm_sub_epi32(_mm_loadu_si128((const __m128i*) &palette->tot[c]), dot);
+
+    less = _mm_cmplt_epi32(err, best);
+    best = _mm_or_si128(_mm_and_si128(less, err), _mm_andnot_si128(less, best));
+    best_color = _mm_or_si128(_mm_and_si128(less, color), _mm_andnot_si128(less, best_color));
+
+    color = _mm_sub_epi32(color, step);
+  }
+
+  _mm_storeu_si128((__m128i*) best_err, best);
+  _mm_storeu_si128((__m128i*) best_index, best_color);
+
+  result = 0;
+  for (k = 1; k < 4; ++k)
+    if (best_err[k] < best_err[result] ||
+        (best_err[k] == best_err[result] && best_index[k] > best_index[result]))
+      result = k;
+
+  return best_index[result];
+}
+
+#else
+
+static byte dsda_NearestTranMapColor(const tranmap_palette_t* palette, int r, int g, int b) {
+  int color = 255;
+  int best = INT_MAX;
+  int result = 0;
+
+  do {
+    int err = palette->tot[color] - palette->pal[0][color] * r
+                                  - palette->pal[1][color] * g
+                                  - palette->pal[2][color] * b;
+
+    if (err < best) {
+      best = err;
+      result = color;
+    }
+  }
+  while (--color >= 0);
+
+  return result;
+}
+
+#endif
+
 //
 // R_InitTranMap
 //
@@ -84,114 +200,241 @@ static void dsda_InitTranMapPaletteDir(void) {
 // By Lee Killough 2/21/98
 //
 
-#define TSC 12 /* number of fixed point digits in filter percent */
-
-static byte* dsda_GenerateTranMap(unsigned int alpha) {
-  byte* buffer;
-  const byte* playpal;
-  int pal[3][256];
-  int tot[256];
-  int pal_w1[3][256];
+static void dsda_BuildTranMap(byte* buffer, const tranmap_palette_t* palette, unsigned int alpha) {
+  int i, j;
   int w1, w2;
-
-  playpal = W_LumpByName("PLAYPAL");
+  byte *tp = buffer;
 
   w1 = (alpha << TSC) / 100;
   w2 = (1l << TSC) - w1;
 
-  buffer = Z_Malloc(tranmap_length);
-
-  // First, convert playpal into long int type, and transpose array,
-  // for fast inner-loop calculations. Precompute tot array.
-  {
-    register int i = 255;
-    register const unsigned char *p = playpal + 255 * 3;
-
-    do {
-      register int t, d;
-      pal_w1[0][i] = (pal[0][i] = t = p[0]) * w1;
-      d = t * t;
-      pal_w1[1][i] = (pal[1][i] = t = p[1]) * w1;
-      d += t * t;
-      pal_w1[2][i] = (pal[2][i] = t = p[2]) * w1;
-      d += t * t;
-      p -= 3;
-      tot[i] = d << (TSC - 1);
+  for (i = 0; i < 256; i++) {
+    int r1 = palette->pal[0][i] * w2;
+    int g1 = palette->pal[1][i] * w2;
+    int b1 = palette->pal[2][i] * w2;
+
+    for (j = 0; j < 256; j++, tp++)
+      *tp = dsda_NearestTranMapColor(palette,
+                                     palette->pal[0][j] * w1 + r1,
+                                     palette->pal[1][j] * w1 + g1,
+                                     palette->pal[2][j] * w1 + b1);
+  }
+}
+
+static tranmap_palette_t* dsda_TranMapPalette(void) {
+  static tranmap_palette_t* palette;
+
+  if (!palette) {
+    palette = Z_Malloc(sizeof(*palette));
+    dsda_InitTranMapPalette(palette, W_LumpByName("PLAYPAL"));
+  }
+
+  return palette;
+}
+
+static char* dsda_TranMapFileName(unsigned int alpha) {
+  char* filename;
+  int length;
+
+  if (!tranmap_palette_dir)
+    dsda_InitTranMapPaletteDir();
+
+  length = strlen(tranmap_palette_dir) + 16; // "/tranmap_99.dat\0"
+  filename = Z_Malloc(length);
+  snprintf(filename, length, "%s/tranmap_%02d.dat", tranmap_palette_dir, alpha);
+
+  return filename;
+}
+
+// Tranmaps are shared between runs in the data directory, one file per
+//   palette checksum and alpha. A short file (from an interrupted write
+//   or a concurrent process) is regenerated.
+static byte* dsda_ReadTranMap(unsigned int alpha) {
+  char* filename;
+  byte* buffer = NULL;
+  int length;
+
+  filename = dsda_TranMapFileName(alpha);
+
+  length = M_ReadFile(filename, &buffer);
+  if (buffer && length != tranmap_length) {
+    Z_Free(buffer);
+    buffer = NULL;
+  }
+
+  Z_Free(filename);
+
+  return buffer;
+}
+
+static void dsda_WriteTranMap(unsigned int alpha, const byte* buffer) {
+  char* filename;
+
+  filename = dsda_TranMapFileName(alpha);
+  M_WriteFile(filename, buffer, tranmap_length);
+  Z_Free(filename);
+}
+
+typedef struct {
+  byte* buffer;
+  unsigned int alpha;
+} tranmap_job_t;
+
+static tranmap_job_t tranmap_jobs[100];
+static int tranmap_job_count;
+static int next_tranmap_job;
+static SDL_mutex* tranmap_job_mutex;
+static dboolean tranmap_requested[100];
+
+static int dsda_TranMapThread(void* data) {
+  const tranmap_palette_t* palette = data;
+
+  while (true) {
+    tranmap_job_t* job;
+
+    SDL_LockMutex(tranmap_job_mutex);
+    job = next_tranmap_job < tranmap_job_count ? &tranmap_jobs[next_tranmap_job++] : NULL;
+    SDL_UnlockMutex(tranmap_job_mutex);
+
+    if (!job)
+      return 0;
+
+    dsda_BuildTranMap(job->buffer, palette, job->alpha);
+  }
+}
+
+// Buffers are allocated up front so the workers never touch the zone
+static void dsda_RunTranMapJobs(void) {
+  SDL_Thread* threads[16];
+  tranmap_palette_t* palette;
+  int thread_count;
+  int i;
+
+  palette = dsda_TranMapPalette();
+
+  thread_count = SDL_GetCPUCount();
+  if (thread_count > tranmap_job_count)
+    thread_count = tranmap_job_count;
+  if (thread_count > 16)
+    thread_count = 16;
+
+  next_tranmap_job = 0;
+
+  if (thread_count > 1)
+    tranmap_job_mutex = SDL_CreateMutex();
+
+  if (tranmap_job_mutex) {
+    int started = 0;
+
+    for (i = 0; i < thread_count; ++i) {
+      threads[started] = SDL_CreateThread(dsda_TranMapThread, "dsda_TranMapThread", palette);
+      if (threads[started])
+        ++started;
     }
-    while (--i >= 0);
+
+    // The main thread takes whatever the workers leave
+    dsda_TranMapThread(palette);
+
+    for (i = 0; i < started; ++i)
+      SDL_WaitThread(threads[i], NULL);
+
+    SDL_DestroyMutex(tranmap_job_mutex);
+    tranmap_job_mutex = NULL;
+  }
+  else
+    for (i = 0; i < tranmap_job_count; ++i)
+      dsda_BuildTranMap(tranmap_jobs[i].buffer, palette, tranmap_jobs[i].alpha);
+
+  for (i = 0; i < tranmap_job_count; ++i) {
+    dsda_WriteTranMap(tranmap_jobs[i].alpha, tranmap_jobs[i].buffer);
+    tranmap_data[tranmap_jobs[i].alpha] = tranmap_jobs[i].buffer;
   }
 
-  // Next, compute all entries using minimum arithmetic.
-  {
-    int i, j;
-    byte *tp = buffer;
-
-    for (i = 0; i < 256; i++) {
-      int r1 = pal[0][i] * w2;
-      int g1 = pal[1][i] * w2;
-      int b1 = pal[2][i] * w2;
-
-      for (j = 0; j < 256; j++, tp++) {
-        register int color = 255;
-        register int err;
-        int r = pal_w1[0][j] + r1;
-        int g = pal_w1[1][j] + g1;
-        int b = pal_w1[2][j] + b1;
-        int best = INT_MAX;
-
-        do {
-          err = tot[color] - pal[0][color] * r - pal[1][color] * g - pal[2][color] * b;
-          if (err < best) {
-            best = err;
-            *tp = color;
-          }
-        }
-        while (--color >= 0);
-      }
+  tranmap_job_count = 0;
+}
+
+void dsda_RequestTranMap(unsigned int alpha) {
+  if (alpha <= 99 && !tranmap_data[alpha])
+    tranmap_requested[alpha] = true;
+}
+
+void dsda_PrepareTranMaps(void) {
+  int alpha;
+
+  for (alpha = 0; alpha < 100; ++alpha) {
+    if (!tranmap_requested[alpha])
+      continue;
+
+    tranmap_requested[alpha] = false;
+
+    if (tranmap_data[alpha])
+      continue;
+
+    tranmap_data[alpha] = dsda_ReadTranMap(alpha);
+
+    if (!tranmap_data[alpha]) {
+      tranmap_jobs[tranmap_job_count].buffer = Z_Malloc(tranmap_length);
+      tranmap_jobs[tranmap_job_count].alpha = alpha;
+      ++tranmap_job_count;
     }
   }
 
-  return buffer;
+  if (tranmap_job_count)
+    dsda_RunTranMapJobs();
 }
 
 const byte* dsda_TranMap(unsigned int alpha) {
-  int length;
-  byte *buffer = NULL;
-
   if (alpha > 99)
     return NULL;
 
   if (!tranmap_data[alpha]) {
-    char* filename;
+    dsda_RequestTranMap(alpha);
+    dsda_PrepareTranMaps();
+  }
 
-    if (!tranmap_palette_dir)
-      dsda_InitTranMapPaletteDir();
+  return tranmap_data[alpha];
+}
 
-    length = strlen(tranmap_palette_dir) + 16; // "/tranmap_99.dat\0"
-    filename = Z_Malloc(length);
-    snprintf(filename, length, "%s/tranmap_%02d.dat", tranmap_palette_dir, alpha);
+// The default tranmap can be built on a worker thread during startup.
+//   Preparing it reads the palette and the cached file and allocates the
+//   buffer, so the build only fills that buffer in.
+static tranmap_job_t default_tranmap_job;
+static const tranmap_palette_t* default_tranmap_palette;
 
-    length = M_ReadFile(filename, &buffer);
-    if (buffer && length != tranmap_length) {
-      Z_Free(buffer);
-      buffer = NULL;
-    }
+void dsda_PrepareDefaultTranMap(void) {
+  unsigned int alpha = default_tranmap_alpha;
 
-    if (!buffer) {
-      buffer = dsda_GenerateTranMap(alpha);
+  if (W_CheckNumForName("TRANMAP") != LUMP_NOT_FOUND || tranmap_data[alpha])
+    return;
 
-      M_WriteFile(filename, buffer, tranmap_length);
-    }
+  tranmap_data[alpha] = dsda_ReadTranMap(alpha);
 
-    tranmap_data[alpha] = buffer;
+  if (!tranmap_data[alpha]) {
+    default_tranmap_palette = dsda_TranMapPalette();
+    default_tranmap_job.buffer = Z_Malloc(tranmap_length);
+    default_tranmap_job.alpha = alpha;
   }
+}
 
-  return tranmap_data[alpha];
+void dsda_BuildDefaultTranMap(void) {
+  if (default_tranmap_job.buffer)
+    dsda_BuildTranMap(default_tranmap_job.buffer, default_tranmap_palette, default_tranmap_job.alpha);
+}
+
+void dsda_FinishDefaultTranMap(void) {
+  if (!default_tranmap_job.buffer)
+    return;
+
+  dsda_WriteTranMap(default_tranmap_job.alpha, default_tranmap_job.buffer);
+  tranmap_data[default_tranmap_job.alpha] = default_tranmap_job.buffer;
+  default_tranmap_job.buffer = NULL;
 }
 
 const byte* dsda_DefaultTranMap(void) {
   int lump;
 
+  dsda_FinishStartupJob(dsda_startup_tranmap);
+
   lump = W_CheckNumForName("TRANMAP");
 
   if (lump != LUMP_NOT_FOUND)
@@ -21,6 +21,11 @@
 #include "doomtype.h"
 
 const byte* dsda_TranMap(unsigned int alpha);
+void dsda_RequestTranMap(unsigned int alpha);
+void dsda_PrepareTranMaps(void);
 const byte* dsda_DefaultTranMap(void);
+void dsda_PrepareDefaultTranMap(void);
+void dsda_BuildDefaultTranMap(void);
+void dsda_FinishDefaultTranMap(void);
 
 #endif
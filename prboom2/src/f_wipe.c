@@ -37,8 +37,13 @@
 #include "config.h"
 #endif
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "z_zone.h"
 #include "doomdef.h"
+#include "i_capture.h"
 #include "i_video.h"
 #include "v_video.h"
 #include "m_random.h"
@@ -157,6 +162,150 @@ static int wipe_doMelt(int ticks)
   return done;
 }
 
+// Captured software wipes don't need the incremental update: each frame
+// is composed from column-major copies of the two screens, where a
+// column's shift is two contiguous copies, and transposed into the frame
+
+static dboolean wipe_capture;
+static int wipe_col_pitch;
+static byte *wipe_cols_start;
+static byte *wipe_cols_end;
+static byte *wipe_cols;
+
+#ifdef __SSE2__
+// Four rounds of interleaving row i with row i + 8 transpose 16x16 bytes
+static void wipe_transpose16(byte *dst, int dst_pitch, const byte *src, int src_pitch)
+{
+  __m128i a[16], b[16];
+  __m128i *in = a, *out = b, *swap;
+  int i, round;
+
+  for (i = 0; i < 16; i++)
+    a[i] = _mm_loadu_si128((const __m128i *) (src + i * src_pitch));
+
+  for (round = 0; round < 4; round++)
+  {
+    for (i = 0; i < 8; i++)
+    {
+      out[2 * i] = _mm_unpacklo_epi8(in[i], in[i + 8]);
+      out[2 * i + 1] = _mm_unpackhi_epi8(in[i], in[i + 8]);
+    }
+
+    swap = in;
+    in = out;
+    out = swap;
+  }
+
+  for (i = 0; i < 16; i++)
+    _mm_storeu_si128((__m128i *) (dst + i * dst_pitch), in[i]);
+}
+#endif
+
+// dst[x][y] = src[y][x] for a width x height source
+static void wipe_transpose(byte *dst, int dst_pitch, const byte *src, int src_pitch,
+                           int width, int height)
+{
+  int x, y;
+  int y0 = 0;
+
+#ifdef __SSE2__
+  int width16 = width & ~15;
+
+  for (y0 = 0; y0 + 16 <= height; y0 += 16)
+  {
+    for (x = 0; x < width16; x += 16)
+      wipe_transpose16(dst + x * dst_pitch + y0, dst_pitch, src + y0 * src_pitch + x, src_pitch);
+
+    for (y = y0; y < y0 + 16; y++)
+      for (x = width16; x < width; x++)
+        dst[x * dst_pitch + y] = src[y * src_pitch + x];
+  }
+#endif
+
+  for (y = y0; y < height; y++)
+    for (x = 0; x < width; x++)
+      dst[x * dst_pitch + y] = src[y * src_pitch + x];
+}
+
+static void wipe_initCaptureMelt(void)
+{
+  size_t size;
+
+  wipe_col_pitch = (SCREENHEIGHT + 15) & ~15;
+  size = (size_t) SCREENWIDTH * wipe_col_pitch;
+
+  wipe_cols_start = Z_Malloc(size);
+  wipe_cols_end = Z_Malloc(size);
+  wipe_cols = Z_Malloc(size);
+
+  wipe_transpose(wipe_cols_start, wipe_col_pitch, wipe_scr_start.data, wipe_scr_start.pitch,
+                 SCREENWIDTH, SCREENHEIGHT);
+  wipe_transpose(wipe_cols_end, wipe_col_pitch, wipe_scr_end.data, wipe_scr_end.pitch,
+                 SCREENWIDTH, SCREENHEIGHT);
+}
+
+static void wipe_exitCaptureMelt(void)
+{
+  Z_Free(wipe_cols_start);
+  Z_Free(wipe_cols_end);
+  Z_Free(wipe_cols);
+  wipe_cols_start = wipe_cols_end = wipe_cols = NULL;
+}
+
+// Same column motion as wipe_doMelt, without drawing
+static int wipe_stepMelt(int ticks)
+{
+  dboolean done = true;
+  int i;
+
+  while (ticks--) {
+    for (i=0;i<(SCREENWIDTH);i++) {
+      if (y_lookup[i]<0) {
+        y_lookup[i]++;
+        done = false;
+        continue;
+      }
+      if (y_lookup[i] < SCREENHEIGHT) {
+        int dy;
+
+        dy = (y_lookup[i] < 16) ? y_lookup[i]+1 : SCREENHEIGHT/25;
+        if (y_lookup[i]+dy >= SCREENHEIGHT)
+          dy = SCREENHEIGHT - y_lookup[i];
+
+        y_lookup[i] += dy;
+        done = false;
+      }
+    }
+  }
+  return done;
+}
+
+static int wipe_doCaptureMelt(int ticks)
+{
+  dboolean done;
+  int i;
+
+  // More video frames than tics: repeat the current one
+  if (!ticks)
+    return false;
+
+  done = wipe_stepMelt(ticks);
+
+  for (i = 0; i < SCREENWIDTH; i++)
+  {
+    int y = BETWEEN(0, SCREENHEIGHT, y_lookup[i]);
+    size_t offset = (size_t) i * wipe_col_pitch;
+
+    memcpy(wipe_cols + offset, wipe_cols_end + offset, y);
+    memcpy(wipe_cols + offset + y, wipe_cols_start + offset, SCREENHEIGHT - y);
+  }
+
+  wipe_transpose(wipe_scr.data, wipe_scr.pitch, wipe_cols, wipe_col_pitch,
+                 SCREENHEIGHT, SCREENWIDTH);
+
+  return done;
+}
+
 // CPhipps - modified to allocate and deallocate screens[2 to 3] as needed, saving memory
 
 static int wipe_exitMelt(int ticks)
@@ -167,6 +316,9 @@ static int wipe_exitMelt(int ticks)
     return 0;
   }
 
+  if (wipe_capture)
+    wipe_exitCaptureMelt();
+
   V_FreeScreen(&wipe_scr_start);
   wipe_scr_start.width = 0;
   wipe_scr_start.height = 0;
@@ -245,10 +397,14 @@ int wipe_ScreenWipe(int ticks)
     go = 1;
     wipe_scr = screens[0];
     wipe_initMelt(ticks);
+
+    wipe_capture = capturing_video && V_IsSoftwareMode();
+    if (wipe_capture)
+      wipe_initCaptureMelt();
   }
 
   // do a piece of wipe-in
-  if (wipe_doMelt(ticks))     // final stuff
+  if (wipe_capture ? wipe_doCaptureMelt(ticks) : wipe_doMelt(ticks))     // final stuff
   {
     wipe_exitMelt(ticks);
     go = 0;
@@ -88,6 +88,7 @@
 #include "dsda.h"
 #include "dsda/aim.h"
 #include "dsda/args.h"
+#include "dsda/benchmark.h"
 #include "dsda/brute_force.h"
 #include "dsda/build.h"
 #include "dsda/configuration.h"
@@ -97,6 +98,8 @@
 #include "dsda/exdemo.h"
 #include "dsda/features.h"
 #include "dsda/key_frame.h"
+#include "dsda/key_frame_index.h"
+#include "dsda/segment.h"
 #include "dsda/mapinfo.h"
 #include "dsda/messenger.h"
 #include "dsda/save.h"
@@ -1286,6 +1289,8 @@ static void G_DoLoadLevel (void)
     }
   }
 
+  dsda_QueueArchiveBenchmark();
+
   // killough: make -timedemo work on multilevel demos
   // Move to end of function to minimize noise -- killough 2/22/98:
 
@@ -1513,6 +1518,8 @@ void G_Ticker (void)
     }
   }
 
+  dsda_BenchmarkArchive();
+
   dsda_EvaluateSkipModeGTicker();
 
   if (!dsda_SkipMode() && gamestate == GS_LEVEL)
@@ -1553,11 +1560,16 @@ void G_Ticker (void)
     int buf = gametic % BACKUPTICS;
 
     dsda_UpdateAutoKeyFrames();
+    dsda_UpdateKeyFrameIndex();
+    dsda_UpdateSegment();
 
     if (dsda_BruteForce())
     {
       dsda_UpdateBruteForce();
-      dsda_RemovePauseMode(PAUSE_BUILDMODE);
+
+      // A pruned subtree can exhaust the search here
+      if (dsda_BruteForce())
+        dsda_RemovePauseMode(PAUSE_BUILDMODE);
     }
 
     for (i = 0; i < g_maxplayers; i++)
@@ -1679,9 +1691,14 @@ void G_Ticker (void)
       P_Ticker();
       P_WalkTicker();
       mlooky = 0;
-      AM_Ticker();
       ST_Ticker();
-      HU_Ticker();
+
+      // Nothing is drawn from these while skipping
+      if (!dsda_SkipMode())
+      {
+        AM_Ticker();
+        HU_Ticker();
+      }
       break;
 
     case GS_INTERMISSION:
@@ -4015,6 +4032,8 @@ dboolean G_CheckDemoStatus (void)
     lprintf(LO_INFO, "Timed %u gametics in %u realtics = %-.1f frames per second\n",
              (unsigned) gametic,realtics,
              (unsigned) gametic * (double) TICRATE / realtics);
+    R_PrintViewLayoutBenchmark();
+    dsda_WriteBenchmark(gametic, realtics);
     I_SafeExit(0);
   }
 
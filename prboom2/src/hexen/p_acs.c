@@ -64,6 +64,96 @@ typedef struct {
 #pragma pack(pop)
 #endif //_MSC_VER
 
+#if defined(__GNUC__) || defined(__clang__)
+#define ACS_COMPUTED_GOTO
+#endif
+
+#define ACS_MAP_VAR 0
+#define ACS_WORLD_VAR 1
+
+// Operations of the decoded form. Commands without their own operation
+// are run through PCodeCmds from the lump offset (ACS_OP_RAW).
+typedef enum
+{
+    ACS_OP_RAW,
+    ACS_OP_NOP,
+    ACS_OP_TERMINATE,
+    ACS_OP_SUSPEND,
+    ACS_OP_PUSH_NUMBER,
+    ACS_OP_LSPEC,
+    ACS_OP_LSPEC_DIRECT,
+    ACS_OP_ADD,
+    ACS_OP_SUBTRACT,
+    ACS_OP_MULTIPLY,
+    ACS_OP_DIVIDE,
+    ACS_OP_MODULUS,
+    ACS_OP_EQ,
+    ACS_OP_NE,
+    ACS_OP_LT,
+    ACS_OP_GT,
+    ACS_OP_LE,
+    ACS_OP_GE,
+    ACS_OP_AND_LOGICAL,
+    ACS_OP_OR_LOGICAL,
+    ACS_OP_AND_BITWISE,
+    ACS_OP_OR_BITWISE,
+    ACS_OP_EOR_BITWISE,
+    ACS_OP_NEGATE_LOGICAL,
+    ACS_OP_LSHIFT,
+    ACS_OP_RSHIFT,
+    ACS_OP_UNARY_MINUS,
+    ACS_OP_ASSIGN_SCRIPT_VAR,
+    ACS_OP_ASSIGN_GLOBAL_VAR,
+    ACS_OP_PUSH_SCRIPT_VAR,
+    ACS_OP_PUSH_GLOBAL_VAR,
+    ACS_OP_ADD_SCRIPT_VAR,
+    ACS_OP_ADD_GLOBAL_VAR,
+    ACS_OP_SUB_SCRIPT_VAR,
+    ACS_OP_SUB_GLOBAL_VAR,
+    ACS_OP_MUL_SCRIPT_VAR,
+    ACS_OP_MUL_GLOBAL_VAR,
+    ACS_OP_DIV_SCRIPT_VAR,
+    ACS_OP_DIV_GLOBAL_VAR,
+    ACS_OP_MOD_SCRIPT_VAR,
+    ACS_OP_MOD_GLOBAL_VAR,
+    ACS_OP_INC_SCRIPT_VAR,
+    ACS_OP_INC_GLOBAL_VAR,
+    ACS_OP_DEC_SCRIPT_VAR,
+    ACS_OP_DEC_GLOBAL_VAR,
+    ACS_OP_GOTO,
+    ACS_OP_IF_GOTO,
+    ACS_OP_IF_NOT_GOTO,
+    ACS_OP_CASE_GOTO,
+    ACS_OP_DROP,
+    ACS_OP_DELAY,
+    ACS_OP_DELAY_DIRECT,
+    ACS_OP_RESTART,
+    ACS_OP_LINE_SIDE,
+    ACS_OP_TIMER,
+    ACS_OP_COUNT
+} acsOp_t;
+
+typedef struct
+{
+    int (*cmd) (void);
+    acsOp_t op;
+    int param;                  // argument count, variable scope or raw operand count
+} acsCmd_t;
+
+typedef struct
+{
+    acsOp_t op;
+    int cmd;
+    int offset;                 // lump offset of the command
+    int next_offset;
+    int next;                   // decoded index of next_offset, -1 until known
+    int target_offset;
+    int target;                 // decoded index of target_offset, -1 until known
+    int count;
+    int args[6];
+    int *var;
+} acsInstr_t;
+
 static void StartOpenACS(int number, int infoIndex, int offset);
 static void ScriptFinished(int number);
 static dboolean TagBusy(int tag);
@@ -196,110 +286,116 @@ static const char **ACStrings;
 static char PrintBuffer[PRINT_BUFFER_SIZE];
 static acs_t *NewScript;
 
-static int (*PCodeCmds[]) (void) =
-{
-        CmdNOP,
-        CmdTerminate,
-        CmdSuspend,
-        CmdPushNumber,
-        CmdLSpec1,
-        CmdLSpec2,
-        CmdLSpec3,
-        CmdLSpec4,
-        CmdLSpec5,
-        CmdLSpec1Direct,
-        CmdLSpec2Direct,
-        CmdLSpec3Direct,
-        CmdLSpec4Direct,
-        CmdLSpec5Direct,
-        CmdAdd,
-        CmdSubtract,
-        CmdMultiply,
-        CmdDivide,
-        CmdModulus,
-        CmdEQ,
-        CmdNE,
-        CmdLT,
-        CmdGT,
-        CmdLE,
-        CmdGE,
-        CmdAssignScriptVar,
-        CmdAssignMapVar,
-        CmdAssignWorldVar,
-        CmdPushScriptVar,
-        CmdPushMapVar,
-        CmdPushWorldVar,
-        CmdAddScriptVar,
-        CmdAddMapVar,
-        CmdAddWorldVar,
-        CmdSubScriptVar,
-        CmdSubMapVar,
-        CmdSubWorldVar,
-        CmdMulScriptVar,
-        CmdMulMapVar,
-        CmdMulWorldVar,
-        CmdDivScriptVar,
-        CmdDivMapVar,
-        CmdDivWorldVar,
-        CmdModScriptVar,
-        CmdModMapVar,
-        CmdModWorldVar,
-        CmdIncScriptVar,
-        CmdIncMapVar,
-        CmdIncWorldVar,
-        CmdDecScriptVar,
-        CmdDecMapVar,
-        CmdDecWorldVar,
-        CmdGoto,
-        CmdIfGoto,
-        CmdDrop,
-        CmdDelay,
-        CmdDelayDirect,
-        CmdRandom,
-        CmdRandomDirect,
-        CmdThingCount,
-        CmdThingCountDirect,
-        CmdTagWait,
-        CmdTagWaitDirect,
-        CmdPolyWait,
-        CmdPolyWaitDirect,
-        CmdChangeFloor,
-        CmdChangeFloorDirect,
-        CmdChangeCeiling,
-        CmdChangeCeilingDirect,
-        CmdRestart,
-        CmdAndLogical,
-        CmdOrLogical,
-        CmdAndBitwise,
-        CmdOrBitwise,
-        CmdEorBitwise,
-        CmdNegateLogical,
-        CmdLShift,
-        CmdRShift,
-        CmdUnaryMinus,
-        CmdIfNotGoto,
-        CmdLineSide,
-        CmdScriptWait,
-        CmdScriptWaitDirect,
-        CmdClearLineSpecial,
-        CmdCaseGoto,
-        CmdBeginPrint,
-        CmdEndPrint,
-        CmdPrintString,
-        CmdPrintNumber,
-        CmdPrintCharacter,
-        CmdPlayerCount,
-        CmdGameType,
-        CmdGameSkill,
-        CmdTimer,
-        CmdSectorSound,
-        CmdAmbientSound,
-        CmdSoundSequence,
-        CmdSetLineTexture,
-        CmdSetLineBlocking,
-        CmdSetLineSpecial,
-        CmdThingSound,
-        CmdEndPrintBold,
+static acsInstr_t *ACSCode;
+static int ACSCodeCount;
+static int ACSCodeSize;
+static int *ACSCodeIndex;       // lump offset -> decoded index, -1 if not decoded
+static int CurrentInstr = -1;
+
+static const acsCmd_t PCodeCmds[] =
+{
+        { CmdNOP,                 ACS_OP_NOP, 0 },
+        { CmdTerminate,           ACS_OP_TERMINATE, 0 },
+        { CmdSuspend,             ACS_OP_SUSPEND, 0 },
+        { CmdPushNumber,          ACS_OP_PUSH_NUMBER, 0 },
+        { CmdLSpec1,              ACS_OP_LSPEC, 1 },
+        { CmdLSpec2,              ACS_OP_LSPEC, 2 },
+        { CmdLSpec3,              ACS_OP_LSPEC, 3 },
+        { CmdLSpec4,              ACS_OP_LSPEC, 4 },
+        { CmdLSpec5,              ACS_OP_LSPEC, 5 },
+        { CmdLSpec1Direct,        ACS_OP_LSPEC_DIRECT, 1 },
+        { CmdLSpec2Direct,        ACS_OP_LSPEC_DIRECT, 2 },
+        { CmdLSpec3Direct,        ACS_OP_LSPEC_DIRECT, 3 },
+        { CmdLSpec4Direct,        ACS_OP_LSPEC_DIRECT, 4 },
+        { CmdLSpec5Direct,        ACS_OP_LSPEC_DIRECT, 5 },
+        { CmdAdd,                 ACS_OP_ADD, 0 },
+        { CmdSubtract,            ACS_OP_SUBTRACT, 0 },
+        { CmdMultiply,            ACS_OP_MULTIPLY, 0 },
+        { CmdDivide,              ACS_OP_DIVIDE, 0 },
+        { CmdModulus,             ACS_OP_MODULUS, 0 },
+        { CmdEQ,                  ACS_OP_EQ, 0 },
+        { CmdNE,                  ACS_OP_NE, 0 },
+        { CmdLT,                  ACS_OP_LT, 0 },
+        { CmdGT,                  ACS_OP_GT, 0 },
+        { CmdLE,                  ACS_OP_LE, 0 },
+        { CmdGE,                  ACS_OP_GE, 0 },
+        { CmdAssignScriptVar,     ACS_OP_ASSIGN_SCRIPT_VAR, 0 },
+        { CmdAssignMapVar,        ACS_OP_ASSIGN_GLOBAL_VAR, ACS_MAP_VAR },
+        { CmdAssignWorldVar,      ACS_OP_ASSIGN_GLOBAL_VAR, ACS_WORLD_VAR },
+        { CmdPushScriptVar,       ACS_OP_PUSH_SCRIPT_VAR, 0 },
+        { CmdPushMapVar,          ACS_OP_PUSH_GLOBAL_VAR, ACS_MAP_VAR },
+        { CmdPushWorldVar,        ACS_OP_PUSH_GLOBAL_VAR, ACS_WORLD_VAR },
+        { CmdAddScriptVar,        ACS_OP_ADD_SCRIPT_VAR, 0 },
+        { CmdAddMapVar,           ACS_OP_ADD_GLOBAL_VAR, ACS_MAP_VAR },
+        { CmdAddWorldVar,         ACS_OP_ADD_GLOBAL_VAR, ACS_WORLD_VAR },
+        { CmdSubScriptVar,        ACS_OP_SUB_SCRIPT_VAR, 0 },
+        { CmdSubMapVar,           ACS_OP_SUB_GLOBAL_VAR, ACS_MAP_VAR },
+        { CmdSubWorldVar,         ACS_OP_SUB_GLOBAL_VAR, ACS_WORLD_VAR },
+        { CmdMulScriptVar,        ACS_OP_MUL_SCRIPT_VAR, 0 },
+        { CmdMulMapVar,           ACS_OP_MUL_GLOBAL_VAR, ACS_MAP_VAR },
+        { CmdMulWorldVar,         ACS_OP_MUL_GLOBAL_VAR, ACS_WORLD_VAR },
+        { CmdDivScriptVar,        ACS_OP_DIV_SCRIPT_VAR, 0 },
+        { CmdDivMapVar,           ACS_OP_DIV_GLOBAL_VAR, ACS_MAP_VAR },
+        { CmdDivWorldVar,         ACS_OP_DIV_GLOBAL_VAR, ACS_WORLD_VAR },
+        { CmdModScriptVar,        ACS_OP_MOD_SCRIPT_VAR, 0 },
+        { CmdModMapVar,           ACS_OP_MOD_GLOBAL_VAR, ACS_MAP_VAR },
+        { CmdModWorldVar,         ACS_OP_MOD_GLOBAL_VAR, ACS_WORLD_VAR },
+        { CmdIncScriptVar,        ACS_OP_INC_SCRIPT_VAR, 0 },
+        { CmdIncMapVar,           ACS_OP_INC_GLOBAL_VAR, ACS_MAP_VAR },
+        { CmdIncWorldVar,         ACS_OP_INC_GLOBAL_VAR, ACS_WORLD_VAR },
+        { CmdDecScriptVar,        ACS_OP_DEC_SCRIPT_VAR, 0 },
+        { CmdDecMapVar,           ACS_OP_DEC_GLOBAL_VAR, ACS_MAP_VAR },
+        { CmdDecWorldVar,         ACS_OP_DEC_GLOBAL_VAR, ACS_WORLD_VAR },
+        { CmdGoto,                ACS_OP_GOTO, 0 },
+        { CmdIfGoto,              ACS_OP_IF_GOTO, 0 },
+        { CmdDrop,                ACS_OP_DROP, 0 },
+        { CmdDelay,               ACS_OP_DELAY, 0 },
+        { CmdDelayDirect,         ACS_OP_DELAY_DIRECT, 0 },
+        { CmdRandom,              ACS_OP_RAW, 0 },
+        { CmdRandomDirect,        ACS_OP_RAW, 2 },
+        { CmdThingCount,          ACS_OP_RAW, 0 },
+        { CmdThingCountDirect,    ACS_OP_RAW, 2 },
+        { CmdTagWait,             ACS_OP_RAW, 0 },
+        { CmdTagWaitDirect,       ACS_OP_RAW, 1 },
+        { CmdPolyWait,            ACS_OP_RAW, 0 },
+        { CmdPolyWaitDirect,      ACS_OP_RAW, 1 },
+        { CmdChangeFloor,         ACS_OP_RAW, 0 },
+        { CmdChangeFloorDirect,   ACS_OP_RAW, 2 },
+        { CmdChangeCeiling,       ACS_OP_RAW, 0 },
+        { CmdChangeCeilingDirect, ACS_OP_RAW, 2 },
+        { CmdRestart,             ACS_OP_RESTART, 0 },
+        { CmdAndLogical,          ACS_OP_AND_LOGICAL, 0 },
+        { CmdOrLogical,           ACS_OP_OR_LOGICAL, 0 },
+        { CmdAndBitwise,          ACS_OP_AND_BITWISE, 0 },
+        { CmdOrBitwise,           ACS_OP_OR_BITWISE, 0 },
+        { CmdEorBitwise,          ACS_OP_EOR_BITWISE, 0 },
+        { CmdNegateLogical,       ACS_OP_NEGATE_LOGICAL, 0 },
+        { CmdLShift,              ACS_OP_LSHIFT, 0 },
+        { CmdRShift,              ACS_OP_RSHIFT, 0 },
+        { CmdUnaryMinus,          ACS_OP_UNARY_MINUS, 0 },
+        { CmdIfNotGoto,           ACS_OP_IF_NOT_GOTO, 0 },
+        { CmdLineSide,            ACS_OP_LINE_SIDE, 0 },
+        { CmdScriptWait,          ACS_OP_RAW, 0 },
+        { CmdScriptWaitDirect,    ACS_OP_RAW, 1 },
+        { CmdClearLineSpecial,    ACS_OP_RAW, 0 },
+        { CmdCaseGoto,            ACS_OP_CASE_GOTO, 0 },
+        { CmdBeginPrint,          ACS_OP_RAW, 0 },
+        { CmdEndPrint,            ACS_OP_RAW, 0 },
+        { CmdPrintString,         ACS_OP_RAW, 0 },
+        { CmdPrintNumber,         ACS_OP_RAW, 0 },
+        { CmdPrintCharacter,      ACS_OP_RAW, 0 },
+        { CmdPlayerCount,         ACS_OP_RAW, 0 },
+        { CmdGameType,            ACS_OP_RAW, 0 },
+        { CmdGameSkill,           ACS_OP_RAW, 0 },
+        { CmdTimer,               ACS_OP_TIMER, 0 },
+        { CmdSectorSound,         ACS_OP_RAW, 0 },
+        { CmdAmbientSound,        ACS_OP_RAW, 0 },
+        { CmdSoundSequence,       ACS_OP_RAW, 0 },
+        { CmdSetLineTexture,      ACS_OP_RAW, 0 },
+        { CmdSetLineBlocking,     ACS_OP_RAW, 0 },
+        { CmdSetLineSpecial,      ACS_OP_RAW, 0 },
+        { CmdThingSound,          ACS_OP_RAW, 0 },
+        { CmdEndPrintBold,        ACS_OP_RAW, 0 },
 };
 
 static void ACSAssert(int condition, const char *fmt, ...)
@@ -312,6 +408,14 @@ static void ACSAssert(int condition, const char *fmt, ...)
         return;
     }
 
+    // The decoded interpreter only describes its context on failure
+    if (CurrentInstr >= 0)
+    {
+        snprintf(EvalContext, sizeof(EvalContext), "script %d @0x%x, cmd=%d",
+                 ACSInfo[ACScript->infoIndex].number,
+                 ACSCode[CurrentInstr].offset + 4, ACSCode[CurrentInstr].cmd);
+    }
+
     va_start(args, fmt);
     vsnprintf(buf, sizeof(buf), fmt, args);
     va_end(args);
@@ -378,6 +482,246 @@ static int ReadOffset(void)
     return offset;
 }
 
+static dboolean DecodeInt(int *offset, int *value)
+{
+    if ((unsigned int) *offset + 3 >= ActionCodeSize)
+    {
+        return false;
+    }
+
+    *value = LittleLong(*(const int *) (ActionCodeBase + *offset));
+    *offset += 4;
+
+    return true;
+}
+
+static dboolean DecodeOffset(int *offset, int *value)
+{
+    return DecodeInt(offset, value) && *value >= 0 && *value < ActionCodeSize;
+}
+
+static dboolean DecodeVar(int *offset, int *value, int limit)
+{
+    return DecodeInt(offset, value) && *value >= 0 && *value < limit;
+}
+
+static dboolean DecodeOperands(acsInstr_t *instr, int *offset)
+{
+    const acsCmd_t *cmd;
+    int i;
+
+    cmd = &PCodeCmds[instr->cmd];
+
+    switch (instr->op)
+    {
+        case ACS_OP_PUSH_NUMBER:
+        case ACS_OP_DELAY_DIRECT:
+        case ACS_OP_LSPEC:
+            instr->count = cmd->param;
+            return DecodeInt(offset, &instr->args[0]);
+        case ACS_OP_LSPEC_DIRECT:
+            instr->count = cmd->param;
+            for (i = 0; i <= instr->count; ++i)
+            {
+                if (!DecodeInt(offset, &instr->args[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        case ACS_OP_ASSIGN_SCRIPT_VAR:
+        case ACS_OP_PUSH_SCRIPT_VAR:
+        case ACS_OP_ADD_SCRIPT_VAR:
+        case ACS_OP_SUB_SCRIPT_VAR:
+        case ACS_OP_MUL_SCRIPT_VAR:
+        case ACS_OP_DIV_SCRIPT_VAR:
+        case ACS_OP_MOD_SCRIPT_VAR:
+        case ACS_OP_INC_SCRIPT_VAR:
+        case ACS_OP_DEC_SCRIPT_VAR:
+            return DecodeVar(offset, &instr->args[0], MAX_ACS_SCRIPT_VARS);
+        case ACS_OP_ASSIGN_GLOBAL_VAR:
+        case ACS_OP_PUSH_GLOBAL_VAR:
+        case ACS_OP_ADD_GLOBAL_VAR:
+        case ACS_OP_SUB_GLOBAL_VAR:
+        case ACS_OP_MUL_GLOBAL_VAR:
+        case ACS_OP_DIV_GLOBAL_VAR:
+        case ACS_OP_MOD_GLOBAL_VAR:
+        case ACS_OP_INC_GLOBAL_VAR:
+        case ACS_OP_DEC_GLOBAL_VAR:
+            if (cmd->param == ACS_MAP_VAR)
+            {
+                if (!DecodeVar(offset, &instr->args[0], MAX_ACS_MAP_VARS))
+                {
+                    return false;
+                }
+                instr->var = &MapVars[instr->args[0]];
+            }
+            else
+            {
+                if (!DecodeVar(offset, &instr->args[0], MAX_ACS_WORLD_VARS))
+                {
+                    return false;
+                }
+                instr->var = &WorldVars[instr->args[0]];
+            }
+            return true;
+        case ACS_OP_GOTO:
+        case ACS_OP_IF_GOTO:
+        case ACS_OP_IF_NOT_GOTO:
+            return DecodeOffset(offset, &instr->target_offset);
+        case ACS_OP_CASE_GOTO:
+            return DecodeInt(offset, &instr->args[0]) &&
+                   DecodeOffset(offset, &instr->target_offset);
+        case ACS_OP_RAW:
+            for (i = 0; i < cmd->param; ++i)
+            {
+                if (!DecodeInt(offset, &instr->args[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        default:
+            return true;
+    }
+}
+
+// Anything the original interpreter would reject stays a raw step,
+// so that it fails at the same point with the same message
+static int DecodeInstruction(int offset)
+{
+    acsInstr_t *instr;
+    int index;
+
+    if (ACSCodeCount == ACSCodeSize)
+    {
+        ACSCodeSize = ACSCodeSize ? ACSCodeSize * 2 : 256;
+        ACSCode = Z_ReallocLevel(ACSCode, ACSCodeSize * sizeof(*ACSCode));
+    }
+
+    index = ACSCodeCount++;
+    ACSCodeIndex[offset] = index;
+
+    instr = &ACSCode[index];
+    memset(instr, 0, sizeof(*instr));
+    instr->offset = offset;
+    instr->next_offset = -1;
+    instr->next = -1;
+    instr->target_offset = -1;
+    instr->target = -1;
+
+    if (!DecodeInt(&offset, &instr->cmd) ||
+        instr->cmd < 0 || instr->cmd >= arrlen(PCodeCmds))
+    {
+        instr->op = ACS_OP_RAW;
+        return index;
+    }
+
+    instr->op = PCodeCmds[instr->cmd].op;
+
+    if (!DecodeOperands(instr, &offset))
+    {
+        instr->op = ACS_OP_RAW;
+        instr->target_offset = -1;
+        return index;
+    }
+
+    instr->next_offset = offset;
+
+    return index;
+}
+
+static int InterpretRaw(void);
+
+static int FindInstruction(int offset)
+{
+    if (offset < 0 || offset >= ActionCodeSize || !ACSCodeIndex)
+    {
+        // Fails the original end of lump assertion
+        CurrentInstr = -1;
+        PCodeOffset = offset;
+        InterpretRaw();
+        return -1;
+    }
+
+    if (ACSCodeIndex[offset] < 0)
+    {
+        DecodeInstruction(offset);
+    }
+
+    return ACSCodeIndex[offset];
+}
+
+static dboolean EndsBlock(const acsInstr_t *instr)
+{
+    return instr->op == ACS_OP_TERMINATE ||
+           instr->op == ACS_OP_GOTO ||
+           instr->op == ACS_OP_RESTART;
+}
+
+// Decode everything reachable from the script entry points up front
+static void DecodeACScripts(void)
+{
+    int *pending;
+    int pending_count;
+    int i;
+
+    ACSCodeIndex = Z_MallocLevel(ActionCodeSize * sizeof(*ACSCodeIndex));
+    memset(ACSCodeIndex, 0xff, ActionCodeSize * sizeof(*ACSCodeIndex));
+
+    pending = Z_Malloc((ACScriptCount + 1) * sizeof(*pending));
+    pending_count = 0;
+
+    for (i = 0; i < ACScriptCount; i++)
+    {
+        pending[pending_count++] = ACSInfo[i].offset;
+    }
+
+    while (pending_count)
+    {
+        int offset;
+
+        offset = pending[--pending_count];
+
+        while (offset >= 0 && offset < ActionCodeSize && ACSCodeIndex[offset] < 0)
+        {
+            const acsInstr_t *instr;
+            int index;
+
+            index = DecodeInstruction(offset);
+            instr = &ACSCode[index];
+
+            if (instr->target_offset >= 0 && ACSCodeIndex[instr->target_offset] < 0)
+            {
+                pending = Z_Realloc(pending, (pending_count + 1) * sizeof(*pending));
+                pending[pending_count++] = instr->target_offset;
+            }
+
+            if (EndsBlock(instr))
+            {
+                break;
+            }
+
+            offset = instr->next_offset;
+        }
+    }
+
+    Z_Free(pending);
+
+    for (i = 0; i < ACSCodeCount; i++)
+    {
+        if (ACSCode[i].next_offset >= 0 && ACSCode[i].next_offset < ActionCodeSize)
+        {
+            ACSCode[i].next = ACSCodeIndex[ACSCode[i].next_offset];
+        }
+
+        if (ACSCode[i].target_offset >= 0)
+        {
+            ACSCode[i].target = ACSCodeIndex[ACSCode[i].target_offset];
+        }
+    }
+}
+
 void P_LoadACScripts(int lump)
 {
     int i, offset;
@@ -387,6 +731,11 @@ void P_LoadACScripts(int lump)
     ActionCodeBase = W_LumpByNum(lump);
     ActionCodeSize = W_LumpLength(lump);
 
+    ACSCode = NULL;
+    ACSCodeCount = 0;
+    ACSCodeSize = 0;
+    ACSCodeIndex = NULL;
+
     snprintf(EvalContext, sizeof(EvalContext), "header parsing of lump #%d", lump);
 
     header = (const acsHeader_t *) ActionCodeBase;
@@ -442,6 +791,8 @@ void P_LoadACScripts(int lump)
     }
 
     memset(MapVars, 0, sizeof(MapVars));
+
+    DecodeACScripts();
 }
 
 static void StartOpenACS(int number, int infoIndex, int offset)
@@ -639,10 +990,141 @@ void P_ACSInitNewGame(void)
     memset(ACSStore, 0, sizeof(ACSStore));
 }
 
-void T_InterpretACS(acs_t * script)
+// One step of the original interpreter from PCodeOffset
+static int InterpretRaw(void)
 {
     int cmd;
+
+    snprintf(EvalContext, sizeof(EvalContext), "script %d @0x%x",
+             ACSInfo[ACScript->infoIndex].number, PCodeOffset);
+    cmd = ReadCodeInt();
+    snprintf(EvalContext, sizeof(EvalContext), "script %d @0x%x, cmd=%d",
+             ACSInfo[ACScript->infoIndex].number, PCodeOffset, cmd);
+    ACSAssert(cmd >= 0, "negative ACS instruction %d", cmd);
+    ACSAssert(cmd < arrlen(PCodeCmds),
+              "invalid ACS instruction %d (maybe this WAD is designed "
+              "for an advanced source port and is not vanilla "
+              "compatible)", cmd);
+    return PCodeCmds[cmd].cmd();
+}
+
+static int NextInstruction(int index)
+{
+    if (ACSCode[index].next < 0)
+    {
+        int next;
+
+        next = FindInstruction(ACSCode[index].next_offset);
+        ACSCode[index].next = next;
+    }
+
+    return ACSCode[index].next;
+}
+
+static int TargetInstruction(int index)
+{
+    if (ACSCode[index].target < 0)
+    {
+        int target;
+
+        target = FindInstruction(ACSCode[index].target_offset);
+        ACSCode[index].target = target;
+    }
+
+    return ACSCode[index].target;
+}
+
+#ifdef ACS_COMPUTED_GOTO
+#define ACS_CASE(op) op_##op
+#define ACS_JUMP(i) \
+    { \
+        index = (i); \
+        instr = &ACSCode[index]; \
+        CurrentInstr = index; \
+        goto *dispatch[instr->op]; \
+    }
+#else
+#define ACS_CASE(op) case ACS_OP_##op
+#define ACS_JUMP(i) \
+    { \
+        index = (i); \
+        continue; \
+    }
+#endif
+
+#define ACS_NEXT() ACS_JUMP(NextInstruction(index))
+#define ACS_STOP(result) \
+    { \
+        action = (result); \
+        PCodeOffset = instr->next_offset; \
+        goto done; \
+    }
+
+void T_InterpretACS(acs_t * script)
+{
     int action;
+    int index;
+    acsInstr_t *instr;
+
+#ifdef ACS_COMPUTED_GOTO
+    static const void *dispatch[ACS_OP_COUNT] = {
+        [ACS_OP_RAW] = &&op_RAW,
+        [ACS_OP_NOP] = &&op_NOP,
+        [ACS_OP_TERMINATE] = &&op_TERMINATE,
+        [ACS_OP_SUSPEND] = &&op_SUSPEND,
+        [ACS_OP_PUSH_NUMBER] = &&op_PUSH_NUMBER,
+        [ACS_OP_LSPEC] = &&op_LSPEC,
+        [ACS_OP_LSPEC_DIRECT] = &&op_LSPEC_DIRECT,
+        [ACS_OP_ADD] = &&op_ADD,
+        [ACS_OP_SUBTRACT] = &&op_SUBTRACT,
+        [ACS_OP_MULTIPLY] = &&op_MULTIPLY,
+        [ACS_OP_DIVIDE] = &&op_DIVIDE,
+        [ACS_OP_MODULUS] = &&op_MODULUS,
+        [ACS_OP_EQ] = &&op_EQ,
+        [ACS_OP_NE] = &&op_NE,
+        [ACS_OP_LT] = &&op_LT,
+        [ACS_OP_GT] = &&op_GT,
+        [ACS_OP_LE] = &&op_LE,
+        [ACS_OP_GE] = &&op_GE,
+        [ACS_OP_AND_LOGICAL] = &&op_AND_LOGICAL,
+        [ACS_OP_OR_LOGICAL] = &&op_OR_LOGICAL,
+        [ACS_OP_AND_BITWISE] = &&op_AND_BITWISE,
+        [ACS_OP_OR_BITWISE] = &&op_OR_BITWISE,
+        [ACS_OP_EOR_BITWISE] = &&op_EOR_BITWISE,
+        [ACS_OP_NEGATE_LOGICAL] = &&op_NEGATE_LOGICAL,
+        [ACS_OP_LSHIFT] = &&op_LSHIFT,
+        [ACS_OP_RSHIFT] = &&op_RSHIFT,
+        [ACS_OP_UNARY_MINUS] = &&op_UNARY_MINUS,
+        [ACS_OP_ASSIGN_SCRIPT_VAR] = &&op_ASSIGN_SCRIPT_VAR,
+        [ACS_OP_ASSIGN_GLOBAL_VAR] = &&op_ASSIGN_GLOBAL_VAR,
+        [ACS_OP_PUSH_SCRIPT_VAR] = &&op_PUSH_SCRIPT_VAR,
+        [ACS_OP_PUSH_GLOBAL_VAR] = &&op_PUSH_GLOBAL_VAR,
+        [ACS_OP_ADD_SCRIPT_VAR] = &&op_ADD_SCRIPT_VAR,
+        [ACS_OP_ADD_GLOBAL_VAR] = &&op_ADD_GLOBAL_VAR,
+        [ACS_OP_SUB_SCRIPT_VAR] = &&op_SUB_SCRIPT_VAR,
+        [ACS_OP_SUB_GLOBAL_VAR] = &&op_SUB_GLOBAL_VAR,
+        [ACS_OP_MUL_SCRIPT_VAR] = &&op_MUL_SCRIPT_VAR,
+        [ACS_OP_MUL_GLOBAL_VAR] = &&op_MUL_GLOBAL_VAR,
+        [ACS_OP_DIV_SCRIPT_VAR] = &&op_DIV_SCRIPT_VAR,
+        [ACS_OP_DIV_GLOBAL_VAR] = &&op_DIV_GLOBAL_VAR,
+        [ACS_OP_MOD_SCRIPT_VAR] = &&op_MOD_SCRIPT_VAR,
+        [ACS_OP_MOD_GLOBAL_VAR] = &&op_MOD_GLOBAL_VAR,
+        [ACS_OP_INC_SCRIPT_VAR] = &&op_INC_SCRIPT_VAR,
+        [ACS_OP_INC_GLOBAL_VAR] = &&op_INC_GLOBAL_VAR,
+        [ACS_OP_DEC_SCRIPT_VAR] = &&op_DEC_SCRIPT_VAR,
+        [ACS_OP_DEC_GLOBAL_VAR] = &&op_DEC_GLOBAL_VAR,
+        [ACS_OP_GOTO] = &&op_GOTO,
+        [ACS_OP_IF_GOTO] = &&op_IF_GOTO,
+        [ACS_OP_IF_NOT_GOTO] = &&op_IF_NOT_GOTO,
+        [ACS_OP_CASE_GOTO] = &&op_CASE_GOTO,
+        [ACS_OP_DROP] = &&op_DROP,
+        [ACS_OP_DELAY] = &&op_DELAY,
+        [ACS_OP_DELAY_DIRECT] = &&op_DELAY_DIRECT,
+        [ACS_OP_RESTART] = &&op_RESTART,
+        [ACS_OP_LINE_SIDE] = &&op_LINE_SIDE,
+        [ACS_OP_TIMER] = &&op_TIMER,
+    };
+#endif
 
     if (ACSInfo[script->infoIndex].state == ASTE_TERMINATING)
     {
@@ -661,23 +1143,301 @@ void T_InterpretACS(acs_t * script)
         return;
     }
     ACScript = script;
-    PCodeOffset = ACScript->ip;
 
-    do
+    index = FindInstruction(ACScript->ip);
+
+#ifdef ACS_COMPUTED_GOTO
+    ACS_JUMP(index);
+#else
+    while (true)
     {
-        snprintf(EvalContext, sizeof(EvalContext), "script %d @0x%x",
-                 ACSInfo[script->infoIndex].number, PCodeOffset);
-        cmd = ReadCodeInt();
-        snprintf(EvalContext, sizeof(EvalContext), "script %d @0x%x, cmd=%d",
-                 ACSInfo[script->infoIndex].number, PCodeOffset, cmd);
-        ACSAssert(cmd >= 0, "negative ACS instruction %d", cmd);
-        ACSAssert(cmd < arrlen(PCodeCmds),
-                  "invalid ACS instruction %d (maybe this WAD is designed "
-                  "for an advanced source port and is not vanilla "
-                  "compatible)", cmd);
-        action = PCodeCmds[cmd]();
-    } while (action == SCRIPT_CONTINUE);
+        instr = &ACSCode[index];
+        CurrentInstr = index;
+
+        switch (instr->op)
+        {
+#endif
+
+    ACS_CASE(RAW):
+        CurrentInstr = -1;
+        PCodeOffset = instr->offset;
+        action = InterpretRaw();
+        if (action != SCRIPT_CONTINUE)
+        {
+            goto done;
+        }
+        ACS_JUMP(FindInstruction(PCodeOffset));
+
+    ACS_CASE(NOP):
+        ACS_NEXT();
+
+    ACS_CASE(TERMINATE):
+        ACS_STOP(SCRIPT_TERMINATE);
+
+    ACS_CASE(SUSPEND):
+        ACSInfo[ACScript->infoIndex].state = ASTE_SUSPENDED;
+        ACS_STOP(SCRIPT_STOP);
+
+    ACS_CASE(PUSH_NUMBER):
+        Push(instr->args[0]);
+        ACS_NEXT();
+
+    ACS_CASE(LSPEC):
+        {
+            int i;
+
+            for (i = instr->count - 1; i >= 0; i--)
+            {
+                SpecArgs[i] = Pop();
+            }
+        }
+        map_format.execute_line_special(instr->args[0], SpecArgs, ACScript->line,
+                                        ACScript->side, ACScript->activator);
+        ACS_NEXT();
+
+    ACS_CASE(LSPEC_DIRECT):
+        memcpy(SpecArgs, &instr->args[1], instr->count * sizeof(*SpecArgs));
+        map_format.execute_line_special(instr->args[0], SpecArgs, ACScript->line,
+                                        ACScript->side, ACScript->activator);
+        ACS_NEXT();
+
+    ACS_CASE(ADD):
+        Push(Pop() + Pop());
+        ACS_NEXT();
+
+    ACS_CASE(SUBTRACT):
+        {
+            int operand2 = Pop();
+            Push(Pop() - operand2);
+        }
+        ACS_NEXT();
+
+    ACS_CASE(MULTIPLY):
+        Push(Pop() * Pop());
+        ACS_NEXT();
+
+    ACS_CASE(DIVIDE):
+        {
+            int operand2 = Pop();
+            Push(Pop() / operand2);
+        }
+        ACS_NEXT();
+
+    ACS_CASE(MODULUS):
+        {
+            int operand2 = Pop();
+            Push(Pop() % operand2);
+        }
+        ACS_NEXT();
+
+    ACS_CASE(EQ):
+        Push(Pop() == Pop());
+        ACS_NEXT();
+
+    ACS_CASE(NE):
+        Push(Pop() != Pop());
+        ACS_NEXT();
+
+    ACS_CASE(LT):
+        {
+            int operand2 = Pop();
+            Push(Pop() < operand2);
+        }
+        ACS_NEXT();
+
+    ACS_CASE(GT):
+        {
+            int operand2 = Pop();
+            Push(Pop() > operand2);
+        }
+        ACS_NEXT();
+
+    ACS_CASE(LE):
+        {
+            int operand2 = Pop();
+            Push(Pop() <= operand2);
+        }
+        ACS_NEXT();
+
+    ACS_CASE(GE):
+        {
+            int operand2 = Pop();
+            Push(Pop() >= operand2);
+        }
+        ACS_NEXT();
+
+    // Short circuit: the second operand is only popped if needed
+    ACS_CASE(AND_LOGICAL):
+        Push(Pop() && Pop());
+        ACS_NEXT();
+
+    ACS_CASE(OR_LOGICAL):
+        Push(Pop() || Pop());
+        ACS_NEXT();
+
+    ACS_CASE(AND_BITWISE):
+        Push(Pop() & Pop());
+        ACS_NEXT();
+
+    ACS_CASE(OR_BITWISE):
+        Push(Pop() | Pop());
+        ACS_NEXT();
+
+    ACS_CASE(EOR_BITWISE):
+        Push(Pop() ^ Pop());
+        ACS_NEXT();
+
+    ACS_CASE(NEGATE_LOGICAL):
+        Push(!Pop());
+        ACS_NEXT();
+
+    ACS_CASE(LSHIFT):
+        {
+            int operand2 = Pop();
+            Push(Pop() << operand2);
+        }
+        ACS_NEXT();
+
+    ACS_CASE(RSHIFT):
+        {
+            int operand2 = Pop();
+            Push(Pop() >> operand2);
+        }
+        ACS_NEXT();
+
+    ACS_CASE(UNARY_MINUS):
+        Push(-Pop());
+        ACS_NEXT();
+
+    ACS_CASE(ASSIGN_SCRIPT_VAR):
+        ACScript->vars[instr->args[0]] = Pop();
+        ACS_NEXT();
+
+    ACS_CASE(ASSIGN_GLOBAL_VAR):
+        *instr->var = Pop();
+        ACS_NEXT();
+
+    ACS_CASE(PUSH_SCRIPT_VAR):
+        Push(ACScript->vars[instr->args[0]]);
+        ACS_NEXT();
+
+    ACS_CASE(PUSH_GLOBAL_VAR):
+        Push(*instr->var);
+        ACS_NEXT();
+
+    ACS_CASE(ADD_SCRIPT_VAR):
+        ACScript->vars[instr->args[0]] += Pop();
+        ACS_NEXT();
+
+    ACS_CASE(ADD_GLOBAL_VAR):
+        *instr->var += Pop();
+        ACS_NEXT();
+
+    ACS_CASE(SUB_SCRIPT_VAR):
+        ACScript->vars[instr->args[0]] -= Pop();
+        ACS_NEXT();
+
+    ACS_CASE(SUB_GLOBAL_VAR):
+        *instr->var -= Pop();
+        ACS_NEXT();
+
+    ACS_CASE(MUL_SCRIPT_VAR):
+        ACScript->vars[instr->args[0]] *= Pop();
+        ACS_NEXT();
+
+    ACS_CASE(MUL_GLOBAL_VAR):
+        *instr->var *= Pop();
+        ACS_NEXT();
+
+    ACS_CASE(DIV_SCRIPT_VAR):
+        ACScript->vars[instr->args[0]] /= Pop();
+        ACS_NEXT();
+
+    ACS_CASE(DIV_GLOBAL_VAR):
+        *instr->var /= Pop();
+        ACS_NEXT();
+
+    ACS_CASE(MOD_SCRIPT_VAR):
+        ACScript->vars[instr->args[0]] %= Pop();
+        ACS_NEXT();
+
+    ACS_CASE(MOD_GLOBAL_VAR):
+        *instr->var %= Pop();
+        ACS_NEXT();
+
+    ACS_CASE(INC_SCRIPT_VAR):
+        ++ACScript->vars[instr->args[0]];
+        ACS_NEXT();
+
+    ACS_CASE(INC_GLOBAL_VAR):
+        ++*instr->var;
+        ACS_NEXT();
+
+    ACS_CASE(DEC_SCRIPT_VAR):
+        --ACScript->vars[instr->args[0]];
+        ACS_NEXT();
+
+    ACS_CASE(DEC_GLOBAL_VAR):
+        --*instr->var;
+        ACS_NEXT();
+
+    ACS_CASE(GOTO):
+        ACS_JUMP(TargetInstruction(index));
+
+    ACS_CASE(IF_GOTO):
+        if (Pop() != 0)
+        {
+            ACS_JUMP(TargetInstruction(index));
+        }
+        ACS_NEXT();
+
+    ACS_CASE(IF_NOT_GOTO):
+        if (Pop() == 0)
+        {
+            ACS_JUMP(TargetInstruction(index));
+        }
+        ACS_NEXT();
+
+    ACS_CASE(CASE_GOTO):
+        if (Top() == instr->args[0])
+        {
+            Drop();
+            ACS_JUMP(TargetInstruction(index));
+        }
+        ACS_NEXT();
+
+    ACS_CASE(DROP):
+        Drop();
+        ACS_NEXT();
+
+    ACS_CASE(DELAY):
+        ACScript->delayCount = Pop();
+        ACS_STOP(SCRIPT_STOP);
+
+    ACS_CASE(DELAY_DIRECT):
+        ACScript->delayCount = instr->args[0];
+        ACS_STOP(SCRIPT_STOP);
+
+    ACS_CASE(RESTART):
+        ACS_JUMP(FindInstruction(ACSInfo[ACScript->infoIndex].offset));
+
+    ACS_CASE(LINE_SIDE):
+        Push(ACScript->side);
+        ACS_NEXT();
+
+    ACS_CASE(TIMER):
+        Push(leveltime);
+        ACS_NEXT();
+
+#ifndef ACS_COMPUTED_GOTO
+        default:
+            I_Error("T_InterpretACS: unknown decoded operation %d", instr->op);
+        }
+    }
+#endif
 
+done:
+    CurrentInstr = -1;
     ACScript->ip = PCodeOffset;
 
     if (action == SCRIPT_TERMINATE)
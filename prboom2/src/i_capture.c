@@ -39,7 +39,9 @@
 #include "m_file.h"
 #include "i_system.h"
 #include "i_capture.h"
+#include "v_video.h"
 
+#include "dsda/capture_pipeline.h"
 #include "dsda/configuration.h"
 
 int capturing_video = 0;
@@ -72,6 +74,7 @@ int cap_wipescreen;
 // %h video height (px)
 // %s sound rate (hz)
 // %f filename passed to -viddump
+// %p raw video pixel format
 // %% single percent sign
 // TODO: add aspect ratio information
 //
@@ -88,10 +91,15 @@ static int parsecommand (char *out, const char *in, int len)
       switch (in[1])
       {
         case 'w':
-          i = snprintf (out, len, "%u", renderW);
+          i = snprintf (out, len, "%u", dsda_CapturePipelineActive() ?
+                        dsda_CapturePipelineWidth() : renderW);
           break;
         case 'h':
-          i = snprintf (out, len, "%u", renderH);
+          i = snprintf (out, len, "%u", dsda_CapturePipelineActive() ?
+                        dsda_CapturePipelineHeight() : renderH);
+          break;
+        case 'p':
+          i = snprintf (out, len, "%s", dsda_CapturePixelFormat());
           break;
         case 's':
           i = snprintf (out, len, "%u", snd_samplerate);
@@ -504,21 +512,31 @@ void I_CapturePrep (const char *fn)
 
   vid_fname = fn;
 
+  // Software frames are converted off the game thread when cap_threads is set
+  if (V_IsSoftwareMode() && dsda_IntConfig(dsda_config_cap_threads))
+  {
+    dsda_InitCapturePipeline(SCREENWIDTH, SCREENHEIGHT);
+    dsda_StartCapturePipeline();
+  }
+
   if (!parsecommand (soundpipe.command, cap_soundcommand, sizeof(soundpipe.command)))
   {
     lprintf (LO_ERROR, "I_CapturePrep: malformed command %s\n", cap_soundcommand);
+    dsda_FinishCapturePipeline();
     capturing_video = 0;
     return;
   }
   if (!parsecommand (videopipe.command, cap_videocommand, sizeof(videopipe.command)))
   {
     lprintf (LO_ERROR, "I_CapturePrep: malformed command %s\n", cap_videocommand);
+    dsda_FinishCapturePipeline();
     capturing_video = 0;
     return;
   }
   if (!parsecommand (muxpipe.command, cap_muxcommand, sizeof(muxpipe.command)))
   {
     lprintf (LO_ERROR, "I_CapturePrep: malformed command %s\n", cap_muxcommand);
+    dsda_FinishCapturePipeline();
     capturing_video = 0;
     return;
   }
@@ -527,6 +545,7 @@ void I_CapturePrep (const char *fn)
   if (!my_popen3 (&soundpipe))
   {
     lprintf (LO_ERROR, "I_CapturePrep: sound pipe failed\n");
+    dsda_FinishCapturePipeline();
     capturing_video = 0;
     return;
   }
@@ -535,10 +554,14 @@ void I_CapturePrep (const char *fn)
   {
     lprintf (LO_ERROR, "I_CapturePrep: video pipe failed\n");
     my_pclose3 (&soundpipe);
+    dsda_FinishCapturePipeline();
     capturing_video = 0;
     return;
   }
   I_SetSoundCap ();
+
+  dsda_SetCapturePipelineOutput(videopipe.f_stdin);
+
   lprintf (LO_INFO, "I_CapturePrep: video capture started\n");
   capturing_video = 1;
 
@@ -585,6 +608,13 @@ void I_CaptureFrame (void)
       lprintf(LO_WARN, "I_CaptureFrame: error writing soundpipe.\n");
     //Z_Free (snd); // static buffer
   }
+
+  if (dsda_CapturePipelineActive())
+  {
+    dsda_QueueCaptureFrame(screens[0].data, screens[0].pitch, I_ScreenPalette());
+    return;
+  }
+
   vid = I_GrabScreen ();
   if (vid)
   {
@@ -605,6 +635,9 @@ void I_CaptureFinish (void)
     return;
   capturing_video = 0;
 
+  // the pipeline writes to videopipe until its queue is drained
+  dsda_FinishCapturePipeline();
+
   // on linux, we have to close videopipe first, because it has a copy of the write
   // end of soundpipe_stdin (so that stream will never see EOF).
   // is there a better way to do this?
@@ -72,6 +72,10 @@ int I_ScreenShot (const char *fname);
 // NSM expose lower level screen data grab for vidcap
 unsigned char *I_GrabScreen (void);
 
+dboolean I_Headless(void);
+const SDL_Color *I_ScreenPalette(void);
+void I_ReadHeadlessPixels(unsigned char *pixels);
+
 /* I_StartTic
  * Called by D_DoomLoop,
  * called before processing each tic in a frame.
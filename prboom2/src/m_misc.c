@@ -163,6 +163,7 @@ cfg_def_t cfg_defs[] =
   MIGRATED_SETTING(dsda_config_render_patches_scalex),
   MIGRATED_SETTING(dsda_config_render_patches_scaley),
   MIGRATED_SETTING(dsda_config_render_stretchsky),
+  MIGRATED_SETTING(dsda_config_patch_cache_mb),
   MIGRATED_SETTING(dsda_config_freelook),
 
   SETTING_HEADING("OpenGL settings"),
@@ -270,6 +271,7 @@ cfg_def_t cfg_defs[] =
   MIGRATED_SETTING(dsda_config_auto_key_frame_interval),
   MIGRATED_SETTING(dsda_config_auto_key_frame_depth),
   MIGRATED_SETTING(dsda_config_auto_key_frame_timeout),
+  MIGRATED_SETTING(dsda_config_auto_key_frame_memory),
   MIGRATED_SETTING(dsda_config_exhud),
   MIGRATED_SETTING(dsda_config_ex_text_scale_x),
   MIGRATED_SETTING(dsda_config_ex_text_ratio_y),
@@ -326,6 +328,10 @@ cfg_def_t cfg_defs[] =
   MIGRATED_SETTING(dsda_config_cap_remove_tempfiles),
   MIGRATED_SETTING(dsda_config_cap_wipescreen),
   MIGRATED_SETTING(dsda_config_cap_fps),
+  MIGRATED_SETTING(dsda_config_cap_scale),
+  MIGRATED_SETTING(dsda_config_cap_aspect),
+  MIGRATED_SETTING(dsda_config_cap_yuv420),
+  MIGRATED_SETTING(dsda_config_cap_threads),
 
   SETTING_HEADING("Overrun settings"),
   MIGRATED_SETTING(dsda_config_overrun_spechit_warn),
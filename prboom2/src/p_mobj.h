@@ -412,6 +412,7 @@ typedef struct mobj_s
     int damageDealt;
     int selfDamage;
     double distanceTraveled;
+    int trajectory_id;
 
     // SEE WARNING ABOVE ABOUT POINTER FIELDS!!!
 } mobj_t;
@@ -31,6 +31,7 @@
  *
  *-----------------------------------------------------------------------------*/
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "doomstat.h"
@@ -157,95 +158,182 @@ void P_UnArchivePlayers (void)
 }
 
 
+// Archived fields in archive order. Fields that are also adjacent in the
+// struct are merged into runs once, so each run is a single copy.
+typedef struct {
+  size_t offset;
+  size_t size;
+} save_field_t;
+
+#define SAVE_FIELD(type, field) { offsetof(type, field), sizeof(((type *) 0)->field) }
+
+static save_field_t sector_save_fields[] = {
+  SAVE_FIELD(sector_t, floorheight),
+  SAVE_FIELD(sector_t, ceilingheight),
+  SAVE_FIELD(sector_t, floorpic),
+  SAVE_FIELD(sector_t, ceilingpic),
+  SAVE_FIELD(sector_t, lightlevel),
+  SAVE_FIELD(sector_t, special),
+  SAVE_FIELD(sector_t, tag),
+  SAVE_FIELD(sector_t, seqType),
+  SAVE_FIELD(sector_t, flags),
+
+  // zdoom
+  SAVE_FIELD(sector_t, gravity),
+  SAVE_FIELD(sector_t, damage),
+  SAVE_FIELD(sector_t, lightlevel_floor),
+  SAVE_FIELD(sector_t, lightlevel_ceiling),
+  SAVE_FIELD(sector_t, floor_rotation),
+  SAVE_FIELD(sector_t, ceiling_rotation),
+  SAVE_FIELD(sector_t, floor_xscale),
+  SAVE_FIELD(sector_t, floor_yscale),
+  SAVE_FIELD(sector_t, ceiling_xscale),
+  SAVE_FIELD(sector_t, ceiling_yscale),
+  SAVE_FIELD(sector_t, floor_xoffs),
+  SAVE_FIELD(sector_t, floor_yoffs),
+  SAVE_FIELD(sector_t, ceiling_xoffs),
+  SAVE_FIELD(sector_t, ceiling_yoffs),
+};
+
+static save_field_t line_save_fields[] = {
+  SAVE_FIELD(line_t, flags),
+  SAVE_FIELD(line_t, special),
+  SAVE_FIELD(line_t, tag),
+  SAVE_FIELD(line_t, player_activations),
+  SAVE_FIELD(line_t, special_args),
+
+  // zdoom
+  SAVE_FIELD(line_t, automap_style),
+  SAVE_FIELD(line_t, health),
+  SAVE_FIELD(line_t, alpha),
+};
+
+static save_field_t side_save_fields[] = {
+  SAVE_FIELD(side_t, textureoffset),
+  SAVE_FIELD(side_t, rowoffset),
+  SAVE_FIELD(side_t, toptexture),
+  SAVE_FIELD(side_t, bottomtexture),
+  SAVE_FIELD(side_t, midtexture),
+};
+
+static save_field_t zdoom_side_save_fields[] = {
+  SAVE_FIELD(side_t, textureoffset_top),
+  SAVE_FIELD(side_t, textureoffset_mid),
+  SAVE_FIELD(side_t, textureoffset_bottom),
+  SAVE_FIELD(side_t, rowoffset_top),
+  SAVE_FIELD(side_t, rowoffset_mid),
+  SAVE_FIELD(side_t, rowoffset_bottom),
+  SAVE_FIELD(side_t, scalex_top),
+  SAVE_FIELD(side_t, scaley_top),
+  SAVE_FIELD(side_t, scalex_mid),
+  SAVE_FIELD(side_t, scaley_mid),
+  SAVE_FIELD(side_t, scalex_bottom),
+  SAVE_FIELD(side_t, scaley_bottom),
+  SAVE_FIELD(side_t, lightlevel),
+  SAVE_FIELD(side_t, lightlevel_top),
+  SAVE_FIELD(side_t, lightlevel_mid),
+  SAVE_FIELD(side_t, lightlevel_bottom),
+  SAVE_FIELD(side_t, flags),
+};
+
+typedef struct {
+  save_field_t *fields;
+  int count;
+  size_t size;
+} save_layout_t;
+
+#define SAVE_LAYOUT(fields) { fields, sizeof(fields) / sizeof(fields[0]), 0 }
+
+static save_layout_t sector_save_layout = SAVE_LAYOUT(sector_save_fields);
+static save_layout_t line_save_layout = SAVE_LAYOUT(line_save_fields);
+static save_layout_t side_save_layout = SAVE_LAYOUT(side_save_fields);
+static save_layout_t zdoom_side_save_layout = SAVE_LAYOUT(zdoom_side_save_fields);
+
+static void P_PackSaveLayout(save_layout_t *layout)
+{
+  int i;
+  int count = 0;
+
+  for (i = 0; i < layout->count; i++)
+  {
+    save_field_t *field = &layout->fields[i];
+
+    layout->size += field->size;
+
+    if (count && layout->fields[count - 1].offset + layout->fields[count - 1].size == field->offset)
+      layout->fields[count - 1].size += field->size;
+    else
+      layout->fields[count++] = *field;
+  }
+
+  layout->count = count;
+}
+
+static void P_WriteSaveLayout(const void *base, const save_layout_t *layout)
+{
+  int i;
+
+  for (i = 0; i < layout->count; i++)
+    P_WRITE_SIZE((const byte *) base + layout->fields[i].offset, layout->fields[i].size);
+}
+
 //
 // P_ArchiveWorld
 //
 void P_ArchiveWorld (void)
 {
+  static dboolean layouts_packed;
   int            i;
+  int            side_count;
+  size_t         side_size;
   const sector_t *sec;
   const line_t   *li;
   const side_t   *si;
 
-  for (i = 0, sec = sectors; i < numsectors; i++, sec++)
+  if (!layouts_packed)
   {
-    P_SAVE_X(sec->floorheight);
-    P_SAVE_X(sec->ceilingheight);
-    P_SAVE_X(sec->floorpic);
-    P_SAVE_X(sec->ceilingpic);
-    P_SAVE_X(sec->lightlevel);
-    P_SAVE_X(sec->special);
-    P_SAVE_X(sec->tag);
-    P_SAVE_X(sec->seqType);
-    P_SAVE_X(sec->flags);
-
-    // zdoom
-    P_SAVE_X(sec->gravity);
-    P_SAVE_X(sec->damage);
-    P_SAVE_X(sec->lightlevel_floor);
-    P_SAVE_X(sec->lightlevel_ceiling);
-    P_SAVE_X(sec->floor_rotation);
-    P_SAVE_X(sec->ceiling_rotation);
-    P_SAVE_X(sec->floor_xscale);
-    P_SAVE_X(sec->floor_yscale);
-    P_SAVE_X(sec->ceiling_xscale);
-    P_SAVE_X(sec->ceiling_yscale);
-    P_SAVE_X(sec->floor_xoffs);
-    P_SAVE_X(sec->floor_yoffs);
-    P_SAVE_X(sec->ceiling_xoffs);
-    P_SAVE_X(sec->ceiling_yoffs);
+    layouts_packed = true;
+    P_PackSaveLayout(&sector_save_layout);
+    P_PackSaveLayout(&line_save_layout);
+    P_PackSaveLayout(&side_save_layout);
+    P_PackSaveLayout(&zdoom_side_save_layout);
   }
 
+  side_count = 0;
+  for (i = 0, li = lines; i < numlines; i++, li++)
+    side_count += (li->sidenum[0] != NO_INDEX) + (li->sidenum[1] != NO_INDEX);
+
+  side_size = side_save_layout.size;
+  if (map_format.zdoom)
+    side_size += zdoom_side_save_layout.size;
+
+  CheckSaveGame(numsectors * sector_save_layout.size +
+                numlines * line_save_layout.size +
+                side_count * side_size +
+                sizeof(musinfo.current_item));
+
+  for (i = 0, sec = sectors; i < numsectors; i++, sec++)
+    P_WriteSaveLayout(sec, &sector_save_layout);
+
   for (i = 0, li = lines; i < numlines; i++, li++)
   {
     int j;
 
-    P_SAVE_X(li->flags);
-    P_SAVE_X(li->special);
-    P_SAVE_X(li->tag);
-    P_SAVE_BYTE(li->player_activations);
-    P_SAVE_ARRAY(li->special_args);
-
-    // zdoom
-    P_SAVE_X(li->automap_style);
-    P_SAVE_X(li->health);
-    P_SAVE_X(li->alpha);
+    P_WriteSaveLayout(li, &line_save_layout);
 
     for (j = 0; j < 2; j++)
       if (li->sidenum[j] != NO_INDEX)
       {
         si = &sides[li->sidenum[j]];
 
-        P_SAVE_X(si->textureoffset);
-        P_SAVE_X(si->rowoffset);
-        P_SAVE_X(si->toptexture);
-        P_SAVE_X(si->bottomtexture);
-        P_SAVE_X(si->midtexture);
+        P_WriteSaveLayout(si, &side_save_layout);
 
         if (map_format.zdoom)
-        {
-          P_SAVE_X(si->textureoffset_top);
-          P_SAVE_X(si->textureoffset_mid);
-          P_SAVE_X(si->textureoffset_bottom);
-          P_SAVE_X(si->rowoffset_top);
-          P_SAVE_X(si->rowoffset_mid);
-          P_SAVE_X(si->rowoffset_bottom);
-          P_SAVE_X(si->scalex_top);
-          P_SAVE_X(si->scaley_top);
-          P_SAVE_X(si->scalex_mid);
-          P_SAVE_X(si->scaley_mid);
-          P_SAVE_X(si->scalex_bottom);
-          P_SAVE_X(si->scaley_bottom);
-          P_SAVE_X(si->lightlevel);
-          P_SAVE_X(si->lightlevel_top);
-          P_SAVE_X(si->lightlevel_mid);
-          P_SAVE_X(si->lightlevel_bottom);
-          P_SAVE_X(si->flags);
-        }
+          P_WriteSaveLayout(si, &zdoom_side_save_layout);
       }
   }
 
-  P_SAVE_X(musinfo.current_item);
+  P_WRITE_X(musinfo.current_item);
 }
 
 
@@ -501,11 +589,12 @@ void P_ArchiveThinkerSubclass(th_class class)
   for (th = cap->cnext; th != cap; th = th->cnext)
     count++;
 
-  P_SAVE_X(count);
+  CheckSaveGame(sizeof(count) + count * sizeof(th->prev));
+  P_WRITE_X(count);
 
   for (th = cap->cnext; th != cap; th = th->cnext)
   {
-    P_SAVE_X(th->prev);
+    P_WRITE_X(th->prev);
   }
 }
 
@@ -588,12 +677,13 @@ void P_ArchiveBlockLinks(void)
       mobj = mobj->bnext;
     }
 
-    P_SAVE_X(count);
+    CheckSaveGame(sizeof(count) + count * sizeof(mobj->thinker.prev));
+    P_WRITE_X(count);
 
     mobj = blocklinks[i];
     while (mobj)
     {
-      P_SAVE_X(mobj->thinker.prev);
+      P_WRITE_X(mobj->thinker.prev);
       mobj = mobj->bnext;
     }
   }
@@ -744,391 +834,415 @@ typedef enum {
   tc_end
 } true_thinkerclass_t;
 
-// dsda - fix save / load synchronization
-// merges P_ArchiveThinkers & P_ArchiveSpecials
-void P_ArchiveThinkers(void) {
-  thinker_t *th;
+// Archive class of a thinker, or tc_end if it isn't archived
+static true_thinkerclass_t P_ThinkerArchiveClass(thinker_t *th)
+{
+  if (!th->function)
+  {
+    platlist_t *pl;
+    ceilinglist_t *cl;    //jff 2/22/98 add iter variable for ceilings
 
-  P_SAVE_X(brain);
+    // killough 2/8/98: fix plat original height bug.
+    // Since acv==NULL, this could be a plat in stasis.
+    // so check the active plats list, and save this
+    // plat (jff: or ceiling) even if it is in stasis.
 
-  // save off the current thinkers
-  for (th = thinkercap.next ; th != &thinkercap ; th=th->next) {
-    if (!th->function)
-    {
-      platlist_t *pl;
-      ceilinglist_t *cl;    //jff 2/22/98 add iter variable for ceilings
+    for (pl=activeplats; pl; pl=pl->next)
+      if (pl->plat == (plat_t *) th)      // killough 2/14/98
+        return tc_plat;
 
-      // killough 2/8/98: fix plat original height bug.
-      // Since acv==NULL, this could be a plat in stasis.
-      // so check the active plats list, and save this
-      // plat (jff: or ceiling) even if it is in stasis.
+    for (cl=activeceilings; cl; cl=cl->next)
+      if (cl->ceiling == (ceiling_t *) th)      //jff 2/22/98
+        return tc_ceiling;
 
-      for (pl=activeplats; pl; pl=pl->next)
-        if (pl->plat == (plat_t *) th)      // killough 2/14/98
-          goto plat;
+    return tc_end;
+  }
 
-      for (cl=activeceilings; cl; cl=cl->next)
-        if (cl->ceiling == (ceiling_t *) th)      //jff 2/22/98
-          goto ceiling;
+  if (th->function == T_MoveCeiling)                    return tc_ceiling;
+  if (th->function == T_VerticalDoor)                   return tc_door;
+  if (th->function == T_MoveFloor)                      return tc_floor;
+  if (th->function == T_PlatRaise)                      return tc_plat;
+  if (th->function == T_LightFlash)                     return tc_flash;
+  if (th->function == T_StrobeFlash)                    return tc_strobe;
+  if (th->function == T_Glow)                           return tc_glow;
+  if (th->function == T_ZDoom_Glow)                     return tc_zdoom_glow;
+  if (th->function == T_FireFlicker)                    return tc_flicker;
+  if (th->function == T_ZDoom_Flicker)                  return tc_zdoom_flicker;
+  if (th->function == T_MoveElevator)                   return tc_elevator;
+  if (th->function == dsda_UpdateSideScroller)          return tc_scroll_side;
+  if (th->function == dsda_UpdateFloorScroller)         return tc_scroll_floor;
+  if (th->function == dsda_UpdateCeilingScroller)       return tc_scroll_ceiling;
+  if (th->function == dsda_UpdateFloorCarryScroller)    return tc_scroll_floor_carry;
+  if (th->function == dsda_UpdateZDoomFloorScroller)    return tc_zdoom_scroll_floor;
+  if (th->function == dsda_UpdateZDoomCeilingScroller)  return tc_zdoom_scroll_ceiling;
+  if (th->function == dsda_UpdateThruster)              return tc_thrust;
+  if (th->function == dsda_UpdateControlSideScroller)   return tc_scroll_side_control;
+  if (th->function == dsda_UpdateControlFloorScroller)  return tc_scroll_floor_control;
+  if (th->function == dsda_UpdateControlCeilingScroller)
+    return tc_scroll_ceiling_control;
+  if (th->function == dsda_UpdateControlFloorCarryScroller)
+    return tc_scroll_floor_carry_control;
+  if (th->function == T_Pusher)                         return tc_pusher;
+  if (th->function == T_Friction)                       return tc_friction;
+  if (th->function == T_Light)                          return tc_light;
+  if (th->function == T_Phase)                          return tc_phase;
+  if (th->function == T_InterpretACS)                   return tc_acs;
+  if (th->function == T_BuildPillar)                    return tc_pillar;
+  if (th->function == T_FloorWaggle)                    return tc_floor_waggle;
+  if (th->function == T_CeilingWaggle)                  return tc_ceiling_waggle;
+  if (th->function == T_RotatePoly)                     return tc_poly_rotate;
+  if (th->function == T_MovePoly)                       return tc_poly_move;
+  if (th->function == T_PolyDoor)                       return tc_poly_door;
+  if (th->function == dsda_UpdateQuake)                 return tc_quake;
+  if (th->function == dsda_UpdateAmbientSource)         return tc_ambient_source;
+
+  if (P_IsMobjThinker(th))
+    return tc_mobj;
+
+  return tc_end;
+}
 
-      continue;
-    }
+static size_t P_ThinkerArchiveSize(true_thinkerclass_t tc)
+{
+  switch (tc)
+  {
+    case tc_mobj:                       return sizeof(mobj_t);
+    case tc_ceiling:                    return sizeof(ceiling_t);
+    case tc_door:                       return sizeof(vldoor_t);
+    case tc_floor:                      return sizeof(floormove_t);
+    case tc_plat:                       return sizeof(plat_t);
+    case tc_flash:                      return sizeof(lightflash_t);
+    case tc_strobe:                     return sizeof(strobe_t);
+    case tc_glow:                       return sizeof(glow_t);
+    case tc_zdoom_glow:                 return sizeof(zdoom_glow_t);
+    case tc_elevator:                   return sizeof(elevator_t);
+    case tc_scroll_side:
+    case tc_scroll_floor:
+    case tc_scroll_ceiling:
+    case tc_scroll_floor_carry:
+    case tc_zdoom_scroll_floor:
+    case tc_zdoom_scroll_ceiling:
+    case tc_thrust:                     return sizeof(scroll_t);
+    case tc_scroll_side_control:
+    case tc_scroll_floor_control:
+    case tc_scroll_ceiling_control:
+    case tc_scroll_floor_carry_control: return sizeof(control_scroll_t);
+    case tc_pusher:                     return sizeof(pusher_t);
+    case tc_flicker:                    return sizeof(fireflicker_t);
+    case tc_zdoom_flicker:              return sizeof(zdoom_flicker_t);
+    case tc_friction:                   return sizeof(friction_t);
+    case tc_light:                      return sizeof(light_t);
+    case tc_phase:                      return sizeof(phase_t);
+    case tc_acs:                        return sizeof(acs_t);
+    case tc_pillar:                     return sizeof(pillar_t);
+    case tc_floor_waggle:
+    case tc_ceiling_waggle:             return sizeof(planeWaggle_t);
+    case tc_poly_rotate:
+    case tc_poly_move:                  return sizeof(polyevent_t);
+    case tc_poly_door:                  return sizeof(polydoor_t);
+    case tc_quake:                      return sizeof(quake_t);
+    case tc_ambient_source:             return sizeof(ambient_source_t);
+    default:                            return 0;
+  }
+}
 
-    if (th->function == T_MoveCeiling)
-    {
-      ceiling_t *ceiling;
-    ceiling:                               // killough 2/14/98
-      P_SAVE_BYTE(tc_ceiling);
-      P_SAVE_TYPE_REF(th, ceiling, ceiling_t);
-      ceiling->sector = (sector_t *)(intptr_t)(ceiling->sector->iSectorID);
-      continue;
-    }
+static byte *thinker_archive_classes;
+static int thinker_archive_classes_max;
 
-    if (th->function == T_VerticalDoor)
-    {
-      vldoor_t *door;
-      P_SAVE_BYTE(tc_door);
-      P_SAVE_TYPE_REF(th, door, vldoor_t);
-      door->sector = (sector_t *)(intptr_t)(door->sector->iSectorID);
-      //jff 1/31/98 archive line remembered by door as well
-      door->line = (line_t *) (door->line ? door->line-lines : -1);
-      continue;
-    }
+// dsda - fix save / load synchronization
+// merges P_ArchiveThinkers & P_ArchiveSpecials
+// The thinkers are classified and sized in a first pass, so the whole
+// section is reserved once and written without per field checks
+void P_ArchiveThinkers(void) {
+  thinker_t *th;
+  size_t size;
+  int count;
+  int i;
 
-    if (th->function == T_MoveFloor)
-    {
-      floormove_t *floor;
-      P_SAVE_BYTE(tc_floor);
-      P_SAVE_TYPE_REF(th, floor, floormove_t);
-      floor->sector = (sector_t *)(intptr_t)(floor->sector->iSectorID);
-      continue;
-    }
+  size = sizeof(brain) + 1; // brain and the terminating marker
+  count = 0;
 
-    if (th->function == T_PlatRaise)
-    {
-      plat_t *plat;
-    plat:   // killough 2/14/98: added fix for original plat height above
-      P_SAVE_BYTE(tc_plat);
-      P_SAVE_TYPE_REF(th, plat, plat_t);
-      plat->sector = (sector_t *)(intptr_t)(plat->sector->iSectorID);
-      continue;
-    }
+  for (th = thinkercap.next ; th != &thinkercap ; th=th->next) {
+    true_thinkerclass_t tc;
 
-    if (th->function == T_LightFlash)
-    {
-      lightflash_t *flash;
-      P_SAVE_BYTE(tc_flash);
-      P_SAVE_TYPE_REF(th, flash, lightflash_t);
-      flash->sector = (sector_t *)(intptr_t)(flash->sector->iSectorID);
-      continue;
+    if (count == thinker_archive_classes_max) {
+      thinker_archive_classes_max = thinker_archive_classes_max ? thinker_archive_classes_max * 2 : 1024;
+      thinker_archive_classes = Z_Realloc(thinker_archive_classes, thinker_archive_classes_max);
     }
 
-    if (th->function == T_StrobeFlash)
-    {
-      strobe_t *strobe;
-      P_SAVE_BYTE(tc_strobe);
-      P_SAVE_TYPE_REF(th, strobe, strobe_t);
-      strobe->sector = (sector_t *)(intptr_t)(strobe->sector->iSectorID);
-      continue;
-    }
+    tc = P_ThinkerArchiveClass(th);
+    thinker_archive_classes[count++] = tc;
 
-    if (th->function == T_Glow)
-    {
-      glow_t *glow;
-      P_SAVE_BYTE(tc_glow);
-      P_SAVE_TYPE_REF(th, glow, glow_t);
-      glow->sector = (sector_t *)(intptr_t)(glow->sector->iSectorID);
-      continue;
-    }
+    if (tc != tc_end)
+      size += 1 + P_ThinkerArchiveSize(tc);
+  }
 
-    if (th->function == T_ZDoom_Glow)
-    {
-      zdoom_glow_t *glow;
-      P_SAVE_BYTE(tc_zdoom_glow);
-      P_SAVE_TYPE_REF(th, glow, zdoom_glow_t);
-      glow->sector = (sector_t *)(intptr_t)(glow->sector->iSectorID);
-      continue;
-    }
+  CheckSaveGame(size);
 
-    // killough 10/4/98: save flickers
-    if (th->function == T_FireFlicker)
-    {
-      fireflicker_t *flicker;
-      P_SAVE_BYTE(tc_flicker);
-      P_SAVE_TYPE_REF(th, flicker, fireflicker_t);
-      flicker->sector = (sector_t *)(intptr_t)(flicker->sector->iSectorID);
-      continue;
-    }
+  P_WRITE_X(brain);
 
-    if (th->function == T_ZDoom_Flicker)
-    {
-      zdoom_flicker_t *flicker;
-      P_SAVE_BYTE(tc_zdoom_flicker);
-      P_SAVE_TYPE_REF(th, flicker, zdoom_flicker_t);
-      flicker->sector = (sector_t *)(intptr_t)(flicker->sector->iSectorID);
-      continue;
-    }
+  // save off the current thinkers
+  for (th = thinkercap.next, i = 0 ; th != &thinkercap ; th=th->next, ++i) {
+    true_thinkerclass_t tc = thinker_archive_classes[i];
 
-    //jff 2/22/98 new case for elevators
-    if (th->function == T_MoveElevator)
-    {
-      elevator_t *elevator;         //jff 2/22/98
-      P_SAVE_BYTE(tc_elevator);
-      P_SAVE_TYPE_REF(th, elevator, elevator_t);
-      elevator->sector = (sector_t *)(intptr_t)(elevator->sector->iSectorID);
+    if (tc == tc_end)
       continue;
-    }
 
-    if (th->function == dsda_UpdateSideScroller)
-    {
-      P_SAVE_BYTE(tc_scroll_side);
-      P_SAVE_TYPE(th, scroll_t);
-      continue;
-    }
+    P_WRITE_BYTE(tc);
 
-    if (th->function == dsda_UpdateFloorScroller)
+    switch (tc)
     {
-      P_SAVE_BYTE(tc_scroll_floor);
-      P_SAVE_TYPE(th, scroll_t);
-      continue;
-    }
+      case tc_ceiling:
+      {
+        ceiling_t *ceiling;
+        P_WRITE_TYPE_REF(th, ceiling, ceiling_t);
+        ceiling->sector = (sector_t *)(intptr_t)(ceiling->sector->iSectorID);
+        break;
+      }
 
-    if (th->function == dsda_UpdateCeilingScroller)
-    {
-      P_SAVE_BYTE(tc_scroll_ceiling);
-      P_SAVE_TYPE(th, scroll_t);
-      continue;
-    }
+      case tc_door:
+      {
+        vldoor_t *door;
+        P_WRITE_TYPE_REF(th, door, vldoor_t);
+        door->sector = (sector_t *)(intptr_t)(door->sector->iSectorID);
+        //jff 1/31/98 archive line remembered by door as well
+        door->line = (line_t *) (door->line ? door->line-lines : -1);
+        break;
+      }
 
-    if (th->function == dsda_UpdateFloorCarryScroller)
-    {
-      P_SAVE_BYTE(tc_scroll_floor_carry);
-      P_SAVE_TYPE(th, scroll_t);
-      continue;
-    }
+      case tc_floor:
+      {
+        floormove_t *floor;
+        P_WRITE_TYPE_REF(th, floor, floormove_t);
+        floor->sector = (sector_t *)(intptr_t)(floor->sector->iSectorID);
+        break;
+      }
 
-    if (th->function == dsda_UpdateZDoomFloorScroller)
-    {
-      P_SAVE_BYTE(tc_zdoom_scroll_floor);
-      P_SAVE_TYPE(th, scroll_t);
-      continue;
-    }
+      case tc_plat:
+      {
+        plat_t *plat;
+        P_WRITE_TYPE_REF(th, plat, plat_t);
+        plat->sector = (sector_t *)(intptr_t)(plat->sector->iSectorID);
+        break;
+      }
 
-    if (th->function == dsda_UpdateZDoomCeilingScroller)
-    {
-      P_SAVE_BYTE(tc_zdoom_scroll_ceiling);
-      P_SAVE_TYPE(th, scroll_t);
-      continue;
-    }
+      case tc_flash:
+      {
+        lightflash_t *flash;
+        P_WRITE_TYPE_REF(th, flash, lightflash_t);
+        flash->sector = (sector_t *)(intptr_t)(flash->sector->iSectorID);
+        break;
+      }
 
-    if (th->function == dsda_UpdateThruster)
-    {
-      P_SAVE_BYTE(tc_thrust);
-      P_SAVE_TYPE(th, scroll_t);
-      continue;
-    }
+      case tc_strobe:
+      {
+        strobe_t *strobe;
+        P_WRITE_TYPE_REF(th, strobe, strobe_t);
+        strobe->sector = (sector_t *)(intptr_t)(strobe->sector->iSectorID);
+        break;
+      }
 
-    if (th->function == dsda_UpdateControlSideScroller)
-    {
-      P_SAVE_BYTE(tc_scroll_side_control);
-      P_SAVE_TYPE(th, control_scroll_t);
-      continue;
-    }
+      case tc_glow:
+      {
+        glow_t *glow;
+        P_WRITE_TYPE_REF(th, glow, glow_t);
+        glow->sector = (sector_t *)(intptr_t)(glow->sector->iSectorID);
+        break;
+      }
 
-    if (th->function == dsda_UpdateControlFloorScroller)
-    {
-      P_SAVE_BYTE(tc_scroll_floor_control);
-      P_SAVE_TYPE(th, control_scroll_t);
-      continue;
-    }
+      case tc_zdoom_glow:
+      {
+        zdoom_glow_t *glow;
+        P_WRITE_TYPE_REF(th, glow, zdoom_glow_t);
+        glow->sector = (sector_t *)(intptr_t)(glow->sector->iSectorID);
+        break;
+      }
 
-    if (th->function == dsda_UpdateControlCeilingScroller)
-    {
-      P_SAVE_BYTE(tc_scroll_ceiling_control);
-      P_SAVE_TYPE(th, control_scroll_t);
-      continue;
-    }
+      // killough 10/4/98: save flickers
+      case tc_flicker:
+      {
+        fireflicker_t *flicker;
+        P_WRITE_TYPE_REF(th, flicker, fireflicker_t);
+        flicker->sector = (sector_t *)(intptr_t)(flicker->sector->iSectorID);
+        break;
+      }
 
-    if (th->function == dsda_UpdateControlFloorCarryScroller)
-    {
-      P_SAVE_BYTE(tc_scroll_floor_carry_control);
-      P_SAVE_TYPE(th, control_scroll_t);
-      continue;
-    }
+      case tc_zdoom_flicker:
+      {
+        zdoom_flicker_t *flicker;
+        P_WRITE_TYPE_REF(th, flicker, zdoom_flicker_t);
+        flicker->sector = (sector_t *)(intptr_t)(flicker->sector->iSectorID);
+        break;
+      }
 
-    // phares 3/22/98: Push/Pull effect thinkers
+      //jff 2/22/98 new case for elevators
+      case tc_elevator:
+      {
+        elevator_t *elevator;         //jff 2/22/98
+        P_WRITE_TYPE_REF(th, elevator, elevator_t);
+        elevator->sector = (sector_t *)(intptr_t)(elevator->sector->iSectorID);
+        break;
+      }
 
-    if (th->function == T_Pusher)
-    {
-      P_SAVE_BYTE(tc_pusher);
-      P_SAVE_TYPE(th, pusher_t);
-      continue;
-    }
+      case tc_scroll_side:
+      case tc_scroll_floor:
+      case tc_scroll_ceiling:
+      case tc_scroll_floor_carry:
+      case tc_zdoom_scroll_floor:
+      case tc_zdoom_scroll_ceiling:
+      case tc_thrust:
+        P_WRITE_TYPE(th, scroll_t);
+        break;
 
-    if (th->function == T_Friction)
-    {
-      P_SAVE_BYTE(tc_friction);
-      P_SAVE_TYPE(th, friction_t);
-      continue;
-    }
+      case tc_scroll_side_control:
+      case tc_scroll_floor_control:
+      case tc_scroll_ceiling_control:
+      case tc_scroll_floor_carry_control:
+        P_WRITE_TYPE(th, control_scroll_t);
+        break;
 
-    if (th->function == T_Light)
-    {
-      light_t *light;
-      P_SAVE_BYTE(tc_light);
-      P_SAVE_TYPE_REF(th, light, light_t);
-      light->sector = (sector_t *)(intptr_t)(light->sector->iSectorID);
-      continue;
-    }
+      // phares 3/22/98: Push/Pull effect thinkers
 
-    if (th->function == T_Phase)
-    {
-      phase_t *phase;
-      P_SAVE_BYTE(tc_phase);
-      P_SAVE_TYPE_REF(th, phase, phase_t);
-      phase->sector = (sector_t *)(intptr_t)(phase->sector->iSectorID);
-      continue;
-    }
+      case tc_pusher:
+        P_WRITE_TYPE(th, pusher_t);
+        break;
 
-    if (th->function == T_InterpretACS)
-    {
-      acs_t *acs;
-      P_SAVE_BYTE(tc_acs);
-      P_SAVE_TYPE_REF(th, acs, acs_t);
-      P_ReplaceMobjWithIndex(&acs->activator);
-      acs->line = (line_t *) (acs->line ? acs->line - lines : -1);
+      case tc_friction:
+        P_WRITE_TYPE(th, friction_t);
+        break;
 
-      continue;
-    }
+      case tc_light:
+      {
+        light_t *light;
+        P_WRITE_TYPE_REF(th, light, light_t);
+        light->sector = (sector_t *)(intptr_t)(light->sector->iSectorID);
+        break;
+      }
 
-    if (th->function == T_BuildPillar)
-    {
-      pillar_t *pillar;
-      P_SAVE_BYTE(tc_pillar);
-      P_SAVE_TYPE_REF(th, pillar, pillar_t);
-      pillar->sector = (sector_t *)(intptr_t)(pillar->sector->iSectorID);
-      continue;
-    }
+      case tc_phase:
+      {
+        phase_t *phase;
+        P_WRITE_TYPE_REF(th, phase, phase_t);
+        phase->sector = (sector_t *)(intptr_t)(phase->sector->iSectorID);
+        break;
+      }
 
-    if (th->function == T_FloorWaggle)
-    {
-      planeWaggle_t *floor_waggle;
-      P_SAVE_BYTE(tc_floor_waggle);
-      P_SAVE_TYPE_REF(th, floor_waggle, planeWaggle_t);
-      floor_waggle->sector = (sector_t *)(intptr_t)(floor_waggle->sector->iSectorID);
-      continue;
-    }
+      case tc_acs:
+      {
+        acs_t *acs;
+        P_WRITE_TYPE_REF(th, acs, acs_t);
+        P_ReplaceMobjWithIndex(&acs->activator);
+        acs->line = (line_t *) (acs->line ? acs->line - lines : -1);
+        break;
+      }
 
-    if (th->function == T_CeilingWaggle)
-    {
-      planeWaggle_t *ceiling_waggle;
-      P_SAVE_BYTE(tc_ceiling_waggle);
-      P_SAVE_TYPE_REF(th, ceiling_waggle, planeWaggle_t);
-      ceiling_waggle->sector = (sector_t *)(intptr_t)(ceiling_waggle->sector->iSectorID);
-      continue;
-    }
+      case tc_pillar:
+      {
+        pillar_t *pillar;
+        P_WRITE_TYPE_REF(th, pillar, pillar_t);
+        pillar->sector = (sector_t *)(intptr_t)(pillar->sector->iSectorID);
+        break;
+      }
 
-    if (th->function == T_RotatePoly)
-    {
-      P_SAVE_BYTE(tc_poly_rotate);
-      P_SAVE_TYPE(th, polyevent_t);
-      continue;
-    }
+      case tc_floor_waggle:
+      case tc_ceiling_waggle:
+      {
+        planeWaggle_t *waggle;
+        P_WRITE_TYPE_REF(th, waggle, planeWaggle_t);
+        waggle->sector = (sector_t *)(intptr_t)(waggle->sector->iSectorID);
+        break;
+      }
 
-    if (th->function == T_MovePoly)
-    {
-      P_SAVE_BYTE(tc_poly_move);
-      P_SAVE_TYPE(th, polyevent_t);
-      continue;
-    }
+      case tc_poly_rotate:
+      case tc_poly_move:
+        P_WRITE_TYPE(th, polyevent_t);
+        break;
 
-    if (th->function == T_PolyDoor)
-    {
-      P_SAVE_BYTE(tc_poly_door);
-      P_SAVE_TYPE(th, polydoor_t);
-      continue;
-    }
+      case tc_poly_door:
+        P_WRITE_TYPE(th, polydoor_t);
+        break;
 
-    if (th->function == dsda_UpdateQuake)
-    {
-      quake_t *quake;
-      P_SAVE_BYTE(tc_quake);
-      P_SAVE_TYPE_REF(th, quake, quake_t);
-      P_ReplaceMobjWithIndex(&quake->location);
-      continue;
-    }
+      case tc_quake:
+      {
+        quake_t *quake;
+        P_WRITE_TYPE_REF(th, quake, quake_t);
+        P_ReplaceMobjWithIndex(&quake->location);
+        break;
+      }
 
-    if (th->function == dsda_UpdateAmbientSource)
-    {
-      ambient_source_t *ambient_source;
-      P_SAVE_BYTE(tc_ambient_source);
-      P_SAVE_TYPE_REF(th, ambient_source, ambient_source_t);
-      P_ReplaceMobjWithIndex(&ambient_source->mobj);
-      continue;
-    }
+      case tc_ambient_source:
+      {
+        ambient_source_t *ambient_source;
+        P_WRITE_TYPE_REF(th, ambient_source, ambient_source_t);
+        P_ReplaceMobjWithIndex(&ambient_source->mobj);
+        break;
+      }
 
-    if (P_IsMobjThinker(th))
-    {
-      mobj_t *mobj;
+      case tc_mobj:
+      {
+        mobj_t *mobj;
 
-      P_SAVE_BYTE(tc_mobj);
-      P_SAVE_TYPE_REF(th, mobj, mobj_t);
+        P_WRITE_TYPE_REF(th, mobj, mobj_t);
 
-      mobj->state = (state_t *)(mobj->state - states);
+        mobj->state = (state_t *)(mobj->state - states);
 
-      // Example:
-      // - Archvile is attacking a lost soul
-      // - The lost soul dies before the attack hits
-      // - The lost soul is marked for deletion
-      // - The archvile will still attack the spot where the lost soul was
-      // - We need to save such objects and remember they are marked for deletion
-      if (mobj->thinker.function == P_RemoveThinkerDelayed)
-        mobj->index = MARKED_FOR_DELETION;
+        // Example:
+        // - Archvile is attacking a lost soul
+        // - The lost soul dies before the attack hits
+        // - The lost soul is marked for deletion
+        // - The archvile will still attack the spot where the lost soul was
+        // - We need to save such objects and remember they are marked for deletion
+        if (mobj->thinker.function == P_RemoveThinkerDelayed)
+          mobj->index = MARKED_FOR_DELETION;
 
-      // killough 2/14/98: convert pointers into indices.
-      // Fixes many savegame problems, by properly saving
-      // target and tracer fields. Note: we store NULL if
-      // the thinker pointed to by these fields is not a
-      // mobj thinker.
+        // killough 2/14/98: convert pointers into indices.
+        // Fixes many savegame problems, by properly saving
+        // target and tracer fields. Note: we store NULL if
+        // the thinker pointed to by these fields is not a
+        // mobj thinker.
 
-      P_ReplaceMobjWithIndex(&mobj->target);
-      P_ReplaceMobjWithIndex(&mobj->tracer);
+        P_ReplaceMobjWithIndex(&mobj->target);
+        P_ReplaceMobjWithIndex(&mobj->tracer);
 
-      // killough 2/14/98: new field: save last known enemy. Prevents
-      // monsters from going to sleep after killing monsters and not
-      // seeing player anymore.
+        // killough 2/14/98: new field: save last known enemy. Prevents
+        // monsters from going to sleep after killing monsters and not
+        // seeing player anymore.
 
-      P_ReplaceMobjWithIndex(&mobj->lastenemy);
+        P_ReplaceMobjWithIndex(&mobj->lastenemy);
 
-      // killough 2/14/98: end changes
+        // killough 2/14/98: end changes
 
-      if (raven)
-      {
-        P_ReplaceMobjWithIndex(&mobj->special1.m);
-        P_ReplaceMobjWithIndex(&mobj->special2.m);
+        if (raven)
+        {
+          P_ReplaceMobjWithIndex(&mobj->special1.m);
+          P_ReplaceMobjWithIndex(&mobj->special2.m);
+        }
+
+        if (mobj->player)
+          mobj->player = (player_t *)((mobj->player-players) + 1);
+        break;
       }
 
-      if (mobj->player)
-        mobj->player = (player_t *)((mobj->player-players) + 1);
+      default:
+        break;
     }
   }
 
   // add a terminating marker
-  P_SAVE_BYTE(tc_end);
+  P_WRITE_BYTE(tc_end);
 
   P_ArchivePolyObjSpecialData();
 
   // killough 9/14/98: save soundtargets
+  CheckSaveGame(numsectors * sizeof(mobj_t *));
+
+  for (i = 0; i < numsectors; i++)
   {
-    int i;
-    for (i = 0; i < numsectors; i++)
-    {
-      mobj_t *target = sectors[i].soundtarget;
-      // Fix crash on reload when a soundtarget points to a removed corpse
-      // (prboom bug #1590350)
-      P_ReplaceMobjWithIndex(&target);
-      P_SAVE_X(target);
-    }
+    mobj_t *target = sectors[i].soundtarget;
+    // Fix crash on reload when a soundtarget points to a removed corpse
+    // (prboom bug #1590350)
+    P_ReplaceMobjWithIndex(&target);
+    P_WRITE_X(target);
   }
 
   P_ArchiveBlockLinks();
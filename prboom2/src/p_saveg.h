@@ -36,7 +36,7 @@
 
 #include "doomtype.h"
 
-#define SAVEVERSION 5
+#define SAVEVERSION 6
 
 /* Persistent storage/archiving.
  * These are the load / save game routines. */
@@ -105,6 +105,22 @@ void P_FreeSaveBuffer(void);
 #define P_LOAD_ARRAY(x) { memcpy(x, save_p, sizeof(x)); \
                           save_p += sizeof(x); }
 
+// Unchecked writes, for sections that reserved their size up front
+#define P_WRITE_X(x) { memcpy(save_p, &x, sizeof(x)); \
+                       save_p += sizeof(x); }
+
+#define P_WRITE_SIZE(x, size) { memcpy(save_p, x, size); \
+                                save_p += size; }
+
+#define P_WRITE_TYPE(x, type) { memcpy(save_p, x, sizeof(type)); \
+                                save_p += sizeof(type); }
+
+#define P_WRITE_TYPE_REF(x, ref, type) { ref = (type *) save_p; \
+                                         memcpy(save_p, x, sizeof(type)); \
+                                         save_p += sizeof(type); }
+
+#define P_WRITE_BYTE(x) { *save_p++ = x; }
+
 // heretic
 
 void P_ArchiveAmbientSound(void);
@@ -2217,7 +2217,7 @@ static void P_LoadUDMFLineDefs(int lump)
     P_CalculateLineDefProperties(ld);
 
     if (ld->alpha < 1.f)
-      ld->tranmap = dsda_TranMap(dsda_FloatToPercent(ld->alpha));
+      dsda_RequestTranMap(dsda_FloatToPercent(ld->alpha));
 
     if (ld->healthgroup)
       dsda_AddLineToHealthGroup(ld);
@@ -2246,6 +2246,13 @@ static void P_LoadUDMFLineDefs(int lump)
     if (ld->flags & ML_WRAPMIDTEX)
       dsda_PreferOpenGL();
   }
+
+  // Missing tranmaps for all alpha levels on the map are built together
+  dsda_PrepareTranMaps();
+
+  for (i = 0; i < numlines; ++i)
+    if (lines[i].alpha < 1.f)
+      lines[i].tranmap = dsda_TranMap(dsda_FloatToPercent(lines[i].alpha));
 }
 
 void P_PostProcessCompatibleLineSpecial(line_t *ld)
@@ -3913,6 +3920,8 @@ void P_SetupLevel(int episode, int map, int playermask, int skill)
     SN_StopAllSequences();
   }
 
+  AM_InitSpatialIndex();
+
   if (dsda_ShowMinimap())
   {
     AM_Start(false);
@@ -43,11 +43,14 @@
 #include "hexen/p_anim.h"
 
 #include "dsda.h"
+#include "dsda/args.h"
 #include "dsda/pause.h"
+#include "dsda/scroll.h"
 
 int leveltime;
 
 static dboolean newthinkerpresent;
+static dboolean bucket_scrollers;
 
 //
 // THINKERS
@@ -75,6 +78,9 @@ void P_InitThinkers(void)
 
   thinkercap.prev = thinkercap.next  = &thinkercap;
 
+  bucket_scrollers = !dsda_Flag(dsda_arg_plain_thinkers);
+  dsda_ResetTextureScrollers();
+
   init_thinkers_count++;
 }
 
@@ -97,7 +103,8 @@ void P_UpdateThinker(thinker_t *thinker)
     (((mobj_t *) thinker)->flags & MF_COUNTKILL ||
      ((mobj_t *) thinker)->type == MT_SKULL) ?
     ((mobj_t *) thinker)->flags & MF_FRIEND ?
-    th_friends : th_enemies : th_misc;
+    th_friends : th_enemies :
+    bucket_scrollers && dsda_IsTextureScroller(thinker) ? th_scroll : th_misc;
 
   {
     /* Remove from current thread, if in one */
@@ -120,10 +127,23 @@ void P_UpdateThinker(thinker_t *thinker)
 
 void P_AddThinker(thinker_t* thinker)
 {
-  thinkercap.prev->next = thinker;
-  thinker->next = &thinkercap;
-  thinker->prev = thinkercap.prev;
-  thinkercap.prev = thinker;
+  thinker_t *prev = thinkercap.prev;
+
+  // Texture scrollers are kept together at the head of the list,
+  // so that P_RunThinkers can start its walk after them
+  if (bucket_scrollers && dsda_IsTextureScroller(thinker))
+  {
+    prev = thinkerclasscap[th_scroll].cprev;
+    if (prev == &thinkerclasscap[th_scroll])
+      prev = &thinkercap;
+
+    dsda_AddTextureScroller((scroll_t *) thinker);
+  }
+
+  thinker->next = prev->next;
+  thinker->prev = prev;
+  prev->next->prev = thinker;
+  prev->next = thinker;
 
   thinker->references = 0;    // killough 11/98: init reference counter to 0
 
@@ -225,6 +245,28 @@ void P_SetTarget(mobj_t **mop, mobj_t *targ)
     targ->thinker.references++;
 }
 
+//
+// Texture scrollers are never removed, so the block at the head of the
+// list always ends at the last thinker of their class. They run from
+// packed copies after the walk, so scrollers added during it still move
+// this tic.
+//
+
+static void P_RunTextureScrollers(void)
+{
+  if (newthinkerpresent)
+  {
+    thinker_t *th;
+
+    for (th = thinkerclasscap[th_scroll].cnext;
+         th != &thinkerclasscap[th_scroll];
+         th = th->cnext)
+      R_ActivateThinkerInterpolations(th);
+  }
+
+  dsda_RunTextureScrollers();
+}
+
 //
 // P_RunThinkers
 //
@@ -250,7 +292,10 @@ void P_SetTarget(mobj_t **mop, mobj_t *targ)
 
 static void P_RunThinkers (void)
 {
-  for (currentthinker = thinkercap.next;
+  thinker_t *scrollers = &thinkerclasscap[th_scroll];
+
+  for (currentthinker = scrollers->cprev == scrollers ?
+                        thinkercap.next : scrollers->cprev->next;
        currentthinker != &thinkercap;
        currentthinker = currentthinker->next)
   {
@@ -259,6 +304,8 @@ static void P_RunThinkers (void)
     if (currentthinker->function)
       currentthinker->function(currentthinker);
   }
+
+  P_RunTextureScrollers();
   newthinkerpresent = false;
 
   // Dedicated thinkers
@@ -59,6 +59,7 @@ typedef enum {
   th_misc,
   th_friends,
   th_enemies,
+  th_scroll,  /* texture scrollers, run apart from the main list walk */
   NUMTHCLASS,
   th_all = NUMTHCLASS, /* For P_NextThinker, indicates "any class" */
 } th_class;
@@ -47,6 +47,7 @@
 #include "dsda/args.h"
 #include "dsda/configuration.h"
 #include "dsda/map_format.h"
+#include "dsda/startup.h"
 #include "dsda/utility.h"
 
 //
@@ -113,12 +114,6 @@ const byte *R_GetTextureColumn(const rpatch_t *texpatch, int col) {
   return texpatch->columns[col].pixels;
 }
 
-//
-// R_InitTextures
-// Initializes the texture list
-//  with the textures from the world map.
-//
-
 static dboolean R_IsPNGLump(int lump_num)
 {
   return W_LumpLength(lump_num) >= 8 &&
@@ -139,40 +134,50 @@ static int R_FilterValidPatch(int lump_num, const char *name)
   return lump_num;
 }
 
-static void R_InitTextures (void)
+//
+// R_InitTextures
+// Initializes the texture list
+//  with the textures from the world map.
+//
+// The work is split so that the table build can run on a worker thread
+//  during startup. R_PrepareTextures reads every lump and allocates every
+//  buffer, R_BuildTextures only fills them in, and R_FinishTextures
+//  reports missing patches.
+//
+
+static int texture_names_lump;
+static int *texture_patchlookup;
+static const maptexture_t **texture_defs;
+static int texture_errors;
+
+void R_PrepareTextures(void)
 {
   const maptexture_t *mtexture;
-  texture_t    *texture;
-  const mappatch_t   *mpatch;
-  texpatch_t   *patch;
-  int  i, j;
+  int  i;
   int         maptex_lump[2] = {-1, -1};
   const int  *maptex;
   const int  *maptex1, *maptex2;
   char name[9];
-  int names_lump; // cph - new wad lump handling
   const char *names; // cph -
   const char *name_p;// const*'s
-  int  *patchlookup;
   int  nummappatches;
   int  offset;
   int  maxoff, maxoff2;
   int  numtextures1, numtextures2;
   const int *directory;
-  int  errors = 0;
 
   // Load the patch names from pnames.lmp.
   name[8] = 0;
-  names = W_LumpByNum(names_lump = W_GetNumForName("PNAMES"));
+  names = W_LumpByNum(texture_names_lump = W_GetNumForName("PNAMES"));
   nummappatches = LittleLong(*((const int *)names));
   name_p = names+4;
-  patchlookup = Z_Malloc(nummappatches*sizeof(*patchlookup));  // killough
+  texture_patchlookup = Z_Malloc(nummappatches*sizeof(*texture_patchlookup));  // killough
 
   for (i=0 ; i<nummappatches ; i++)
     {
       strncpy (name,name_p+i*8, 8);
-      patchlookup[i] = W_CheckNumForName(name);
-      if (patchlookup[i] == LUMP_NOT_FOUND)
+      texture_patchlookup[i] = W_CheckNumForName(name);
+      if (texture_patchlookup[i] == LUMP_NOT_FOUND)
         {
           // killough 4/17/98:
           // Some wads use sprites as wall patches, so repeat check and
@@ -182,10 +187,10 @@ static void R_InitTextures (void)
           // appear first in a wad. This is a kludgy solution to the wad
           // lump namespace problem.
 
-          patchlookup[i] = W_CheckNumForName2(name, ns_sprites);
+          texture_patchlookup[i] = W_CheckNumForName2(name, ns_sprites);
         }
 
-      patchlookup[i] = R_FilterValidPatch(patchlookup[i], name);
+      texture_patchlookup[i] = R_FilterValidPatch(texture_patchlookup[i], name);
     }
 
   // Load the map texture definitions from textures.lmp.
@@ -216,6 +221,9 @@ static void R_InitTextures (void)
 
   textures = Z_Malloc(numtextures*sizeof*textures);
   textureheight = Z_Malloc(numtextures*sizeof*textureheight);
+  texturetranslation = Z_Malloc((numtextures+1)*sizeof*texturetranslation);
+  texture_defs = Z_Malloc(numtextures*sizeof*texture_defs);
+  texture_errors = 0;
 
   for (i=0 ; i<numtextures ; i++, directory++)
     {
@@ -232,10 +240,25 @@ static void R_InitTextures (void)
       if (offset > maxoff)
         I_Error("R_InitTextures: Bad texture directory");
 
-      mtexture = (const maptexture_t *) ( (const byte *)maptex + offset);
+      mtexture = texture_defs[i] = (const maptexture_t *) ( (const byte *)maptex + offset);
 
-      texture = textures[i] =
+      textures[i] =
         Z_Malloc(sizeof(texture_t) + sizeof(texpatch_t)*(LittleShort(mtexture->patchcount)-1));
+    }
+}
+
+void R_BuildTextures(void)
+{
+  const maptexture_t *mtexture;
+  texture_t    *texture;
+  const mappatch_t   *mpatch;
+  texpatch_t   *patch;
+  int  i, j;
+
+  for (i=0 ; i<numtextures ; i++)
+    {
+      mtexture = texture_defs[i];
+      texture = textures[i];
 
       texture->width = LittleShort(mtexture->width);
       texture->height = LittleShort(mtexture->height);
@@ -285,14 +308,9 @@ static void R_InitTextures (void)
         {
           patch->originx = LittleShort(mpatch->originx);
           patch->originy = LittleShort(mpatch->originy);
-          patch->patch = patchlookup[LittleShort(mpatch->patch)];
+          patch->patch = texture_patchlookup[LittleShort(mpatch->patch)];
           if (patch->patch == -1)
-            {
-              //jff 8/3/98 use logical output routine
-              lprintf(LO_ERROR,"\nR_InitTextures: Missing patch %d in texture %.8s",
-                     LittleShort(mpatch->patch), texture->name); // killough 4/17/98
-              ++errors;
-            }
+            ++texture_errors;
         }
 
       for (j=1; j*2 <= texture->width; j<<=1)
@@ -301,23 +319,7 @@ static void R_InitTextures (void)
       textureheight[i] = texture->height<<FRACBITS;
     }
 
-  Z_Free(patchlookup);         // killough
-
-  if (errors)
-  {
-    const lumpinfo_t* info;
-
-    info = W_GetLumpInfoByNum(names_lump);
-
-    I_Error("Texture errors: %d!\n%s seems to be incompatible with %s.\nAre you using the right IWAD?",
-            errors, dsda_BaseName(info->wadfile->name), doomverstr);
-  }
-
   // Create translation table for global animation.
-  // killough 4/9/98: make column offsets 32-bit;
-  // clean up malloc-ing to use sizeof
-
-  texturetranslation = Z_Malloc((numtextures+1)*sizeof*texturetranslation);
 
   for (i=0 ; i<numtextures ; i++)
     texturetranslation[i] = i;
@@ -333,6 +335,35 @@ static void R_InitTextures (void)
     }
 }
 
+void R_FinishTextures(void)
+{
+  int i, j;
+
+  for (i=0 ; texture_errors && i<numtextures ; i++)
+    for (j=0 ; j<textures[i]->patchcount ; j++)
+      if (textures[i]->patches[j].patch == -1)
+        {
+          //jff 8/3/98 use logical output routine
+          lprintf(LO_ERROR,"\nR_InitTextures: Missing patch %d in texture %.8s",
+                 LittleShort(texture_defs[i]->patches[j].patch), textures[i]->name); // killough 4/17/98
+        }
+
+  Z_Free(texture_patchlookup);         // killough
+  Z_Free(texture_defs);
+  texture_patchlookup = NULL;
+  texture_defs = NULL;
+
+  if (texture_errors)
+  {
+    const lumpinfo_t* info;
+
+    info = W_GetLumpInfoByNum(texture_names_lump);
+
+    I_Error("Texture errors: %d!\n%s seems to be incompatible with %s.\nAre you using the right IWAD?",
+            texture_errors, dsda_BaseName(info->wadfile->name), doomverstr);
+  }
+}
+
 //
 // R_InitFlats
 //
@@ -422,7 +453,7 @@ int R_ColormapNumForName(const char *name)
 void R_InitData(void)
 {
   lprintf(LO_DEBUG, "Textures ");
-  R_InitTextures();
+  dsda_FinishStartupJob(dsda_startup_textures);
   lprintf(LO_DEBUG, "Flats ");
   R_InitFlats();
   lprintf(LO_DEBUG, "Sprites ");
@@ -75,6 +75,9 @@ const byte *R_GetTextureColumn(const rpatch_t *texpatch, int col);
 
 // I/O, setting up the stuff.
 void R_InitData (void);
+void R_PrepareTextures(void);
+void R_BuildTextures(void);
+void R_FinishTextures(void);
 void R_PrecacheLevel (void);
 
 
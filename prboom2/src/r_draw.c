@@ -45,7 +45,16 @@
 #include "am_map.h"
 #include "lprintf.h"
 
+// Vector span kernels are compiled with per-function target attributes
+// and picked at runtime, so the baseline build flags don't change.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define R_SIMD_SPANS
+#include <immintrin.h>
+#endif
+
+#include "dsda/args.h"
 #include "dsda/stretch.h"
+#include "dsda/time.h"
 
 //
 // All drawing to the view buffer is accomplished in this file.
@@ -132,6 +141,7 @@ static int fuzzpos = 0;
 draw_vars_t drawvars = {
   NULL, // topleft
   0, // pitch
+  1, // xpitch
 };
 
 dboolean R_FullView(void)
@@ -175,7 +185,8 @@ static void (*R_FlushQuadColumn)(void) = R_QuadFlushError;
 
 static void R_FlushColumns(void)
 {
-   if(temp_x != 4 || commontop >= commonbot)
+   // Column-major buffers are written one whole column at a time
+   if(temp_x != 4 || commontop >= commonbot || drawvars.xpitch != 1)
       R_FlushWholeColumns();
    else
    {
@@ -431,7 +442,7 @@ void R_InitTranslationTables (void)
 //  and the inner loop has to step in texture space u and v.
 //
 
-void R_DrawSpan(draw_span_vars_t *dsvars) {
+static void R_DrawSpanScalar(draw_span_vars_t *dsvars) {
   unsigned count = dsvars->x2 - dsvars->x1 + 1;
   fixed_t xfrac = dsvars->xfrac;
   fixed_t yfrac = dsvars->yfrac;
@@ -439,7 +450,8 @@ void R_DrawSpan(draw_span_vars_t *dsvars) {
   const fixed_t ystep = dsvars->ystep;
   const byte *source = dsvars->source;
   const byte *colormap = dsvars->colormap;
-  byte *dest = drawvars.topleft + dsvars->y*drawvars.pitch + dsvars->x1;
+  const int xpitch = drawvars.xpitch;
+  byte *dest = drawvars.topleft + dsvars->y*drawvars.pitch + dsvars->x1*xpitch;
 
   while (count) {
     const fixed_t xtemp = (xfrac >> 16) & 63;
@@ -447,11 +459,127 @@ void R_DrawSpan(draw_span_vars_t *dsvars) {
     const fixed_t spot = xtemp | ytemp;
     xfrac += xstep;
     yfrac += ystep;
-    *dest++ = colormap[source[spot]];
+    *dest = colormap[source[spot]];
+    dest += xpitch;
     count--;
   }
 }
 
+#ifdef R_SIMD_SPANS
+
+//
+// The AVX2 kernel computes flat offsets for 8 pixels at once and does both
+// table lookups with gathers. Lane i starts at frac + i*step in wrapping
+// 32-bit arithmetic, which is exactly where the scalar loop gets to after
+// i steps, so the output is identical. Each lane gathers the aligned dword
+// that holds its byte and shifts the byte down, so no read leaves the 4096
+// byte flat or the 256 byte colormap, the same as the scalar loop. Any
+// remainder is finished by the scalar loop.
+//
+
+#define SPAN_LANE(frac, step, i) ((int)((unsigned)(frac) + (unsigned)(step) * (i)))
+
+__attribute__((target("avx2")))
+static inline __m256i R_GatherSpanBytes(const byte *table, __m256i index) {
+  const __m256i align = _mm256_set1_epi32(~3);
+  const __m256i low = _mm256_set1_epi32(3);
+  __m256i dword;
+
+  dword = _mm256_i32gather_epi32((const int *) table, _mm256_and_si256(index, align), 1);
+
+  return _mm256_and_si256(_mm256_srlv_epi32(dword, _mm256_slli_epi32(_mm256_and_si256(index, low), 3)),
+                          _mm256_set1_epi32(255));
+}
+
+__attribute__((target("avx2")))
+static void R_DrawSpanAVX2(draw_span_vars_t *dsvars) {
+  int count = dsvars->x2 - dsvars->x1 + 1;
+  const fixed_t xfrac = dsvars->xfrac;
+  const fixed_t yfrac = dsvars->yfrac;
+  const fixed_t xstep = dsvars->xstep;
+  const fixed_t ystep = dsvars->ystep;
+  const byte *source = dsvars->source;
+  const byte *colormap = dsvars->colormap;
+  const int xpitch = drawvars.xpitch;
+  byte *dest = drawvars.topleft + dsvars->y*drawvars.pitch + dsvars->x1*xpitch;
+  const __m256i xmask = _mm256_set1_epi32(63);
+  const __m256i ymask = _mm256_set1_epi32(4032);
+  const __m256i xstep8 = _mm256_set1_epi32(SPAN_LANE(0, xstep, 8));
+  const __m256i ystep8 = _mm256_set1_epi32(SPAN_LANE(0, ystep, 8));
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  // Low byte of each lane to the bottom of each 128-bit half
+  const __m256i pack = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                        0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  __m256i xf = _mm256_add_epi32(_mm256_set1_epi32(xfrac),
+                                _mm256_mullo_epi32(lanes, _mm256_set1_epi32(xstep)));
+  __m256i yf = _mm256_add_epi32(_mm256_set1_epi32(yfrac),
+                                _mm256_mullo_epi32(lanes, _mm256_set1_epi32(ystep)));
+  byte pixels[8];
+  int i;
+
+  while (count >= 8) {
+    __m256i spot, texel, pixel;
+    __m128i packed;
+
+    spot = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(xf, 16), xmask),
+                           _mm256_and_si256(_mm256_srli_epi32(yf, 10), ymask));
+    texel = R_GatherSpanBytes(source, spot);
+    pixel = _mm256_shuffle_epi8(R_GatherSpanBytes(colormap, texel), pack);
+    packed = _mm_unpacklo_epi32(_mm256_castsi256_si128(pixel), _mm256_extracti128_si256(pixel, 1));
+    xf = _mm256_add_epi32(xf, xstep8);
+    yf = _mm256_add_epi32(yf, ystep8);
+
+    if (xpitch == 1) {
+      _mm_storel_epi64((__m128i *) dest, packed);
+      dest += 8;
+    }
+    else {
+      _mm_storel_epi64((__m128i *) pixels, packed);
+
+      for (i = 0; i < 8; i++) {
+        *dest = pixels[i];
+        dest += xpitch;
+      }
+    }
+
+    count -= 8;
+  }
+
+  if (count) {
+    draw_span_vars_t tail = *dsvars;
+
+    tail.x1 = dsvars->x2 - count + 1;
+    tail.xfrac = _mm256_extract_epi32(xf, 0);
+    tail.yfrac = _mm256_extract_epi32(yf, 0);
+    R_DrawSpanScalar(&tail);
+  }
+}
+
+#undef SPAN_LANE
+
+#endif // R_SIMD_SPANS
+
+static void (*R_DrawSpanFunc)(draw_span_vars_t *dsvars) = R_DrawSpanScalar;
+
+static void R_InitSpanFunc(void)
+{
+  R_DrawSpanFunc = R_DrawSpanScalar;
+
+#ifdef R_SIMD_SPANS
+  if (dsda_Flag(dsda_arg_scalar_spans))
+    return;
+
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2"))
+    R_DrawSpanFunc = R_DrawSpanAVX2;
+#endif
+}
+
+void R_DrawSpan(draw_span_vars_t *dsvars) {
+  R_DrawSpanFunc(dsvars);
+}
+
 void R_InitBuffersRes(void)
 {
   extern byte *solidcol;
@@ -473,15 +601,159 @@ void R_InitBuffersRes(void)
 //  of a pixel to draw.
 //
 
-void R_InitBuffer(int width, int height)
+//
+// Column-major view buffer
+//
+// Walls and sprites are drawn top to bottom, so with a row-major screen
+// every pixel of a column lands on a different cache line (and at high
+// resolutions, a different page). The view can instead be drawn into a
+// buffer where each column is contiguous, then transposed onto the
+// screen once per frame before the HUD is drawn.
+//
+
+static byte *colmajor_buffer;
+static int colmajor_height;
+static dboolean colmajor_view;
+static dboolean benchmark_layouts;
+static unsigned long long layout_time[2];
+static int layout_frames[2];
+
+static void R_SetViewLayout(dboolean column_major)
 {
   int i;
 
-  drawvars.topleft = screens[0].data;
-  drawvars.pitch = screens[0].pitch;
+  colmajor_view = column_major;
+
+  if (colmajor_view)
+  {
+    drawvars.topleft = colmajor_buffer;
+    drawvars.pitch = 1;
+    drawvars.xpitch = colmajor_height;
+  }
+  else
+  {
+    drawvars.topleft = screens[0].data;
+    drawvars.pitch = screens[0].pitch;
+    drawvars.xpitch = 1;
+  }
 
   for (i=0; i<FUZZTABLE; i++)
-    fuzzoffset[i] = fuzzoffset_org[i]*screens[0].pitch;
+    fuzzoffset[i] = fuzzoffset_org[i]*drawvars.pitch;
+}
+
+void R_InitBuffer(int width, int height)
+{
+  R_InitSpanFunc();
+
+  benchmark_layouts = dsda_Flag(dsda_arg_benchmark_layouts);
+
+  if (V_IsSoftwareMode() && (benchmark_layouts || dsda_Flag(dsda_arg_column_major)))
+  {
+    if (colmajor_buffer)
+      Z_Free(colmajor_buffer);
+
+    // Full screen height keeps the fuzz and range checks valid
+    colmajor_height = SCREENHEIGHT;
+    colmajor_buffer = Z_Calloc(1, SCREENWIDTH * colmajor_height);
+
+    R_SetViewLayout(!benchmark_layouts || colmajor_view);
+  }
+  else
+    R_SetViewLayout(false);
+}
+
+#ifdef __SSE2__
+// 16x16 byte transpose: four rounds of interleaving row i with row i + 8
+static void R_Transpose16x16(const byte *src, int src_pitch, byte *dest, int dest_pitch)
+{
+  __m128i a[16], b[16];
+  int i, round;
+
+  for (i = 0; i < 16; i++)
+    a[i] = _mm_loadu_si128((const __m128i *) (src + i * src_pitch));
+
+  for (round = 0; round < 4; round++)
+  {
+    __m128i *in = (round & 1) ? b : a;
+    __m128i *out = (round & 1) ? a : b;
+
+    for (i = 0; i < 8; i++)
+    {
+      out[2 * i] = _mm_unpacklo_epi8(in[i], in[i + 8]);
+      out[2 * i + 1] = _mm_unpackhi_epi8(in[i], in[i + 8]);
+    }
+  }
+
+  for (i = 0; i < 16; i++)
+    _mm_storeu_si128((__m128i *) (dest + i * dest_pitch), a[i]);
+}
+#endif
+
+static void R_TransposeView(void)
+{
+  const int block = 16;
+  const byte *src = colmajor_buffer;
+  byte *dest = screens[0].data;
+  int dest_pitch = screens[0].pitch;
+  int x, y, bx, by;
+
+  for (x = 0; x < viewwidth; x += block)
+  {
+    for (y = 0; y < viewheight; y += block)
+    {
+      int w = MIN(block, viewwidth - x);
+      int h = MIN(block, viewheight - y);
+
+#ifdef __SSE2__
+      if (w == block && h == block)
+      {
+        R_Transpose16x16(src + x * colmajor_height + y, colmajor_height,
+                         dest + y * dest_pitch + x, dest_pitch);
+        continue;
+      }
+#endif
+
+      for (bx = 0; bx < w; bx++)
+        for (by = 0; by < h; by++)
+          dest[(y + by) * dest_pitch + x + bx] = src[(x + bx) * colmajor_height + y + by];
+    }
+  }
+}
+
+void R_BeginViewDraw(void)
+{
+  if (!benchmark_layouts)
+    return;
+
+  // Alternate layouts so both see the same mix of frames
+  R_SetViewLayout(!colmajor_view);
+  dsda_StartTimer(dsda_timer_view_layout);
+}
+
+void R_EndViewDraw(void)
+{
+  if (colmajor_view)
+    R_TransposeView();
+
+  if (benchmark_layouts)
+  {
+    layout_time[colmajor_view] += dsda_ElapsedTime(dsda_timer_view_layout);
+    layout_frames[colmajor_view]++;
+  }
+}
+
+void R_PrintViewLayoutBenchmark(void)
+{
+  int i;
+  static const char *names[2] = { "row major", "column major" };
+
+  if (!benchmark_layouts)
+    return;
+
+  for (i = 0; i < 2; i++)
+    if (layout_frames[i])
+      lprintf(LO_INFO, "%s: %d frames, %.3f ms per frame\n", names[i], layout_frames[i],
+              (double) layout_time[i] / layout_frames[i] / 1000);
 }
 
 //
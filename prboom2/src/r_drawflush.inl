@@ -53,7 +53,7 @@ static void R_FLUSHWHOLE_FUNCNAME(void)
    {
       yl     = tempyl[temp_x];
       source = &tempbuf[temp_x + (yl << 2)];
-      dest   = drawvars.topleft + yl*drawvars.pitch + startx + temp_x;
+      dest   = drawvars.topleft + yl*drawvars.pitch + (startx + temp_x)*drawvars.xpitch;
       count  = tempyh[temp_x] - yl + 1;
 
       while(--count >= 0)
@@ -100,7 +100,7 @@ static void R_FLUSHHEADTAIL_FUNCNAME(void)
       if(yl < commontop)
       {
          source = &tempbuf[colnum + (yl << 2)];
-         dest   = drawvars.topleft + yl*drawvars.pitch + startx + colnum;
+         dest   = drawvars.topleft + yl*drawvars.pitch + (startx + colnum)*drawvars.xpitch;
          count  = commontop - yl;
 
          while(--count >= 0)
@@ -128,7 +128,7 @@ static void R_FLUSHHEADTAIL_FUNCNAME(void)
       if(yh > commonbot)
       {
          source = &tempbuf[colnum + ((commonbot + 1) << 2)];
-         dest   = drawvars.topleft + (commonbot + 1)*drawvars.pitch + startx + colnum;
+         dest   = drawvars.topleft + (commonbot + 1)*drawvars.pitch + (startx + colnum)*drawvars.xpitch;
          count  = yh - commonbot;
 
          while(--count >= 0)
@@ -155,6 +155,7 @@ static void R_FLUSHHEADTAIL_FUNCNAME(void)
    }
 }
 
+// Only used with the row-major layout (xpitch == 1)
 static void R_FLUSHQUAD_FUNCNAME(void)
 {
    byte *source = &tempbuf[commontop << 2];
@@ -1000,6 +1000,8 @@ void R_RenderPlayerView (player_t* player)
 {
   r_frame_count++;
 
+  R_TrimPatchCache();
+
   DSDA_ADD_CONTEXT(sf_setup_frame);
   R_SetupFrame (player);
   DSDA_REMOVE_CONTEXT(sf_setup_frame);
@@ -1023,6 +1025,9 @@ void R_RenderPlayerView (player_t* player)
     DSDA_REMOVE_CONTEXT(sf_gl_frustum);
   }
 
+  if (V_IsSoftwareMode())
+    R_BeginViewDraw();
+
   DSDA_ADD_CONTEXT(sf_bsp_nodes);
   R_RenderBSPNodes();
   DSDA_REMOVE_CONTEXT(sf_bsp_nodes);
@@ -1047,6 +1052,8 @@ void R_RenderPlayerView (player_t* player)
     R_DrawMasked ();
     R_ResetColumnBuffer();
     DSDA_REMOVE_CONTEXT(sf_draw_masked);
+
+    R_EndViewDraw();
   }
 
   FakeNetUpdate();
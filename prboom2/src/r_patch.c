@@ -73,7 +73,9 @@
 #include "v_video.h"
 #include <assert.h>
 
+#include "dsda/configuration.h"
 #include "dsda/palette.h"
+#include "dsda/render_stats.h"
 
 // posts are runs of non masked source pixels
 typedef struct
@@ -108,6 +110,23 @@ static rpatch_t *patches = 0;
 
 static rpatch_t *texture_composites = 0;
 
+// Patches and composites share one least recently used list, so the
+// patch_cache_mb budget bounds both; entries past numlumps are composites.
+// Trimming only happens between frames, when no rpatch_t is in use.
+typedef struct {
+  int prev;
+  int next;
+  int size;
+} patch_cache_entry_t;
+
+static patch_cache_entry_t *patch_cache = 0;
+static int patch_cache_head = -1;
+static int patch_cache_tail = -1;
+static size_t patch_cache_bytes;
+static int patch_cache_hits;
+static int patch_cache_misses;
+static int patch_cache_evictions;
+
 // indices of two duplicate PLAYPAL entries, second is -1 if none found
 static int playpal_transparent, playpal_duplicate;
 
@@ -129,6 +148,12 @@ void R_InitPatches(void) {
     // clear out new patches to signal they're uninitialized
     memset(texture_composites, 0, sizeof(rpatch_t)*numtextures);
   }
+  if (!patch_cache)
+  {
+    patch_cache = Z_Calloc(numlumps + numtextures, sizeof(*patch_cache));
+    patch_cache_head = patch_cache_tail = -1;
+    patch_cache_bytes = 0;
+  }
 
   dsda_InitPlayPal();
   R_UpdatePlayPal();
@@ -161,6 +186,87 @@ void R_FlushAllPatches(void) {
     Z_Free(texture_composites);
     texture_composites = NULL;
   }
+  if (patch_cache)
+  {
+    Z_Free(patch_cache);
+    patch_cache = NULL;
+    patch_cache_head = patch_cache_tail = -1;
+    patch_cache_bytes = 0;
+  }
+}
+
+//---------------------------------------------------------------------------
+static rpatch_t *R_CachedPatch(int entry) {
+  return entry < numlumps ? &patches[entry] : &texture_composites[entry - numlumps];
+}
+
+static void R_UnlinkCachedPatch(int entry) {
+  patch_cache_entry_t *e = &patch_cache[entry];
+
+  if (e->prev >= 0)
+    patch_cache[e->prev].next = e->next;
+  else
+    patch_cache_head = e->next;
+
+  if (e->next >= 0)
+    patch_cache[e->next].prev = e->prev;
+  else
+    patch_cache_tail = e->prev;
+}
+
+static void R_LinkCachedPatch(int entry) {
+  patch_cache_entry_t *e = &patch_cache[entry];
+
+  e->prev = -1;
+  e->next = patch_cache_head;
+
+  if (patch_cache_head >= 0)
+    patch_cache[patch_cache_head].prev = entry;
+  else
+    patch_cache_tail = entry;
+
+  patch_cache_head = entry;
+}
+
+static void R_AddCachedPatch(int entry, int size) {
+  patch_cache[entry].size = size;
+  patch_cache_bytes += size;
+  ++patch_cache_misses;
+
+  R_LinkCachedPatch(entry);
+}
+
+static void R_TouchCachedPatch(int entry) {
+  ++patch_cache_hits;
+
+  if (patch_cache_head == entry)
+    return;
+
+  R_UnlinkCachedPatch(entry);
+  R_LinkCachedPatch(entry);
+}
+
+void R_TrimPatchCache(void) {
+  size_t budget;
+
+  budget = (size_t) dsda_IntConfig(dsda_config_patch_cache_mb) * 1024 * 1024;
+
+  if (budget)
+    while (patch_cache_bytes > budget && patch_cache_tail >= 0) {
+      int entry = patch_cache_tail;
+      rpatch_t *patch = R_CachedPatch(entry);
+
+      R_UnlinkCachedPatch(entry);
+      patch_cache_bytes -= patch_cache[entry].size;
+      ++patch_cache_evictions;
+
+      Z_Free(patch->data);
+      memset(patch, 0, sizeof(*patch));
+    }
+
+  dsda_RecordPatchCache((int) (patch_cache_bytes / 1024), patch_cache_hits,
+                        patch_cache_misses, patch_cache_evictions);
+  patch_cache_hits = patch_cache_misses = patch_cache_evictions = 0;
 }
 
 //---------------------------------------------------------------------------
@@ -453,6 +559,7 @@ static void createPatch(int id) {
   dataSize = pixelDataSize + columnsDataSize + postsDataSize;
   patch->data = (unsigned char*) Z_Malloc(dataSize);
   memset(patch->data, 0, dataSize);
+  R_AddCachedPatch(id, dataSize);
 
   // set out pixel, column, and post pointers into our data array
   patch->pixels = patch->data;
@@ -655,6 +762,7 @@ static void createTextureCompositePatch(int id) {
   dataSize = pixelDataSize + columnsDataSize + postsDataSize;
   composite_patch->data = (unsigned char*) Z_Malloc(dataSize);
   memset(composite_patch->data, 0, dataSize);
+  R_AddCachedPatch(numlumps + id, dataSize);
 
   // set out pixel, column, and post pointers into our data array
   composite_patch->pixels = composite_patch->data;
@@ -838,6 +946,8 @@ const rpatch_t *R_PatchByNum(int id) {
 
   if (!patches[id].data)
     createPatch(id);
+  else
+    R_TouchCachedPatch(id);
 
   return &patches[id];
 }
@@ -854,6 +964,8 @@ const rpatch_t *R_TextureCompositePatchByNum(int id) {
 
   if (!texture_composites[id].data)
     createTextureCompositePatch(id);
+  else
+    R_TouchCachedPatch(numlumps + id);
 
   return &texture_composites[id];
 
@@ -87,6 +87,9 @@ const rpatch_t *R_PatchByNum(int id);
 
 const rpatch_t *R_TextureCompositePatchByNum(int id);
 
+// Evicts least recently used patches over the configured budget
+void R_TrimPatchCache(void);
+
 // Size query funcs
 int R_NumPatchWidth(int lump) ;
 int R_NumPatchHeight(int lump);
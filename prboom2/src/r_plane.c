@@ -70,18 +70,42 @@ fixed_t Sky1ColumnOffset;
 fixed_t Sky2ColumnOffset;
 dboolean DoubleSky;
 
-#define MAXVISPLANES 256    /* must be a power of 2 */
+#define VISPLANE_HASH_BITS 9
+#define MAXVISPLANES (1 << VISPLANE_HASH_BITS)
 
 static visplane_t *visplanes[MAXVISPLANES];   // killough
-static visplane_t *freetail;                  // killough
-static visplane_t **freehead = &freetail;     // killough
 visplane_t *floorplane, *ceilingplane;
 
-// killough -- hash function for visplanes
-// Empirically verified to be fairly uniform:
+// Visplanes are handed out from a pool that is reset every frame.
+// The pool grows in blocks when a frame needs more, and is reserved
+// up front to the render stats high-water mark.
 
-#define visplane_hash(picnum,lightlevel,height) \
-  ((unsigned)((picnum)*3+(lightlevel)+(height)*7) & (MAXVISPLANES-1))
+#define VISPLANE_BLOCK_MIN 128
+
+static visplane_t **visplane_pool;
+static int visplane_pool_size;
+static int visplane_pool_used;
+static void **visplane_blocks;
+static int visplane_block_count;
+
+// Multiplicative mix of the fields planes usually differ in;
+// the old additive hash clustered heights and light levels
+
+static unsigned visplane_hash(fixed_t height, int picnum, int lightlevel,
+                              int special, fixed_t xoffs, fixed_t yoffs)
+{
+  unsigned h;
+
+  h = (unsigned) height * 0x9e3779b1u;
+  h ^= (unsigned) picnum * 0x85ebca77u;
+  h ^= (unsigned) lightlevel * 0xc2b2ae3du;
+  h ^= (unsigned) special * 0x27d4eb2fu;
+  h ^= ((unsigned) xoffs ^ ((unsigned) yoffs << 7)) * 0x165667b1u;
+  h ^= h >> 15;
+  h *= 0x2c1b3c6du;
+
+  return h >> (32 - VISPLANE_HASH_BITS);
+}
 
 size_t maxopenings;
 int *openings,*lastopening; // dropoff overflow
@@ -137,8 +161,18 @@ void R_InitVisplanesRes(void)
 {
   int i;
 
-  freetail = NULL;
-  freehead = &freetail;
+  // The top / bottom arrays depend on the resolution
+  for (i = 0; i < visplane_block_count; i++)
+    Z_Free(visplane_blocks[i]);
+
+  Z_Free(visplane_blocks);
+  Z_Free(visplane_pool);
+
+  visplane_blocks = NULL;
+  visplane_block_count = 0;
+  visplane_pool = NULL;
+  visplane_pool_size = 0;
+  visplane_pool_used = 0;
 
   for (i = 0; i < MAXVISPLANES; i++)
   {
@@ -146,6 +180,36 @@ void R_InitVisplanesRes(void)
   }
 }
 
+static void R_GrowVisplanePool(int count)
+{
+  size_t size;
+  byte *block;
+  int i;
+
+  // e6y: resolution limitation is removed
+  size = sizeof(visplane_t) + sizeof(((visplane_t *) 0)->top[0]) * (SCREENWIDTH * 2);
+  size = (size + 15) & ~(size_t) 15;
+
+  block = Z_Calloc(count, size);
+
+  visplane_blocks = Z_Realloc(visplane_blocks,
+                              (visplane_block_count + 1) * sizeof(*visplane_blocks));
+  visplane_blocks[visplane_block_count++] = block;
+
+  visplane_pool = Z_Realloc(visplane_pool,
+                            (visplane_pool_size + count) * sizeof(*visplane_pool));
+
+  for (i = 0; i < count; i++)
+  {
+    visplane_t *pl = (visplane_t *) (block + i * size);
+
+    pl->bottom = &pl->top[SCREENWIDTH + 2];
+    visplane_pool[visplane_pool_size++] = pl;
+  }
+
+  dsda_RecordVisPlaneAllocations(count);
+}
+
 //
 // R_InitPlanes
 // Only at game startup.
@@ -230,9 +294,13 @@ void R_ClearPlanes(void)
   for (i=0 ; i<viewwidth ; i++)
     floorclip[i] = viewheight, ceilingclip[i] = -1;
 
-  for (i=0;i<MAXVISPLANES;i++)    // new code -- killough
-    for (*freehead = visplanes[i], visplanes[i] = NULL; *freehead; )
-      freehead = &(*freehead)->next;
+  memset(visplanes, 0, sizeof(visplanes));
+  visplane_pool_used = 0;
+
+  if (visplane_pool_size < dsda_render_stats_max.visplanes)
+    R_GrowVisplanePool(dsda_render_stats_max.visplanes - visplane_pool_size);
+
+  dsda_RecordVisPlanePool(visplane_pool_size);
 
   lastopening = openings;
 
@@ -244,16 +312,12 @@ void R_ClearPlanes(void)
 
 static visplane_t *new_visplane(unsigned hash)
 {
-  visplane_t *check = freetail;
-  if (!check)
-  {
-    // e6y: resolution limitation is removed
-    check = Z_Calloc(1, sizeof(*check) + sizeof(*check->top) * (SCREENWIDTH * 2));
-    check->bottom = &check->top[SCREENWIDTH + 2];
-  }
-  else
-    if (!(freetail = freetail->next))
-      freehead = &freetail;
+  visplane_t *check;
+
+  if (visplane_pool_used == visplane_pool_size)
+    R_GrowVisplanePool(MAX(visplane_pool_size, VISPLANE_BLOCK_MIN));
+
+  check = visplane_pool[visplane_pool_used++];
   check->next = visplanes[hash];
   visplanes[hash] = check;
   return check;
@@ -267,7 +331,8 @@ static visplane_t *new_visplane(unsigned hash)
 visplane_t *R_DupPlane(const visplane_t *pl, int start, int stop)
 {
       int i;
-      unsigned hash = visplane_hash(pl->picnum, pl->lightlevel, pl->height);
+      unsigned hash = visplane_hash(pl->height, pl->picnum, pl->lightlevel,
+                                    pl->special, pl->xoffs, pl->yoffs);
       visplane_t *new_pl = new_visplane(hash);
 
       new_pl->height = pl->height;
@@ -305,7 +370,7 @@ visplane_t *R_FindPlane(fixed_t height, int picnum, int lightlevel, int special,
     height = lightlevel = 0;         // killough 7/19/98: most skies map together
 
   // New visplane algorithm uses hash table -- killough
-  hash = visplane_hash(picnum,lightlevel,height);
+  hash = visplane_hash(height, picnum, lightlevel, special, xoffs, yoffs);
 
   for (check=visplanes[hash]; check; check=check->next)  // killough
     if (height == check->height &&
@@ -773,13 +838,13 @@ static void R_DoDrawPlane(visplane_t *pl)
 
 void R_DrawPlanes (void)
 {
-  visplane_t *pl;
   int i;
-  for (i=0;i<MAXVISPLANES;i++)
-    for (pl=visplanes[i]; pl; pl=pl->next)
-    {
-      dsda_RecordVisPlane();
 
-      R_DoDrawPlane(pl);
-    }
+  // Planes never overlap, so pool order is as good as hash order
+  for (i = 0; i < visplane_pool_used; i++)
+  {
+    dsda_RecordVisPlane();
+
+    R_DoDrawPlane(visplane_pool[i]);
+  }
 }
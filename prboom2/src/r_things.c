@@ -31,6 +31,8 @@
  *
  *-----------------------------------------------------------------------------*/
 
+#include <limits.h>
+
 #include "doomstat.h"
 #include "w_wad.h"
 #include "r_main.h"
@@ -79,19 +81,20 @@ typedef struct drawseg_xrange_item_s
   drawseg_t *user;
 } drawseg_xrange_item_t;
 
-typedef struct drawsegs_xrange_s
-{
-  drawseg_xrange_item_t *items;
-  int count;
-} drawsegs_xrange_t;
-
-#define DS_RANGES_COUNT 3
-static drawsegs_xrange_t drawsegs_xranges[DS_RANGES_COUNT];
-
 static drawseg_xrange_item_t *drawsegs_xrange;
 static unsigned int drawsegs_xrange_size = 0;
 static int drawsegs_xrange_count = 0;
 
+// Interval buckets: for each group of view columns, the indices of the
+// drawsegs above that overlap it, in back to front order
+#define DS_BUCKET_COUNT 32
+#define DS_MAX_MERGED_BUCKETS 8
+
+static int drawsegs_bucket_width;
+static int drawsegs_bucket_start[DS_BUCKET_COUNT + 1];
+static int *drawsegs_bucket_items;
+static int drawsegs_bucket_size = 0;
+
 // constant arrays
 //  used for psprite clipping and initializing clipping
 
@@ -1350,6 +1353,92 @@ static void msort(vissprite_t **s, vissprite_t **t, int n)
     }
 }
 
+// The order msort leaves sprites of equal scale in: below 16 they keep
+// their order, and each merge puts the right half's ties first.
+// Laying the input out this way lets a stable sort reproduce it.
+
+static void R_VisSpriteTieOrder(vissprite_t **s, int n, vissprite_t ***d)
+{
+  if (n >= 16)
+    {
+      int n1 = n/2;
+
+      R_VisSpriteTieOrder(s + n1, n - n1, d);
+      R_VisSpriteTieOrder(s, n1, d);
+    }
+  else
+    {
+      bcopyp(*d, s, n);
+      *d += n;
+    }
+}
+
+// Radix sort for sprite-heavy scenes, with the same result as msort
+
+#define RADIX_SORT_MIN 256
+
+static unsigned int *vissprite_keys;
+static int num_vissprite_keys;
+
+static void R_RadixSortVisSprites(vissprite_t **s, int n)
+{
+  vissprite_t **src, **dst, **d;
+  unsigned int *ksrc, *kdst;
+  int i, shift;
+
+  if (num_vissprite_keys < n*2)
+    {
+      Z_Free(vissprite_keys);
+      vissprite_keys = Z_Malloc((num_vissprite_keys = n*2) * sizeof *vissprite_keys);
+    }
+
+  d = s + n;
+  R_VisSpriteTieOrder(s, n, &d);
+
+  src = s + n;
+  dst = s;
+  ksrc = vissprite_keys;
+  kdst = vissprite_keys + n;
+
+  // Descending signed scale as an ascending unsigned key
+  for (i = 0; i < n; i++)
+    ksrc[i] = ~((unsigned int) src[i]->scale ^ 0x80000000u);
+
+  for (shift = 0; shift < 32; shift += 8)
+    {
+      int count[256] = { 0 };
+      int pos, b;
+      void *temp;
+
+      for (i = 0; i < n; i++)
+        count[(ksrc[i] >> shift) & 0xff]++;
+
+      // Every key shares this byte
+      if (count[(ksrc[0] >> shift) & 0xff] == n)
+        continue;
+
+      for (pos = 0, b = 0; b < 256; b++)
+        {
+          int c = count[b];
+          count[b] = pos;
+          pos += c;
+        }
+
+      for (i = 0; i < n; i++)
+        {
+          int k = count[(ksrc[i] >> shift) & 0xff]++;
+          dst[k] = src[i];
+          kdst[k] = ksrc[i];
+        }
+
+      temp = src; src = dst; dst = temp;
+      temp = ksrc; ksrc = kdst; kdst = temp;
+    }
+
+  if (src != s)
+    bcopyp(s, src, n);
+}
+
 void R_SortVisSprites (void)
 {
   if (num_vissprite)
@@ -1373,7 +1462,10 @@ void R_SortVisSprites (void)
       // killough 9/22/98: replace qsort with merge sort, since the keys
       // are roughly in order to begin with, due to BSP rendering.
 
-      msort(vissprite_ptrs, vissprite_ptrs + num_vissprite, num_vissprite);
+      if (num_vissprite >= RADIX_SORT_MIN)
+        R_RadixSortVisSprites(vissprite_ptrs, num_vissprite);
+      else
+        msort(vissprite_ptrs, vissprite_ptrs + num_vissprite, num_vissprite);
     }
 }
 
@@ -1381,7 +1473,57 @@ void R_SortVisSprites (void)
 // R_DrawSprite
 //
 
-static void R_DrawSprite (vissprite_t* spr)
+static int R_DrawsegBucket(int x)
+{
+  return BETWEEN(0, DS_BUCKET_COUNT - 1, x / drawsegs_bucket_width);
+}
+
+static void R_BuildDrawsegBuckets(void)
+{
+  int fill[DS_BUCKET_COUNT];
+  int i, b, total;
+
+  drawsegs_bucket_width = (viewwidth + DS_BUCKET_COUNT - 1) / DS_BUCKET_COUNT;
+
+  memset(fill, 0, sizeof(fill));
+
+  total = 0;
+  for (i = 0; i < drawsegs_xrange_count; i++)
+  {
+    int b1 = R_DrawsegBucket(drawsegs_xrange[i].x1);
+    int b2 = R_DrawsegBucket(drawsegs_xrange[i].x2);
+
+    for (b = b1; b <= b2; b++)
+      fill[b]++;
+
+    total += b2 - b1 + 1;
+  }
+
+  if (drawsegs_bucket_size < total)
+  {
+    drawsegs_bucket_size = 2 * total;
+    drawsegs_bucket_items = Z_Realloc(drawsegs_bucket_items,
+      drawsegs_bucket_size * sizeof(drawsegs_bucket_items[0]));
+  }
+
+  drawsegs_bucket_start[0] = 0;
+  for (b = 0; b < DS_BUCKET_COUNT; b++)
+  {
+    drawsegs_bucket_start[b + 1] = drawsegs_bucket_start[b] + fill[b];
+    fill[b] = drawsegs_bucket_start[b];
+  }
+
+  for (i = 0; i < drawsegs_xrange_count; i++)
+  {
+    int b1 = R_DrawsegBucket(drawsegs_xrange[i].x1);
+    int b2 = R_DrawsegBucket(drawsegs_xrange[i].x2);
+
+    for (b = b1; b <= b2; b++)
+      drawsegs_bucket_items[fill[b]++] = i;
+  }
+}
+
+static void R_ClipSpriteToDrawseg(vissprite_t *spr, const drawseg_xrange_item_t *curr)
 {
   drawseg_t *ds;
   int     x;
@@ -1390,6 +1532,57 @@ static void R_DrawSprite (vissprite_t* spr)
   fixed_t scale;
   fixed_t lowscale;
 
+  // determine if the drawseg obscures the sprite
+  if (curr->x1 > spr->x2 || curr->x2 < spr->x1)
+    return;      // does not cover sprite
+
+  ds = curr->user;
+
+  if (ds->scale1 > ds->scale2)
+  {
+    lowscale = ds->scale2;
+    scale = ds->scale1;
+  }
+  else
+  {
+    lowscale = ds->scale1;
+    scale = ds->scale2;
+  }
+
+  if (scale < spr->scale || (lowscale < spr->scale &&
+    !R_PointOnSegSide (spr->gx, spr->gy, ds->curline)))
+  {
+    if (ds->maskedtexturecol)       // masked mid texture?
+    {
+      r1 = ds->x1 < spr->x1 ? spr->x1 : ds->x1;
+      r2 = ds->x2 > spr->x2 ? spr->x2 : ds->x2;
+      R_RenderMaskedSegRange(ds, r1, r2);
+    }
+    return;               // seg is behind sprite
+  }
+
+  r1 = ds->x1 < spr->x1 ? spr->x1 : ds->x1;
+  r2 = ds->x2 > spr->x2 ? spr->x2 : ds->x2;
+
+  // clip this piece of the sprite
+  // killough 3/27/98: optimized and made much shorter
+
+  if (ds->silhouette&SIL_BOTTOM && spr->gz < ds->bsilheight) //bottom sil
+    for (x=r1 ; x<=r2 ; x++)
+      if (clipbot[x] == -2)
+        clipbot[x] = ds->sprbottomclip[x];
+
+  if (ds->silhouette&SIL_TOP && spr->gzt > ds->tsilheight)   // top sil
+    for (x=r1 ; x<=r2 ; x++)
+      if (cliptop[x] == -2)
+        cliptop[x] = ds->sprtopclip[x];
+}
+
+static void R_DrawSprite (vissprite_t* spr)
+{
+  int     i;
+  int     x;
+
   for (x = spr->x1 ; x<=spr->x2 ; x++)
     clipbot[x] = -2;
   for (x = spr->x1 ; x<=spr->x2 ; x++)
@@ -1403,56 +1596,50 @@ static void R_DrawSprite (vissprite_t* spr)
   // and buggy, by going past LEFT end of array):
 
   // e6y: optimization
-  if (drawsegs_xrange_size)
+  if (drawsegs_xrange_count)
   {
-    const drawseg_xrange_item_t *last = &drawsegs_xrange[drawsegs_xrange_count - 1];
-    drawseg_xrange_item_t *curr = &drawsegs_xrange[-1];
-    while (++curr <= last)
+    int b1 = R_DrawsegBucket(spr->x1);
+    int b2 = R_DrawsegBucket(spr->x2);
+
+    if (b1 == b2)
+    {
+      for (i = drawsegs_bucket_start[b1]; i < drawsegs_bucket_start[b1 + 1]; i++)
+        R_ClipSpriteToDrawseg(spr, &drawsegs_xrange[drawsegs_bucket_items[i]]);
+    }
+    else if (b2 - b1 < DS_MAX_MERGED_BUCKETS)
     {
-      // determine if the drawseg obscures the sprite
-      if (curr->x1 > spr->x2 || curr->x2 < spr->x1)
-        continue;      // does not cover sprite
+      int heads[DS_MAX_MERGED_BUCKETS];
+      int count = b2 - b1 + 1;
+      int b;
 
-      ds = curr->user;
+      for (b = 0; b < count; b++)
+        heads[b] = drawsegs_bucket_start[b1 + b];
 
-      if (ds->scale1 > ds->scale2)
-      {
-        lowscale = ds->scale2;
-        scale = ds->scale1;
-      }
-      else
+      // Merge the buckets' ascending index lists, skipping duplicates
+      while (1)
       {
-        lowscale = ds->scale1;
-        scale = ds->scale2;
-      }
-
-      if (scale < spr->scale || (lowscale < spr->scale &&
-        !R_PointOnSegSide (spr->gx, spr->gy, ds->curline)))
-      {
-        if (ds->maskedtexturecol)       // masked mid texture?
-        {
-          r1 = ds->x1 < spr->x1 ? spr->x1 : ds->x1;
-          r2 = ds->x2 > spr->x2 ? spr->x2 : ds->x2;
-          R_RenderMaskedSegRange(ds, r1, r2);
-        }
-        continue;               // seg is behind sprite
-      }
+        int next = INT_MAX;
 
-      r1 = ds->x1 < spr->x1 ? spr->x1 : ds->x1;
-      r2 = ds->x2 > spr->x2 ? spr->x2 : ds->x2;
+        for (b = 0; b < count; b++)
+          if (heads[b] < drawsegs_bucket_start[b1 + b + 1] &&
+              drawsegs_bucket_items[heads[b]] < next)
+            next = drawsegs_bucket_items[heads[b]];
 
-      // clip this piece of the sprite
-      // killough 3/27/98: optimized and made much shorter
+        if (next == INT_MAX)
+          break;
 
-      if (ds->silhouette&SIL_BOTTOM && spr->gz < ds->bsilheight) //bottom sil
-        for (x=r1 ; x<=r2 ; x++)
-          if (clipbot[x] == -2)
-            clipbot[x] = ds->sprbottomclip[x];
+        for (b = 0; b < count; b++)
+          if (heads[b] < drawsegs_bucket_start[b1 + b + 1] &&
+              drawsegs_bucket_items[heads[b]] == next)
+            heads[b]++;
 
-      if (ds->silhouette&SIL_TOP && spr->gzt > ds->tsilheight)   // top sil
-        for (x=r1 ; x<=r2 ; x++)
-          if (cliptop[x] == -2)
-            cliptop[x] = ds->sprtopclip[x];
+        R_ClipSpriteToDrawseg(spr, &drawsegs_xrange[next]);
+      }
+    }
+    else
+    {
+      for (i = 0; i < drawsegs_xrange_count; i++)
+        R_ClipSpriteToDrawseg(spr, &drawsegs_xrange[i]);
     }
   }
 
@@ -1523,7 +1710,6 @@ void R_DrawMasked(void)
 {
   int i;
   drawseg_t *ds;
-  int cx = SCREENWIDTH / 2;
 
   R_SortVisSprites();
 
@@ -1531,46 +1717,29 @@ void R_DrawMasked(void)
   // Reducing of cache misses in the following R_DrawSprite()
   // Makes sense for scenes with huge amount of drawsegs.
   // ~12% of speed improvement on epic.wad map05
-  for(i = 0; i < DS_RANGES_COUNT; i++)
-    drawsegs_xranges[i].count = 0;
+  drawsegs_xrange_count = 0;
 
   if (num_vissprite > 0)
   {
     if (drawsegs_xrange_size < maxdrawsegs)
     {
       drawsegs_xrange_size = 2 * maxdrawsegs;
-      for(i = 0; i < DS_RANGES_COUNT; i++)
-      {
-        drawsegs_xranges[i].items = Z_Realloc(
-          drawsegs_xranges[i].items,
-          drawsegs_xrange_size * sizeof(drawsegs_xranges[i].items[0]));
-      }
+      drawsegs_xrange = Z_Realloc(drawsegs_xrange,
+        drawsegs_xrange_size * sizeof(drawsegs_xrange[0]));
     }
     for (ds = ds_p; ds-- > drawsegs;)
     {
       if (ds->silhouette || ds->maskedtexturecol)
       {
-        drawsegs_xranges[0].items[drawsegs_xranges[0].count].x1 = ds->x1;
-        drawsegs_xranges[0].items[drawsegs_xranges[0].count].x2 = ds->x2;
-        drawsegs_xranges[0].items[drawsegs_xranges[0].count].user = ds;
-
-        // e6y: ~13% of speed improvement on sunder.wad map10
-        if (ds->x1 < cx)
-        {
-          drawsegs_xranges[1].items[drawsegs_xranges[1].count] =
-            drawsegs_xranges[0].items[drawsegs_xranges[0].count];
-          drawsegs_xranges[1].count++;
-        }
-        if (ds->x2 >= cx)
-        {
-          drawsegs_xranges[2].items[drawsegs_xranges[2].count] =
-            drawsegs_xranges[0].items[drawsegs_xranges[0].count];
-          drawsegs_xranges[2].count++;
-        }
-
-        drawsegs_xranges[0].count++;
+        drawsegs_xrange[drawsegs_xrange_count].x1 = ds->x1;
+        drawsegs_xrange[drawsegs_xrange_count].x2 = ds->x2;
+        drawsegs_xrange[drawsegs_xrange_count].user = ds;
+        drawsegs_xrange_count++;
       }
     }
+
+    // Sprites only visit the drawsegs sharing their columns
+    R_BuildDrawsegBuckets();
   }
 
   // draw all vissprites back to front
@@ -1578,27 +1747,7 @@ void R_DrawMasked(void)
   dsda_RecordVisSprites(num_vissprite);
 
   for (i = num_vissprite ;--i>=0; )
-  {
-    vissprite_t* spr = vissprite_ptrs[i];
-
-    if (spr->x2 < cx)
-    {
-      drawsegs_xrange = drawsegs_xranges[1].items;
-      drawsegs_xrange_count = drawsegs_xranges[1].count;
-    }
-    else if (spr->x1 >= cx)
-    {
-      drawsegs_xrange = drawsegs_xranges[2].items;
-      drawsegs_xrange_count = drawsegs_xranges[2].count;
-    }
-    else
-    {
-      drawsegs_xrange = drawsegs_xranges[0].items;
-      drawsegs_xrange_count = drawsegs_xranges[0].count;
-    }
-
     R_DrawSprite(vissprite_ptrs[i]);
-  }
 
   // render any remaining masked mid textures
 
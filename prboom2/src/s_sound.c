@@ -56,11 +56,11 @@
 #include "dsda/configuration.h"
 #include "dsda/map_format.h"
 #include "dsda/mapinfo.h"
-#include "dsda/memory.h"
 #include "dsda/music.h"
 #include "dsda/settings.h"
 #include "dsda/sfx.h"
 #include "dsda/skip.h"
+#include "dsda/startup.h"
 
 // Adjustable by menu.
 #define NORM_PITCH 128
@@ -138,6 +138,7 @@ int dist_adjust = 160;
 
 static byte* soundCurve;
 static int AmbChan = -1;
+static dboolean sound_started;
 
 static mobj_t* GetSoundListener(void);
 static void Heretic_S_StopSound(void *_origin);
@@ -185,15 +186,12 @@ void S_Init(void)
 
     if (first_s_init)
     {
-      int i;
       int snd_curve_lump;
 
       first_s_init = false;
 
-      for (i = 1; i < num_sfx; i++)
-        S_sfx[i].lumpnum = -1;
-
-      dsda_CacheSoundLumps();
+      // Assigns every lumpnum, possibly prepared during setup
+      dsda_FinishStartupJob(dsda_startup_sound_lumps);
 
       // {
       //   int i;
@@ -232,6 +230,13 @@ void S_Init(void)
     // no sounds are playing, and they are not mus_paused
     mus_paused = 0;
   }
+
+  sound_started = !nosfxparm || !nomusicparm;
+}
+
+dboolean S_SoundStarted(void)
+{
+  return sound_started;
 }
 
 void S_Stop(void)
@@ -47,6 +47,9 @@
 //
 void S_Init(void);
 
+// True once S_Init has run with sound or music enabled
+dboolean S_SoundStarted(void);
+
 // Kills all sounds
 void S_Stop(void);
 
@@ -48,6 +48,7 @@
 #include "dsda/exhud.h"
 #include "dsda/font.h"
 #include "dsda/mapinfo.h"
+#include "dsda/stretch.h"
 
 #include "heretic/in_lude.h"
 #include "hexen/in_lude.h"
@@ -448,12 +449,55 @@ static int WI_secretLimit(int i)
                         : compatibility_level < lxdoom_1_compatibility ? 0 : 100;
 }
 
+// Software background composed once and copied on later frames
+static struct
+{
+  char name[9];
+  int width;
+  int height;
+  int pitch;
+  int offsetx;
+  int offsety;
+  int stretch;
+  byte *data;
+} bg_cache;
+
+static dboolean WI_backgroundCached(const char *name)
+{
+  return bg_cache.data &&
+         !strcmp(bg_cache.name, name) &&
+         bg_cache.width == SCREENWIDTH &&
+         bg_cache.height == SCREENHEIGHT &&
+         bg_cache.pitch == screens[FB].pitch &&
+         bg_cache.offsetx == wide_offsetx &&
+         bg_cache.offsety == wide_offsety &&
+         bg_cache.stretch == render_stretch_hud;
+}
+
+static void WI_cacheBackground(const char *name)
+{
+  size_t size = (size_t) SCREENHEIGHT * screens[FB].pitch;
+
+  bg_cache.data = Z_Realloc(bg_cache.data, size);
+  memcpy(bg_cache.data, screens[FB].data, size);
+
+  strcpy(bg_cache.name, name);
+  bg_cache.width = SCREENWIDTH;
+  bg_cache.height = SCREENHEIGHT;
+  bg_cache.pitch = screens[FB].pitch;
+  bg_cache.offsetx = wide_offsetx;
+  bg_cache.offsety = wide_offsety;
+  bg_cache.stretch = render_stretch_hud;
+}
+
 // ====================================================================
 // WI_slamBackground
 // Purpose: Put the full-screen background up prior to patches
 // Args:    none
 // Returns: void
 //
+// Software backgrounds are composed once and copied on later frames,
+// so only the animations and stats are drawn every tic
 static void WI_slamBackground(void)
 {
   char  name[9];  // limited to 8 characters
@@ -465,11 +509,20 @@ static void WI_slamBackground(void)
   else
     snprintf(name, sizeof(name), "WIMAP%d", wbs->epsd);
 
+  if (V_IsSoftwareMode() && WI_backgroundCached(name))
+  {
+    memcpy(screens[FB].data, bg_cache.data, (size_t) SCREENHEIGHT * screens[FB].pitch);
+    return;
+  }
+
   // e6y: wide-res
   V_ClearBorder();
 
   // background
   V_DrawNamePatch(0, 0, FB, name, CR_DEFAULT, VPT_STRETCH);
+
+  if (V_IsSoftwareMode())
+    WI_cacheBackground(name);
 }
 
 #define SPACEWIDTH 4
@@ -78,6 +78,9 @@ static const size_t HEADER_SIZE = sizeof(memblock_t);
 
 static memblock_t *blockbytag[ZONE_MAX];
 
+static size_t zone_bytes;
+static size_t zone_peak_bytes;
+
 /* Z_Malloc
  * cph - the algorithm here was a very simple first-fit round-robin
  *  one - just keep looping around, freeing everything we can until
@@ -113,6 +116,10 @@ static void *Z_MallocTag(size_t size, int tag)
     blockbytag[tag]->prev = block;
   }
 
+  zone_bytes += size;
+  if (zone_bytes > zone_peak_bytes)
+    zone_peak_bytes = zone_bytes;
+
   block->size = size;
   block->signature = ZONE_SIGNATURE;
   block->tag = tag;           // tag
@@ -132,6 +139,8 @@ void Z_Free(void *p)
     I_Error("Z_Free: freed a non-zone pointer");
   block->signature = 0;       // Nullify signature so another free fails
 
+  zone_bytes -= block->size;
+
   if (block == block->next)
     blockbytag[block->tag] = NULL;
   else
@@ -231,3 +240,13 @@ char *Z_StrdupLevel(const char *s)
 {
   return Z_StrdupTag(s, ZONE_LEVEL);
 }
+
+size_t Z_Usage(void)
+{
+  return zone_bytes;
+}
+
+size_t Z_PeakUsage(void)
+{
+  return zone_peak_bytes;
+}
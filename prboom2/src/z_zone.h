@@ -62,4 +62,7 @@ void *Z_CallocLevel(size_t n, size_t n2);
 void *Z_ReallocLevel(void *p, size_t n);
 char *Z_StrdupLevel(const char *s);
 
+size_t Z_Usage(void);
+size_t Z_PeakUsage(void);
+
 #endif
@@ -0,0 +1,59 @@
+# Compares benchmark results against a baseline and exits nonzero when a
+# scene got slower or used more memory than the threshold allows.
+#
+# Usage: ruby spec/benchmark/compare.rb baseline.json results.json [--threshold pct]
+
+require 'json'
+
+threshold = 5.0
+args = ARGV.dup
+
+if (i = args.index('--threshold'))
+  threshold = args[i + 1].to_f
+  args.slice!(i, 2)
+end
+
+abort 'Usage: compare.rb baseline.json results.json [--threshold pct]' if args.size != 2
+
+baseline = JSON.parse(File.read(args[0]))
+results = JSON.parse(File.read(args[1]))
+
+# [label, lookup, true when higher is worse]
+METRICS = [
+  ['frame p50', ->(r) { r.dig('frame_us', 'p50') }, true],
+  ['frame p99', ->(r) { r.dig('frame_us', 'p99') }, true],
+  ['tic p50', ->(r) { r.dig('tic_us', 'p50') }, true],
+  ['tic p99', ->(r) { r.dig('tic_us', 'p99') }, true],
+  ['fps', ->(r) { r['fps'] }, false],
+  ['peak zone', ->(r) { r['peak_zone_bytes'] }, true],
+  ['dehacked', ->(r) { r['deh_us'] }, true],
+  ['startup', ->(r) { r['startup_us'] }, true]
+].freeze
+
+regressions = 0
+
+results.each do |key, result|
+  base = baseline[key]
+
+  unless base
+    puts "#{key}: no baseline"
+    next
+  end
+
+  METRICS.each do |label, lookup, higher_is_worse|
+    old = lookup.call(base)
+    new = lookup.call(result)
+
+    next if old.nil? || new.nil? || old.zero?
+
+    change = (new - old) * 100.0 / old
+    worse = higher_is_worse ? change > threshold : change < -threshold
+    regressions += 1 if worse
+
+    puts format('%-30s %-10s %12.1f -> %12.1f %+7.2f%%%s',
+                key, label, old, new, change, worse ? '  REGRESSION' : '')
+  end
+end
+
+puts "#{regressions} regression(s) over #{threshold}%"
+exit(regressions.zero? ? 0 : 1)
@@ -0,0 +1,107 @@
+# Times dehacked parsing at startup. Generates a large MBF21 patch, plays a
+# short demo with it a few times and keeps the run with the median deh_us
+# from -benchmark_json, in the same format as run.rb.
+#
+# Usage: ruby spec/benchmark/deh.rb [output.json] [--frames N] [--runs N]
+
+require 'json'
+require 'fileutils'
+
+BENCHMARK_DIR = File.dirname(__FILE__)
+SUPPORT_DIR = File.join(BENCHMARK_DIR, '..', 'support')
+
+# New frames and things start past the vanilla tables so the demo stays in sync
+FIRST_FRAME = 1100
+FIRST_THING = 200
+
+CODEPOINTERS = %w[Look Chase FaceTarget PosAttack Scream Pain Fall Explode
+                  SpawnObject MonsterProjectile MonsterBulletAttack NoiseAlert].freeze
+THING_BITS = 'SOLID+SHOOTABLE+COUNTKILL+FLOAT+NOGRAVITY'.freeze
+THING_MBF21_BITS = 'LOGRAV|SHORTMRANGE|NORADIUSDMG|FORCERADIUSDMG'.freeze
+
+def option(args, name, default)
+  i = args.index(name)
+  return default unless i
+
+  value = args[i + 1].to_i
+  args.slice!(i, 2)
+  value
+end
+
+def write_patch(filename, frames)
+  File.open(filename, 'w') do |f|
+    f.puts 'Patch File for DeHackEd v3.0'
+    f.puts 'Doom version = 2021'
+    f.puts 'Patch format = 6'
+    f.puts
+
+    frames.times do |i|
+      frame = FIRST_FRAME + i
+      f.puts "Frame #{frame}"
+      f.puts "Sprite number = #{i % 100}"
+      f.puts "Sprite subnumber = #{i % 8}"
+      f.puts "Duration = #{i % 10 + 1}"
+      f.puts "Next frame = #{i + 1 < frames ? frame + 1 : FIRST_FRAME}"
+      f.puts "Args1 = #{i % 5}"
+      f.puts "Args2 = #{i % 3}"
+      f.puts 'MBF21 Bits = SKILL5FAST'
+      f.puts
+    end
+
+    (frames / 100).times do |i|
+      f.puts "Thing #{FIRST_THING + i}"
+      f.puts "ID # = #{20000 + i}"
+      f.puts "Initial frame = #{FIRST_FRAME + i * 100}"
+      f.puts "Hit points = #{i + 1}"
+      f.puts "Speed = #{i % 20}"
+      f.puts "Bits = #{THING_BITS}"
+      f.puts "MBF21 Bits = #{THING_MBF21_BITS}"
+      f.puts
+    end
+
+    f.puts '[CODEPTR]'
+    frames.times do |i|
+      f.puts "FRAME #{FIRST_FRAME + i} = #{CODEPOINTERS[i % CODEPOINTERS.size]}"
+    end
+    f.puts
+  end
+end
+
+args = ARGV.dup
+frames = option(args, '--frames', 40_000)
+runs = option(args, '--runs', 5)
+output = args.first || 'benchmark_deh.json'
+
+patch = 'benchmark_large.deh'
+tmp = 'benchmark_run.json'
+
+write_patch(patch, frames)
+
+command = "./build/dsda-doom.exe -iwad #{SUPPORT_DIR}/wads/DOOM2.WAD"
+command << " -file #{SUPPORT_DIR}/wads/analysis_test.wad -deh #{patch}"
+command << " -timedemo \"#{SUPPORT_DIR}/lmps/keen.lmp\""
+command << " -nosound -nomusic -headless -benchmark_json #{tmp}"
+
+samples = []
+
+runs.times do
+  FileUtils.rm_f(tmp)
+
+  unless system(command) && File.exist?(tmp)
+    warn 'dehacked: run failed'
+    next
+  end
+
+  samples << JSON.parse(File.read(tmp))
+end
+
+FileUtils.rm_f(tmp)
+FileUtils.rm_f(patch)
+
+abort 'dehacked: no successful runs' if samples.empty?
+
+median = samples.sort_by { |s| s['deh_us'] }[samples.size / 2]
+puts "dehacked (#{frames} frames): #{median['deh_us']} us median of #{samples.size}"
+
+File.write(output, JSON.pretty_generate({ "dehacked-#{frames}" => median }))
+puts "Wrote #{output}"
@@ -0,0 +1,48 @@
+# Plays every scene in scenes.json with -timedemo at each configured
+# resolution and renderer and collects the -benchmark_json results.
+#
+# Usage: ruby spec/benchmark/run.rb [output.json] [--sw-only]
+
+require 'json'
+require 'fileutils'
+
+BENCHMARK_DIR = File.dirname(__FILE__)
+SUPPORT_DIR = File.join(BENCHMARK_DIR, '..', 'support')
+
+output = ARGV.find { |a| !a.start_with?('--') } || 'benchmark.json'
+renderers_filter = ARGV.include?('--sw-only') ? ['sw'] : nil
+
+config = JSON.parse(File.read(File.join(BENCHMARK_DIR, 'scenes.json')))
+renderers = renderers_filter || config['renderers']
+
+results = {}
+tmp = 'benchmark_run.json'
+
+config['scenes'].each do |scene|
+  config['resolutions'].each do |resolution|
+    renderers.each do |renderer|
+      key = "#{scene['name']}/#{resolution}/#{renderer}"
+
+      command = "./build/dsda-doom.exe -iwad #{SUPPORT_DIR}/wads/#{scene['iwad']}"
+      command << " -file #{SUPPORT_DIR}/wads/#{scene['pwad']}" if scene['pwad']
+      command << " -timedemo \"#{SUPPORT_DIR}/lmps/#{scene['lmp']}\""
+      command << " -nosound -nomusic -geom #{resolution}w -vidmode #{renderer}"
+      command << ' -headless' if renderer == 'sw'
+      command << " -benchmark_json #{tmp}"
+
+      FileUtils.rm_f(tmp)
+      puts key
+
+      unless system(command) && File.exist?(tmp)
+        warn "#{key}: run failed"
+        next
+      end
+
+      results[key] = JSON.parse(File.read(tmp))
+    end
+  end
+end
+
+FileUtils.rm_f(tmp)
+File.write(output, JSON.pretty_generate(results))
+puts "Wrote #{results.size} results to #{output}"
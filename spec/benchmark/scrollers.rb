@@ -0,0 +1,161 @@
+# Compares tic times with texture scrollers run from their own class (the
+# default) against -plain_thinkers. Generates a one sector map whose walls are
+# split into many scrolling linedefs and a demo that stands in it, plays the
+# demo a few times per mode with -nodraw and keeps the run with the median
+# tic p50. The two result sets are written in the same format as run.rb and
+# compared with compare.rb.
+#
+# Usage: ruby spec/benchmark/scrollers.rb [prefix] [--lines N] [--tics N]
+#          [--runs N]
+
+require 'json'
+require 'fileutils'
+
+BENCHMARK_DIR = File.dirname(__FILE__)
+SUPPORT_DIR = File.join(BENCHMARK_DIR, '..', 'support')
+
+MODES = {
+  'class' => '',
+  'plain' => ' -plain_thinkers'
+}.freeze
+
+# Scroll texture left, scroll texture right
+SPECIALS = [48, 85].freeze
+HALF_WIDTH = 15_000
+
+def option(args, name, default)
+  i = args.index(name)
+  return default unless i
+
+  value = args[i + 1].to_i
+  args.slice!(i, 2)
+  value
+end
+
+def lump_name(name)
+  [name].pack('a8')
+end
+
+# A square room walked clockwise, so that the right side of every line faces
+# inwards. Each wall is split into lines / 4 pieces.
+def room_vertices(lines)
+  per_wall = lines / 4
+  corners = [[-HALF_WIDTH, HALF_WIDTH], [HALF_WIDTH, HALF_WIDTH],
+             [HALF_WIDTH, -HALF_WIDTH], [-HALF_WIDTH, -HALF_WIDTH]]
+
+  corners.each_with_index.flat_map do |(x1, y1), i|
+    x2, y2 = corners[(i + 1) % 4]
+    Array.new(per_wall) do |j|
+      [x1 + (x2 - x1) * j / per_wall, y1 + (y2 - y1) * j / per_wall]
+    end
+  end
+end
+
+def write_wad(filename, lines)
+  vertices = room_vertices(lines)
+  count = vertices.size
+
+  things = [0, 0, 90, 1, 7].pack('s<5')
+  linedefs = Array.new(count) do |i|
+    [i, (i + 1) % count, 1, SPECIALS[i % SPECIALS.size], 0, i, -1].pack('s<7')
+  end.join
+  sidedefs = (
+    [0, 0].pack('s<2') + lump_name('-') + lump_name('-') +
+    lump_name('STARTAN3') + [0].pack('s<')
+  ) * count
+  vertexes = vertices.map { |v| v.pack('s<2') }.join
+  segs = Array.new(count) do |i|
+    x1, y1 = vertices[i]
+    x2, y2 = vertices[(i + 1) % count]
+    angle = (Math.atan2(y2 - y1, x2 - x1) * 32_768 / Math::PI).round & 0xffff
+    [i, (i + 1) % count].pack('s<2') + [angle].pack('S<') + [i, 0, 0].pack('s<3')
+  end.join
+  ssectors = [count, 0].pack('S<2')
+  sectors = [0, 128].pack('s<2') + lump_name('FLOOR4_8') +
+            lump_name('CEIL3_5') + [160, 0, 0].pack('s<3')
+
+  lumps = [
+    ['MAP01', ''], ['THINGS', things], ['LINEDEFS', linedefs],
+    ['SIDEDEFS', sidedefs], ['VERTEXES', vertexes], ['SEGS', segs],
+    ['SSECTORS', ssectors], ['NODES', ''], ['SECTORS', sectors],
+    ['REJECT', ''], ['BLOCKMAP', '']
+  ]
+
+  offset = 12
+  directory = lumps.map do |name, data|
+    entry = [offset, data.bytesize].pack('l<2') + lump_name(name)
+    offset += data.bytesize
+    entry
+  end
+
+  File.open(filename, 'wb') do |f|
+    f.write('PWAD' + [lumps.size, offset].pack('l<2'))
+    lumps.each { |_, data| f.write(data) }
+    f.write(directory.join)
+  end
+end
+
+# Doom 1.9 demo on MAP01, UV, player 1 standing still
+def write_demo(filename, tics)
+  File.open(filename, 'wb') do |f|
+    f.write([109, 3, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0].pack('C13'))
+    f.write([0, 0, 0, 0].pack('C4') * tics)
+    f.write([0x80].pack('C'))
+  end
+end
+
+args = ARGV.dup
+lines = option(args, '--lines', 20_000)
+tics = option(args, '--tics', 35 * 60)
+runs = option(args, '--runs', 5)
+prefix = args.first || 'benchmark_scrollers'
+
+# Vertex and seg indices are shorts
+abort 'scrollers: --lines must be at most 32000' if lines > 32_000
+
+wad = 'benchmark_scrollers.wad'
+lmp = 'benchmark_scrollers.lmp'
+tmp = 'benchmark_run.json'
+key = "scrollers-#{lines}/thinkers"
+
+write_wad(wad, lines)
+write_demo(lmp, tics)
+
+results = Hash.new { |h, k| h[k] = {} }
+
+MODES.each do |mode, flags|
+  command = "./build/dsda-doom.exe -iwad #{SUPPORT_DIR}/wads/DOOM2.WAD"
+  command << " -file #{wad} -timedemo #{lmp}"
+  command << " -nosound -nomusic -nodraw -headless -benchmark_json #{tmp}"
+  command << flags
+
+  samples = []
+
+  runs.times do
+    FileUtils.rm_f(tmp)
+
+    unless system(command) && File.exist?(tmp)
+      warn "#{key} (#{mode}): run failed"
+      next
+    end
+
+    samples << JSON.parse(File.read(tmp))
+  end
+
+  next if samples.empty?
+
+  median = samples.sort_by { |s| s.dig('tic_us', 'p50') }[samples.size / 2]
+  results[mode][key] = median
+  puts "#{key} (#{mode}): tic p50 #{median.dig('tic_us', 'p50')} us median of #{samples.size}"
+end
+
+FileUtils.rm_f(tmp)
+FileUtils.rm_f(wad)
+FileUtils.rm_f(lmp)
+
+MODES.each_key do |mode|
+  File.write("#{prefix}_#{mode}.json", JSON.pretty_generate(results[mode]))
+end
+
+system('ruby', File.join(BENCHMARK_DIR, 'compare.rb'),
+       "#{prefix}_plain.json", "#{prefix}_class.json")